@@ -48,20 +48,27 @@ extern "C" {
 #define AUTOMATE_HEART_BEAT_MSG_FRAME_ID (0x1800ad00u)
 #define AUTOMATE_LEFT_BRAKE_CMD_FRAME_ID (0x1800ad09u)
 #define AUTOMATE_LEFT_BRAKE_MSG_FRAME_ID (0x1800ad0au)
+#define AUTOMATE_MCU_DIAG_MSG_FRAME_ID (0x1800ad0eu)
+#define AUTOMATE_MCU_CONFIG_CMD_FRAME_ID (0x1800ad0fu)
 
 /* Frame lengths in bytes. */
 #define AUTOMATE_HEART_BEAT_MSG_LENGTH (8u)
 #define AUTOMATE_LEFT_BRAKE_CMD_LENGTH (8u)
 #define AUTOMATE_LEFT_BRAKE_MSG_LENGTH (8u)
+#define AUTOMATE_MCU_DIAG_MSG_LENGTH (8u)
+#define AUTOMATE_MCU_CONFIG_CMD_LENGTH (8u)
 
 /* Extended or standard frame types. */
 #define AUTOMATE_HEART_BEAT_MSG_IS_EXTENDED (1)
 #define AUTOMATE_LEFT_BRAKE_CMD_IS_EXTENDED (1)
 #define AUTOMATE_LEFT_BRAKE_MSG_IS_EXTENDED (1)
+#define AUTOMATE_MCU_DIAG_MSG_IS_EXTENDED (1)
+#define AUTOMATE_MCU_CONFIG_CMD_IS_EXTENDED (1)
 
 /* Frame cycle times in milliseconds. */
 #define AUTOMATE_HEART_BEAT_MSG_CYCLE_TIME_MS (50u)
 #define AUTOMATE_LEFT_BRAKE_CMD_CYCLE_TIME_MS (100u)
+#define AUTOMATE_MCU_DIAG_MSG_CYCLE_TIME_MS (500u)
 
 /* Signal choices. */
 #define AUTOMATE_HEART_BEAT_MSG_HEALTH_OFF_CHOICE (0u)
@@ -74,10 +81,22 @@ extern "C" {
 #define AUTOMATE_LEFT_BRAKE_CMD_BRAKE_STATE_PUSH_CHOICE (0u)
 #define AUTOMATE_LEFT_BRAKE_CMD_BRAKE_STATE_RELEASE_CHOICE (1u)
 
+#define AUTOMATE_LEFT_BRAKE_MSG_CMD_LATENCY_PENDING_CHOICE (255u)
+
+#define AUTOMATE_MCU_CONFIG_CMD_NODE_ID_UNCHANGED_CHOICE (0u)
+
+#define AUTOMATE_MCU_CONFIG_CMD_HEARTBEAT_CYCLE_UNCHANGED_CHOICE (0u)
+
+#define AUTOMATE_MCU_CONFIG_CMD_TELEMETRY_CYCLE_UNCHANGED_CHOICE (0u)
+
+#define AUTOMATE_MCU_CONFIG_CMD_WATCHDOG_TIMEOUT_UNCHANGED_CHOICE (0u)
+
 /* Frame Names. */
 #define AUTOMATE_HEART_BEAT_MSG_NAME "Heart_Beat_MSG"
 #define AUTOMATE_LEFT_BRAKE_CMD_NAME "Left_Brake_CMD"
 #define AUTOMATE_LEFT_BRAKE_MSG_NAME "Left_Brake_MSG"
+#define AUTOMATE_MCU_DIAG_MSG_NAME "MCU_Diag_MSG"
+#define AUTOMATE_MCU_CONFIG_CMD_NAME "MCU_Config_CMD"
 
 /* Signal Names. */
 #define AUTOMATE_HEART_BEAT_MSG_NODE_ID_NAME "Node_id"
@@ -94,6 +113,22 @@ extern "C" {
 #define AUTOMATE_LEFT_BRAKE_MSG_BRAKE_PUSHING_NAME "Brake_Pushing"
 #define AUTOMATE_LEFT_BRAKE_MSG_BRAKE_PUSHED_NAME "Brake_Pushed"
 #define AUTOMATE_LEFT_BRAKE_MSG_TIME_TO_END_OPERATION_NAME "Time_to_end_operation"
+#define AUTOMATE_LEFT_BRAKE_MSG_CMD_MSG_ID_NAME "Cmd_MSG_Id"
+#define AUTOMATE_LEFT_BRAKE_MSG_CMD_LATENCY_NAME "Cmd_Latency"
+#define AUTOMATE_MCU_DIAG_MSG_RX_FRAMES_NAME "Rx_Frames"
+#define AUTOMATE_MCU_DIAG_MSG_TX_FRAMES_NAME "Tx_Frames"
+#define AUTOMATE_MCU_DIAG_MSG_RING_DROPS_NAME "Ring_Drops"
+#define AUTOMATE_MCU_DIAG_MSG_TEC_NAME "TEC"
+#define AUTOMATE_MCU_DIAG_MSG_REC_NAME "REC"
+#define AUTOMATE_MCU_DIAG_MSG_BUS_OFF_NAME "Bus_Off"
+#define AUTOMATE_MCU_DIAG_MSG_BUS_OFF_COUNT_NAME "Bus_Off_Count"
+#define AUTOMATE_MCU_DIAG_MSG_LOOP_OVERRUNS_NAME "Loop_Overruns"
+#define AUTOMATE_MCU_DIAG_MSG_CPU_LOAD_NAME "CPU_Load"
+#define AUTOMATE_MCU_CONFIG_CMD_TARGET_NODE_ID_NAME "Target_Node_id"
+#define AUTOMATE_MCU_CONFIG_CMD_NODE_ID_NAME "Node_id"
+#define AUTOMATE_MCU_CONFIG_CMD_HEARTBEAT_CYCLE_NAME "Heartbeat_Cycle"
+#define AUTOMATE_MCU_CONFIG_CMD_TELEMETRY_CYCLE_NAME "Telemetry_Cycle"
+#define AUTOMATE_MCU_CONFIG_CMD_WATCHDOG_TIMEOUT_NAME "Watchdog_Timeout"
 
 /**
  * Signals in message Heart_Beat_MSG.
@@ -212,6 +247,132 @@ struct automate_left_brake_msg_t {
      * Offset: 0
      */
     uint16_t time_to_end_operation;
+
+    /**
+     * Range: 0..255 (0..255 -)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint8_t cmd_msg_id;
+
+    /**
+     * Range: 0..255 (0..25.5 ms)
+     * Scale: 0.1
+     * Offset: 0
+     */
+    uint8_t cmd_latency;
+};
+
+/**
+ * Signals in message MCU_Diag_MSG.
+ *
+ * All signal values are as on the CAN bus.
+ */
+struct automate_mcu_diag_msg_t {
+    /**
+     * Range: 0..4095 (0..4095 frames)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint16_t rx_frames;
+
+    /**
+     * Range: 0..4095 (0..4095 frames)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint16_t tx_frames;
+
+    /**
+     * Range: 0..255 (0..255 frames)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint8_t ring_drops;
+
+    /**
+     * Range: 0..255 (0..255 -)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint8_t tec;
+
+    /**
+     * Range: 0..127 (0..127 -)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint8_t rec;
+
+    /**
+     * Range: 0..1 (0..1 -)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint8_t bus_off;
+
+    /**
+     * Range: 0..15 (0..15 -)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint8_t bus_off_count;
+
+    /**
+     * Range: 0..15 (0..15 -)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint8_t loop_overruns;
+
+    /**
+     * Range: 0..100 (0..100 %)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint8_t cpu_load;
+};
+
+/**
+ * Signals in message MCU_Config_CMD.
+ *
+ * All signal values are as on the CAN bus.
+ */
+struct automate_mcu_config_cmd_t {
+    /**
+     * Range: 0..255 (0..255 -)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint8_t target_node_id;
+
+    /**
+     * Range: 0..255 (0..255 -)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint8_t node_id;
+
+    /**
+     * Range: 0..65535 (0..65535 ms)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint16_t heartbeat_cycle;
+
+    /**
+     * Range: 0..65535 (0..65535 ms)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint16_t telemetry_cycle;
+
+    /**
+     * Range: 0..65535 (0..65535 ms)
+     * Scale: 1
+     * Offset: 0
+     */
+    uint16_t watchdog_timeout;
 };
 
 /**
@@ -703,6 +864,512 @@ double automate_left_brake_msg_time_to_end_operation_decode(uint16_t value);
  */
 bool automate_left_brake_msg_time_to_end_operation_is_in_range(uint16_t value);
 
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint8_t automate_left_brake_msg_cmd_msg_id_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_left_brake_msg_cmd_msg_id_decode(uint8_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_left_brake_msg_cmd_msg_id_is_in_range(uint8_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint8_t automate_left_brake_msg_cmd_latency_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_left_brake_msg_cmd_latency_decode(uint8_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_left_brake_msg_cmd_latency_is_in_range(uint8_t value);
+
+/**
+ * Pack message MCU_Diag_MSG.
+ *
+ * @param[out] dst_p Buffer to pack the message into.
+ * @param[in] src_p Data to pack.
+ * @param[in] size Size of dst_p.
+ *
+ * @return Size of packed data, or negative error code.
+ */
+int automate_mcu_diag_msg_pack(
+    uint8_t *dst_p,
+    const struct automate_mcu_diag_msg_t *src_p,
+    size_t size);
+
+/**
+ * Unpack message MCU_Diag_MSG.
+ *
+ * @param[out] dst_p Object to unpack the message into.
+ * @param[in] src_p Message to unpack.
+ * @param[in] size Size of src_p.
+ *
+ * @return zero(0) or negative error code.
+ */
+int automate_mcu_diag_msg_unpack(
+    struct automate_mcu_diag_msg_t *dst_p,
+    const uint8_t *src_p,
+    size_t size);
+
+/**
+ * Init message fields to default values from MCU_Diag_MSG.
+ *
+ * @param[in] msg_p Message to init.
+ *
+ * @return zero(0) on success or (-1) in case of nullptr argument.
+ */
+int automate_mcu_diag_msg_init(struct automate_mcu_diag_msg_t *msg_p);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint16_t automate_mcu_diag_msg_rx_frames_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_diag_msg_rx_frames_decode(uint16_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_diag_msg_rx_frames_is_in_range(uint16_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint16_t automate_mcu_diag_msg_tx_frames_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_diag_msg_tx_frames_decode(uint16_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_diag_msg_tx_frames_is_in_range(uint16_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint8_t automate_mcu_diag_msg_ring_drops_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_diag_msg_ring_drops_decode(uint8_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_diag_msg_ring_drops_is_in_range(uint8_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint8_t automate_mcu_diag_msg_tec_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_diag_msg_tec_decode(uint8_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_diag_msg_tec_is_in_range(uint8_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint8_t automate_mcu_diag_msg_rec_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_diag_msg_rec_decode(uint8_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_diag_msg_rec_is_in_range(uint8_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint8_t automate_mcu_diag_msg_bus_off_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_diag_msg_bus_off_decode(uint8_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_diag_msg_bus_off_is_in_range(uint8_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint8_t automate_mcu_diag_msg_bus_off_count_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_diag_msg_bus_off_count_decode(uint8_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_diag_msg_bus_off_count_is_in_range(uint8_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint8_t automate_mcu_diag_msg_loop_overruns_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_diag_msg_loop_overruns_decode(uint8_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_diag_msg_loop_overruns_is_in_range(uint8_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint8_t automate_mcu_diag_msg_cpu_load_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_diag_msg_cpu_load_decode(uint8_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_diag_msg_cpu_load_is_in_range(uint8_t value);
+
+/**
+ * Pack message MCU_Config_CMD.
+ *
+ * @param[out] dst_p Buffer to pack the message into.
+ * @param[in] src_p Data to pack.
+ * @param[in] size Size of dst_p.
+ *
+ * @return Size of packed data, or negative error code.
+ */
+int automate_mcu_config_cmd_pack(
+    uint8_t *dst_p,
+    const struct automate_mcu_config_cmd_t *src_p,
+    size_t size);
+
+/**
+ * Unpack message MCU_Config_CMD.
+ *
+ * @param[out] dst_p Object to unpack the message into.
+ * @param[in] src_p Message to unpack.
+ * @param[in] size Size of src_p.
+ *
+ * @return zero(0) or negative error code.
+ */
+int automate_mcu_config_cmd_unpack(
+    struct automate_mcu_config_cmd_t *dst_p,
+    const uint8_t *src_p,
+    size_t size);
+
+/**
+ * Init message fields to default values from MCU_Config_CMD.
+ *
+ * @param[in] msg_p Message to init.
+ *
+ * @return zero(0) on success or (-1) in case of nullptr argument.
+ */
+int automate_mcu_config_cmd_init(struct automate_mcu_config_cmd_t *msg_p);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint8_t automate_mcu_config_cmd_target_node_id_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_config_cmd_target_node_id_decode(uint8_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_config_cmd_target_node_id_is_in_range(uint8_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint8_t automate_mcu_config_cmd_node_id_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_config_cmd_node_id_decode(uint8_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_config_cmd_node_id_is_in_range(uint8_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint16_t automate_mcu_config_cmd_heartbeat_cycle_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_config_cmd_heartbeat_cycle_decode(uint16_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_config_cmd_heartbeat_cycle_is_in_range(uint16_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint16_t automate_mcu_config_cmd_telemetry_cycle_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_config_cmd_telemetry_cycle_decode(uint16_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_config_cmd_telemetry_cycle_is_in_range(uint16_t value);
+
+/**
+ * Encode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to encode.
+ *
+ * @return Encoded signal.
+ */
+uint16_t automate_mcu_config_cmd_watchdog_timeout_encode(double value);
+
+/**
+ * Decode given signal by applying scaling and offset.
+ *
+ * @param[in] value Signal to decode.
+ *
+ * @return Decoded signal.
+ */
+double automate_mcu_config_cmd_watchdog_timeout_decode(uint16_t value);
+
+/**
+ * Check that given signal is in allowed range.
+ *
+ * @param[in] value Signal to check.
+ *
+ * @return true if in range, false otherwise.
+ */
+bool automate_mcu_config_cmd_watchdog_timeout_is_in_range(uint16_t value);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,449 @@
+/**
+ * @file automate_codec.h
+ * @brief Table-driven inline pack/unpack for automate protocol frames
+ *
+ * Every frame is described by a const table of little-endian (Intel)
+ * signals: start bit and bit length inside the 64-bit payload. One generic
+ * inline routine packs or unpacks any frame from its descriptor. With the
+ * descriptor known at compile time the loop is unrolled and folded, so
+ * byte-aligned fields become plain loads/stores and no per-frame call is
+ * made. A new DBC message only needs a new descriptor table.
+ *
+ * Hand-written from the DBC layout used by automate.c; keep in sync with
+ * the generated code when the DBC changes.
+ */
+
+#ifndef AUTOMATE_CODEC_H
+#define AUTOMATE_CODEC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "automate.h"
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "automate_codec.h assumes a little-endian target"
+#endif
+
+/* ============================================================================
+ * Type Definitions
+ * ============================================================================ */
+
+/**
+ * @brief Little-endian signal position inside a frame payload
+ */
+typedef struct {
+    uint8_t start_bit;      /**< LSB position (0-63) */
+    uint8_t length;         /**< Width in bits (1-32) */
+} automate_signal_desc_t;
+
+/**
+ * @brief Frame layout descriptor
+ */
+typedef struct {
+    uint32_t frame_id;                      /**< CAN identifier */
+    uint8_t length;                         /**< Payload length in bytes */
+    uint8_t signal_count;                   /**< Entries in signals[] */
+    const automate_signal_desc_t *signals;  /**< Signal table (unpack order) */
+} automate_frame_desc_t;
+
+/* ============================================================================
+ * Frame Descriptors
+ * ============================================================================ */
+
+/* Heart_Beat_MSG: Node_id, MSG_Count, Health, Stamp */
+enum {
+    AUTOMATE_HEART_BEAT_MSG_SIG_NODE_ID = 0,
+    AUTOMATE_HEART_BEAT_MSG_SIG_MSG_COUNT,
+    AUTOMATE_HEART_BEAT_MSG_SIG_HEALTH,
+    AUTOMATE_HEART_BEAT_MSG_SIG_STAMP,
+    AUTOMATE_HEART_BEAT_MSG_SIG_COUNT
+};
+
+static const automate_signal_desc_t automate_heart_beat_msg_signals[AUTOMATE_HEART_BEAT_MSG_SIG_COUNT] = {
+    {  0u,  8u },
+    {  8u, 32u },
+    { 40u,  8u },
+    { 48u, 16u },
+};
+
+static const automate_frame_desc_t automate_heart_beat_msg_desc = {
+    AUTOMATE_HEART_BEAT_MSG_FRAME_ID, AUTOMATE_HEART_BEAT_MSG_LENGTH,
+    AUTOMATE_HEART_BEAT_MSG_SIG_COUNT, automate_heart_beat_msg_signals
+};
+
+/* Left_Brake_CMD: MSG_Id, Stamp, Brake_State */
+enum {
+    AUTOMATE_LEFT_BRAKE_CMD_SIG_MSG_ID = 0,
+    AUTOMATE_LEFT_BRAKE_CMD_SIG_STAMP,
+    AUTOMATE_LEFT_BRAKE_CMD_SIG_BRAKE_STATE,
+    AUTOMATE_LEFT_BRAKE_CMD_SIG_COUNT
+};
+
+static const automate_signal_desc_t automate_left_brake_cmd_signals[AUTOMATE_LEFT_BRAKE_CMD_SIG_COUNT] = {
+    {  0u,  8u },
+    {  8u, 16u },
+    { 24u,  1u },
+};
+
+static const automate_frame_desc_t automate_left_brake_cmd_desc = {
+    AUTOMATE_LEFT_BRAKE_CMD_FRAME_ID, AUTOMATE_LEFT_BRAKE_CMD_LENGTH,
+    AUTOMATE_LEFT_BRAKE_CMD_SIG_COUNT, automate_left_brake_cmd_signals
+};
+
+/* Left_Brake_MSG: MSG_Id, Stamp, 4 state flags, Time_to_end_operation, Cmd_MSG_Id, Cmd_Latency */
+enum {
+    AUTOMATE_LEFT_BRAKE_MSG_SIG_MSG_ID = 0,
+    AUTOMATE_LEFT_BRAKE_MSG_SIG_STAMP,
+    AUTOMATE_LEFT_BRAKE_MSG_SIG_BRAKE_RELEASING,
+    AUTOMATE_LEFT_BRAKE_MSG_SIG_BRAKE_RELEASED,
+    AUTOMATE_LEFT_BRAKE_MSG_SIG_BRAKE_PUSHING,
+    AUTOMATE_LEFT_BRAKE_MSG_SIG_BRAKE_PUSHED,
+    AUTOMATE_LEFT_BRAKE_MSG_SIG_TIME_TO_END_OPERATION,
+    AUTOMATE_LEFT_BRAKE_MSG_SIG_CMD_MSG_ID,
+    AUTOMATE_LEFT_BRAKE_MSG_SIG_CMD_LATENCY,
+    AUTOMATE_LEFT_BRAKE_MSG_SIG_COUNT
+};
+
+static const automate_signal_desc_t automate_left_brake_msg_signals[AUTOMATE_LEFT_BRAKE_MSG_SIG_COUNT] = {
+    {  0u,  8u },
+    {  8u, 16u },
+    { 24u,  1u },
+    { 25u,  1u },
+    { 26u,  1u },
+    { 27u,  1u },
+    { 32u, 16u },
+    { 48u,  8u },
+    { 56u,  8u },
+};
+
+static const automate_frame_desc_t automate_left_brake_msg_desc = {
+    AUTOMATE_LEFT_BRAKE_MSG_FRAME_ID, AUTOMATE_LEFT_BRAKE_MSG_LENGTH,
+    AUTOMATE_LEFT_BRAKE_MSG_SIG_COUNT, automate_left_brake_msg_signals
+};
+
+/* Right_Brake_CMD / Right_Brake_MSG: second actuator (BRAKE_RIGHT), same
+ * layout as Left_Brake_CMD / Left_Brake_MSG - use the Left_* structs and
+ * wrappers, only the identifier differs */
+#define AUTOMATE_RIGHT_BRAKE_CMD_FRAME_ID (0x1800ad0bu)
+#define AUTOMATE_RIGHT_BRAKE_MSG_FRAME_ID (0x1800ad0cu)
+
+/* MCU_Diag_MSG: frame counters, drops, TEC/REC, bus-off, overruns, CPU load */
+enum {
+    AUTOMATE_MCU_DIAG_MSG_SIG_RX_FRAMES = 0,
+    AUTOMATE_MCU_DIAG_MSG_SIG_TX_FRAMES,
+    AUTOMATE_MCU_DIAG_MSG_SIG_RING_DROPS,
+    AUTOMATE_MCU_DIAG_MSG_SIG_TEC,
+    AUTOMATE_MCU_DIAG_MSG_SIG_REC,
+    AUTOMATE_MCU_DIAG_MSG_SIG_BUS_OFF,
+    AUTOMATE_MCU_DIAG_MSG_SIG_BUS_OFF_COUNT,
+    AUTOMATE_MCU_DIAG_MSG_SIG_LOOP_OVERRUNS,
+    AUTOMATE_MCU_DIAG_MSG_SIG_CPU_LOAD,
+    AUTOMATE_MCU_DIAG_MSG_SIG_COUNT
+};
+
+static const automate_signal_desc_t automate_mcu_diag_msg_signals[AUTOMATE_MCU_DIAG_MSG_SIG_COUNT] = {
+    {  0u, 12u },
+    { 12u, 12u },
+    { 24u,  8u },
+    { 32u,  8u },
+    { 40u,  7u },
+    { 47u,  1u },
+    { 48u,  4u },
+    { 52u,  4u },
+    { 56u,  8u },
+};
+
+static const automate_frame_desc_t automate_mcu_diag_msg_desc = {
+    AUTOMATE_MCU_DIAG_MSG_FRAME_ID, AUTOMATE_MCU_DIAG_MSG_LENGTH,
+    AUTOMATE_MCU_DIAG_MSG_SIG_COUNT, automate_mcu_diag_msg_signals
+};
+
+/* MCU_Config_CMD: Target_Node_id, Node_id, Heartbeat_Cycle, Telemetry_Cycle, Watchdog_Timeout */
+enum {
+    AUTOMATE_MCU_CONFIG_CMD_SIG_TARGET_NODE_ID = 0,
+    AUTOMATE_MCU_CONFIG_CMD_SIG_NODE_ID,
+    AUTOMATE_MCU_CONFIG_CMD_SIG_HEARTBEAT_CYCLE,
+    AUTOMATE_MCU_CONFIG_CMD_SIG_TELEMETRY_CYCLE,
+    AUTOMATE_MCU_CONFIG_CMD_SIG_WATCHDOG_TIMEOUT,
+    AUTOMATE_MCU_CONFIG_CMD_SIG_COUNT
+};
+
+static const automate_signal_desc_t automate_mcu_config_cmd_signals[AUTOMATE_MCU_CONFIG_CMD_SIG_COUNT] = {
+    {  0u,  8u },
+    {  8u,  8u },
+    { 16u, 16u },
+    { 32u, 16u },
+    { 48u, 16u },
+};
+
+static const automate_frame_desc_t automate_mcu_config_cmd_desc = {
+    AUTOMATE_MCU_CONFIG_CMD_FRAME_ID, AUTOMATE_MCU_CONFIG_CMD_LENGTH,
+    AUTOMATE_MCU_CONFIG_CMD_SIG_COUNT, automate_mcu_config_cmd_signals
+};
+
+/* ============================================================================
+ * Generic Pack/Unpack
+ * ============================================================================ */
+
+/**
+ * @brief Load 8-byte payload as one little-endian word
+ */
+static inline uint64_t automate_codec_load(const uint8_t *src_p)
+{
+    uint64_t raw;
+
+    memcpy(&raw, src_p, sizeof(raw));
+    return raw;
+}
+
+/**
+ * @brief Store one little-endian word as 8-byte payload
+ */
+static inline void automate_codec_store(uint8_t *dst_p, uint64_t raw)
+{
+    memcpy(dst_p, &raw, sizeof(raw));
+}
+
+/**
+ * @brief Extract one signal from a loaded payload
+ */
+static inline uint32_t automate_codec_get(uint64_t raw, const automate_signal_desc_t *sig)
+{
+    return (uint32_t)((raw >> sig->start_bit) & ((1ull << sig->length) - 1u));
+}
+
+/**
+ * @brief Pack raw signal values into a frame payload
+ *
+ * @param dst_p Destination buffer (at least 8 bytes)
+ * @param size Size of dst_p
+ * @param frame Frame descriptor
+ * @param values Raw signal values in descriptor order
+ * @return Frame length, or -EINVAL if dst_p is too small
+ */
+static inline int automate_codec_pack(uint8_t *dst_p, size_t size,
+                                      const automate_frame_desc_t *frame,
+                                      const uint32_t *values)
+{
+    uint64_t raw = 0;
+
+    if (size < 8u) {
+        return (-EINVAL);
+    }
+
+    for (uint8_t i = 0; i < frame->signal_count; i++) {
+        const automate_signal_desc_t *sig = &frame->signals[i];
+        raw |= ((uint64_t)values[i] & ((1ull << sig->length) - 1u)) << sig->start_bit;
+    }
+
+    automate_codec_store(dst_p, raw);
+
+    return (int)frame->length;
+}
+
+/**
+ * @brief Unpack a frame payload into raw signal values
+ *
+ * @param values Destination, one entry per descriptor signal
+ * @param frame Frame descriptor
+ * @param src_p Received payload
+ * @param size Size of src_p
+ * @return zero(0), or -EINVAL if payload shorter than the frame
+ */
+static inline int automate_codec_unpack(uint32_t *values,
+                                        const automate_frame_desc_t *frame,
+                                        const uint8_t *src_p, size_t size)
+{
+    uint8_t buf[8] = {0};
+    uint64_t raw;
+
+    if (size < frame->length) {
+        return (-EINVAL);
+    }
+
+    /* Frames shorter than 8 bytes are zero-extended */
+    if (frame->length < 8u) {
+        memcpy(buf, src_p, frame->length);
+        raw = automate_codec_load(buf);
+    } else {
+        raw = automate_codec_load(src_p);
+    }
+
+    for (uint8_t i = 0; i < frame->signal_count; i++) {
+        values[i] = automate_codec_get(raw, &frame->signals[i]);
+    }
+
+    return (0);
+}
+
+/* ============================================================================
+ * Message Wrappers (drop-in for automate_*_pack / automate_*_unpack)
+ * ============================================================================ */
+
+static inline int automate_codec_heart_beat_msg_pack(uint8_t *dst_p,
+                                                     const struct automate_heart_beat_msg_t *src_p,
+                                                     size_t size)
+{
+    const uint32_t values[AUTOMATE_HEART_BEAT_MSG_SIG_COUNT] = {
+        src_p->node_id, src_p->msg_count, src_p->health, src_p->stamp
+    };
+
+    return automate_codec_pack(dst_p, size, &automate_heart_beat_msg_desc, values);
+}
+
+static inline int automate_codec_heart_beat_msg_unpack(struct automate_heart_beat_msg_t *dst_p,
+                                                       const uint8_t *src_p, size_t size)
+{
+    uint32_t values[AUTOMATE_HEART_BEAT_MSG_SIG_COUNT];
+
+    if (automate_codec_unpack(values, &automate_heart_beat_msg_desc, src_p, size) != 0) {
+        return (-EINVAL);
+    }
+
+    dst_p->node_id = (uint8_t)values[AUTOMATE_HEART_BEAT_MSG_SIG_NODE_ID];
+    dst_p->msg_count = values[AUTOMATE_HEART_BEAT_MSG_SIG_MSG_COUNT];
+    dst_p->health = (uint8_t)values[AUTOMATE_HEART_BEAT_MSG_SIG_HEALTH];
+    dst_p->stamp = (uint16_t)values[AUTOMATE_HEART_BEAT_MSG_SIG_STAMP];
+
+    return (0);
+}
+
+static inline int automate_codec_left_brake_cmd_pack(uint8_t *dst_p,
+                                                     const struct automate_left_brake_cmd_t *src_p,
+                                                     size_t size)
+{
+    const uint32_t values[AUTOMATE_LEFT_BRAKE_CMD_SIG_COUNT] = {
+        src_p->msg_id, src_p->stamp, src_p->brake_state
+    };
+
+    return automate_codec_pack(dst_p, size, &automate_left_brake_cmd_desc, values);
+}
+
+static inline int automate_codec_left_brake_cmd_unpack(struct automate_left_brake_cmd_t *dst_p,
+                                                       const uint8_t *src_p, size_t size)
+{
+    uint32_t values[AUTOMATE_LEFT_BRAKE_CMD_SIG_COUNT];
+
+    if (automate_codec_unpack(values, &automate_left_brake_cmd_desc, src_p, size) != 0) {
+        return (-EINVAL);
+    }
+
+    dst_p->msg_id = (uint8_t)values[AUTOMATE_LEFT_BRAKE_CMD_SIG_MSG_ID];
+    dst_p->stamp = (uint16_t)values[AUTOMATE_LEFT_BRAKE_CMD_SIG_STAMP];
+    dst_p->brake_state = (uint8_t)values[AUTOMATE_LEFT_BRAKE_CMD_SIG_BRAKE_STATE];
+
+    return (0);
+}
+
+static inline int automate_codec_left_brake_msg_pack(uint8_t *dst_p,
+                                                     const struct automate_left_brake_msg_t *src_p,
+                                                     size_t size)
+{
+    const uint32_t values[AUTOMATE_LEFT_BRAKE_MSG_SIG_COUNT] = {
+        src_p->msg_id, src_p->stamp,
+        src_p->brake_releasing, src_p->brake_released,
+        src_p->brake_pushing, src_p->brake_pushed,
+        src_p->time_to_end_operation,
+        src_p->cmd_msg_id, src_p->cmd_latency
+    };
+
+    return automate_codec_pack(dst_p, size, &automate_left_brake_msg_desc, values);
+}
+
+static inline int automate_codec_left_brake_msg_unpack(struct automate_left_brake_msg_t *dst_p,
+                                                       const uint8_t *src_p, size_t size)
+{
+    uint32_t values[AUTOMATE_LEFT_BRAKE_MSG_SIG_COUNT];
+
+    if (automate_codec_unpack(values, &automate_left_brake_msg_desc, src_p, size) != 0) {
+        return (-EINVAL);
+    }
+
+    dst_p->msg_id = (uint8_t)values[AUTOMATE_LEFT_BRAKE_MSG_SIG_MSG_ID];
+    dst_p->stamp = (uint16_t)values[AUTOMATE_LEFT_BRAKE_MSG_SIG_STAMP];
+    dst_p->brake_releasing = (uint8_t)values[AUTOMATE_LEFT_BRAKE_MSG_SIG_BRAKE_RELEASING];
+    dst_p->brake_released = (uint8_t)values[AUTOMATE_LEFT_BRAKE_MSG_SIG_BRAKE_RELEASED];
+    dst_p->brake_pushing = (uint8_t)values[AUTOMATE_LEFT_BRAKE_MSG_SIG_BRAKE_PUSHING];
+    dst_p->brake_pushed = (uint8_t)values[AUTOMATE_LEFT_BRAKE_MSG_SIG_BRAKE_PUSHED];
+    dst_p->time_to_end_operation = (uint16_t)values[AUTOMATE_LEFT_BRAKE_MSG_SIG_TIME_TO_END_OPERATION];
+    dst_p->cmd_msg_id = (uint8_t)values[AUTOMATE_LEFT_BRAKE_MSG_SIG_CMD_MSG_ID];
+    dst_p->cmd_latency = (uint8_t)values[AUTOMATE_LEFT_BRAKE_MSG_SIG_CMD_LATENCY];
+
+    return (0);
+}
+
+static inline int automate_codec_mcu_diag_msg_pack(uint8_t *dst_p,
+                                                   const struct automate_mcu_diag_msg_t *src_p,
+                                                   size_t size)
+{
+    const uint32_t values[AUTOMATE_MCU_DIAG_MSG_SIG_COUNT] = {
+        src_p->rx_frames, src_p->tx_frames, src_p->ring_drops,
+        src_p->tec, src_p->rec, src_p->bus_off,
+        src_p->bus_off_count, src_p->loop_overruns, src_p->cpu_load
+    };
+
+    return automate_codec_pack(dst_p, size, &automate_mcu_diag_msg_desc, values);
+}
+
+static inline int automate_codec_mcu_diag_msg_unpack(struct automate_mcu_diag_msg_t *dst_p,
+                                                     const uint8_t *src_p, size_t size)
+{
+    uint32_t values[AUTOMATE_MCU_DIAG_MSG_SIG_COUNT];
+
+    if (automate_codec_unpack(values, &automate_mcu_diag_msg_desc, src_p, size) != 0) {
+        return (-EINVAL);
+    }
+
+    dst_p->rx_frames = (uint16_t)values[AUTOMATE_MCU_DIAG_MSG_SIG_RX_FRAMES];
+    dst_p->tx_frames = (uint16_t)values[AUTOMATE_MCU_DIAG_MSG_SIG_TX_FRAMES];
+    dst_p->ring_drops = (uint8_t)values[AUTOMATE_MCU_DIAG_MSG_SIG_RING_DROPS];
+    dst_p->tec = (uint8_t)values[AUTOMATE_MCU_DIAG_MSG_SIG_TEC];
+    dst_p->rec = (uint8_t)values[AUTOMATE_MCU_DIAG_MSG_SIG_REC];
+    dst_p->bus_off = (uint8_t)values[AUTOMATE_MCU_DIAG_MSG_SIG_BUS_OFF];
+    dst_p->bus_off_count = (uint8_t)values[AUTOMATE_MCU_DIAG_MSG_SIG_BUS_OFF_COUNT];
+    dst_p->loop_overruns = (uint8_t)values[AUTOMATE_MCU_DIAG_MSG_SIG_LOOP_OVERRUNS];
+    dst_p->cpu_load = (uint8_t)values[AUTOMATE_MCU_DIAG_MSG_SIG_CPU_LOAD];
+
+    return (0);
+}
+
+static inline int automate_codec_mcu_config_cmd_pack(uint8_t *dst_p,
+                                                     const struct automate_mcu_config_cmd_t *src_p,
+                                                     size_t size)
+{
+    const uint32_t values[AUTOMATE_MCU_CONFIG_CMD_SIG_COUNT] = {
+        src_p->target_node_id, src_p->node_id, src_p->heartbeat_cycle,
+        src_p->telemetry_cycle, src_p->watchdog_timeout
+    };
+
+    return automate_codec_pack(dst_p, size, &automate_mcu_config_cmd_desc, values);
+}
+
+static inline int automate_codec_mcu_config_cmd_unpack(struct automate_mcu_config_cmd_t *dst_p,
+                                                       const uint8_t *src_p, size_t size)
+{
+    uint32_t values[AUTOMATE_MCU_CONFIG_CMD_SIG_COUNT];
+
+    if (automate_codec_unpack(values, &automate_mcu_config_cmd_desc, src_p, size) != 0) {
+        return (-EINVAL);
+    }
+
+    dst_p->target_node_id = (uint8_t)values[AUTOMATE_MCU_CONFIG_CMD_SIG_TARGET_NODE_ID];
+    dst_p->node_id = (uint8_t)values[AUTOMATE_MCU_CONFIG_CMD_SIG_NODE_ID];
+    dst_p->heartbeat_cycle = (uint16_t)values[AUTOMATE_MCU_CONFIG_CMD_SIG_HEARTBEAT_CYCLE];
+    dst_p->telemetry_cycle = (uint16_t)values[AUTOMATE_MCU_CONFIG_CMD_SIG_TELEMETRY_CYCLE];
+    dst_p->watchdog_timeout = (uint16_t)values[AUTOMATE_MCU_CONFIG_CMD_SIG_WATCHDOG_TIMEOUT];
+
+    return (0);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUTOMATE_CODEC_H */
@@ -0,0 +1,265 @@
+/**
+ * @file automate_int.h
+ * @brief Integer-only signal encode/decode companion for automate.h
+ *
+ * The cantools-generated *_encode(double) / *_decode() functions work in
+ * double precision, which the Cortex-M4F can only emulate in software.
+ * This header provides static inline integer equivalents for every signal
+ * of Heart_Beat_MSG, Left_Brake_CMD, Left_Brake_MSG and MCU_Diag_MSG. Scale and offset
+ * are rational compile-time constants, so each call folds down to a
+ * clamp (and a multiply/shift for non-unit scales).
+ *
+ * Hand-written: keep in sync with automate.h when the DBC changes.
+ * Encode saturates to the DBC signal range; decode returns physical units.
+ */
+
+#ifndef AUTOMATE_INT_H
+#define AUTOMATE_INT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "automate.h"
+
+/* ============================================================================
+ * Generic Helpers
+ * ============================================================================ */
+
+/**
+ * @brief Convert physical value to raw: raw = (phys - offset) * den / num
+ *
+ * Signal scale is num/den. With constant arguments the compiler folds the
+ * division into a multiply (or nothing for unit scale). 32-bit arithmetic
+ * only, so (phys - offset) * den must fit int32_t.
+ */
+static inline int32_t automate_int_scale_encode(int32_t phys, int32_t num, int32_t den, int32_t offset)
+{
+    return ((phys - offset) * den) / num;
+}
+
+/**
+ * @brief Convert raw value to physical: phys = raw * num / den + offset
+ */
+static inline int32_t automate_int_scale_decode(int32_t raw, int32_t num, int32_t den, int32_t offset)
+{
+    return ((raw * num) / den) + offset;
+}
+
+/**
+ * @brief Saturate value to [min, max]
+ */
+static inline int32_t automate_int_clamp(int32_t value, int32_t min, int32_t max)
+{
+    return (value < min) ? min : ((value > max) ? max : value);
+}
+
+/* ============================================================================
+ * Heart_Beat_MSG
+ * ============================================================================ */
+
+/** Node_id: 0..255, scale 1, offset 0 */
+static inline uint8_t automate_int_heart_beat_msg_node_id_encode(int32_t value)
+{
+    return (uint8_t)automate_int_clamp(automate_int_scale_encode(value, 1, 1, 0), 0, 255);
+}
+
+static inline int32_t automate_int_heart_beat_msg_node_id_decode(uint8_t value)
+{
+    return automate_int_scale_decode(value, 1, 1, 0);
+}
+
+/** MSG_Count: full 32-bit counter, scale 1, offset 0 (wraps) */
+static inline uint32_t automate_int_heart_beat_msg_msg_count_encode(uint32_t value)
+{
+    return value;
+}
+
+static inline uint32_t automate_int_heart_beat_msg_msg_count_decode(uint32_t value)
+{
+    return value;
+}
+
+/** Health: 0..5 (AUTOMATE_HEART_BEAT_MSG_HEALTH_*_CHOICE), scale 1, offset 0 */
+static inline uint8_t automate_int_heart_beat_msg_health_encode(int32_t value)
+{
+    return (uint8_t)automate_int_clamp(automate_int_scale_encode(value, 1, 1, 0),
+                                       0, AUTOMATE_HEART_BEAT_MSG_HEALTH_CRITICAL_FAILURE_CHOICE);
+}
+
+static inline int32_t automate_int_heart_beat_msg_health_decode(uint8_t value)
+{
+    return automate_int_scale_decode(value, 1, 1, 0);
+}
+
+/** Stamp: 0..65535 ms, scale 1, offset 0 */
+static inline uint16_t automate_int_heart_beat_msg_stamp_encode(int32_t value)
+{
+    return (uint16_t)automate_int_clamp(automate_int_scale_encode(value, 1, 1, 0), 0, 65535);
+}
+
+static inline int32_t automate_int_heart_beat_msg_stamp_decode(uint16_t value)
+{
+    return automate_int_scale_decode(value, 1, 1, 0);
+}
+
+/* ============================================================================
+ * Left_Brake_CMD
+ * ============================================================================ */
+
+/** MSG_Id: 0..255, scale 1, offset 0 */
+static inline uint8_t automate_int_left_brake_cmd_msg_id_encode(int32_t value)
+{
+    return (uint8_t)automate_int_clamp(automate_int_scale_encode(value, 1, 1, 0), 0, 255);
+}
+
+static inline int32_t automate_int_left_brake_cmd_msg_id_decode(uint8_t value)
+{
+    return automate_int_scale_decode(value, 1, 1, 0);
+}
+
+/** Stamp: 0..65535 ms, scale 1, offset 0 */
+static inline uint16_t automate_int_left_brake_cmd_stamp_encode(int32_t value)
+{
+    return (uint16_t)automate_int_clamp(automate_int_scale_encode(value, 1, 1, 0), 0, 65535);
+}
+
+static inline int32_t automate_int_left_brake_cmd_stamp_decode(uint16_t value)
+{
+    return automate_int_scale_decode(value, 1, 1, 0);
+}
+
+/** Brake_State: 0..1 (AUTOMATE_LEFT_BRAKE_CMD_BRAKE_STATE_*_CHOICE), scale 1, offset 0 */
+static inline uint8_t automate_int_left_brake_cmd_brake_state_encode(int32_t value)
+{
+    return (uint8_t)automate_int_clamp(automate_int_scale_encode(value, 1, 1, 0), 0, 1);
+}
+
+static inline int32_t automate_int_left_brake_cmd_brake_state_decode(uint8_t value)
+{
+    return automate_int_scale_decode(value, 1, 1, 0);
+}
+
+/* ============================================================================
+ * Left_Brake_MSG
+ * ============================================================================ */
+
+/** MSG_Id: 0..255, scale 1, offset 0 */
+static inline uint8_t automate_int_left_brake_msg_msg_id_encode(int32_t value)
+{
+    return (uint8_t)automate_int_clamp(automate_int_scale_encode(value, 1, 1, 0), 0, 255);
+}
+
+static inline int32_t automate_int_left_brake_msg_msg_id_decode(uint8_t value)
+{
+    return automate_int_scale_decode(value, 1, 1, 0);
+}
+
+/** Stamp: 0..65535 ms, scale 1, offset 0 */
+static inline uint16_t automate_int_left_brake_msg_stamp_encode(int32_t value)
+{
+    return (uint16_t)automate_int_clamp(automate_int_scale_encode(value, 1, 1, 0), 0, 65535);
+}
+
+static inline int32_t automate_int_left_brake_msg_stamp_decode(uint16_t value)
+{
+    return automate_int_scale_decode(value, 1, 1, 0);
+}
+
+/** Brake_Releasing / Brake_Released / Brake_Pushing / Brake_Pushed: 0..1 flags */
+static inline uint8_t automate_int_left_brake_msg_flag_encode(int32_t value)
+{
+    return (uint8_t)automate_int_clamp(value, 0, 1);
+}
+
+static inline int32_t automate_int_left_brake_msg_flag_decode(uint8_t value)
+{
+    return (int32_t)(value & 1u);
+}
+
+/** Time_to_end_operation: 0..65535 ms, scale 1, offset 0 */
+static inline uint16_t automate_int_left_brake_msg_time_to_end_operation_encode(int32_t value)
+{
+    return (uint16_t)automate_int_clamp(automate_int_scale_encode(value, 1, 1, 0), 0, 65535);
+}
+
+static inline int32_t automate_int_left_brake_msg_time_to_end_operation_decode(uint16_t value)
+{
+    return automate_int_scale_decode(value, 1, 1, 0);
+}
+
+/** Cmd_MSG_Id: 0..255 echo of Left_Brake_CMD MSG_Id */
+static inline uint8_t automate_int_left_brake_msg_cmd_msg_id_encode(int32_t value)
+{
+    return (uint8_t)automate_int_clamp(value, 0, 255);
+}
+
+/**
+ * Cmd_Latency: 0..25.4 ms in 0.1 ms steps, argument in microseconds.
+ * Saturates at 254; 255 (AUTOMATE_LEFT_BRAKE_MSG_CMD_LATENCY_PENDING_CHOICE)
+ * is reserved for "motor not driven yet".
+ */
+static inline uint8_t automate_int_left_brake_msg_cmd_latency_encode(int32_t value_us)
+{
+    return (uint8_t)automate_int_clamp(automate_int_scale_encode(value_us, 100, 1, 0),
+                                       0, AUTOMATE_LEFT_BRAKE_MSG_CMD_LATENCY_PENDING_CHOICE - 1);
+}
+
+/** Cmd_Latency decode to microseconds */
+static inline int32_t automate_int_left_brake_msg_cmd_latency_decode(uint8_t value)
+{
+    return automate_int_scale_decode(value, 100, 1, 0);
+}
+
+/* ============================================================================
+ * MCU_Diag_MSG
+ * ============================================================================ */
+
+/** Rx_Frames / Tx_Frames: 12-bit wrapping counters, receiver takes differences */
+static inline uint16_t automate_int_mcu_diag_msg_frames_encode(uint32_t value)
+{
+    return (uint16_t)(value & 0x0FFFu);
+}
+
+/** Ring_Drops: 8-bit wrapping counter */
+static inline uint8_t automate_int_mcu_diag_msg_ring_drops_encode(uint32_t value)
+{
+    return (uint8_t)(value & 0xFFu);
+}
+
+/** Bus_Off_Count / Loop_Overruns: 4-bit wrapping counters */
+static inline uint8_t automate_int_mcu_diag_msg_nibble_counter_encode(uint32_t value)
+{
+    return (uint8_t)(value & 0x0Fu);
+}
+
+/** TEC: 0..255, scale 1, offset 0 */
+static inline uint8_t automate_int_mcu_diag_msg_tec_encode(int32_t value)
+{
+    return (uint8_t)automate_int_clamp(value, 0, 255);
+}
+
+/** REC: 0..127, scale 1, offset 0 */
+static inline uint8_t automate_int_mcu_diag_msg_rec_encode(int32_t value)
+{
+    return (uint8_t)automate_int_clamp(value, 0, 127);
+}
+
+/** CPU_Load: 0..100 %, scale 1, offset 0 */
+static inline uint8_t automate_int_mcu_diag_msg_cpu_load_encode(int32_t value)
+{
+    return (uint8_t)automate_int_clamp(value, 0, 100);
+}
+
+/** Counter decode: difference of two consecutive frames, modulo field width */
+static inline uint32_t automate_int_mcu_diag_msg_counter_delta(uint32_t current, uint32_t previous, uint8_t bits)
+{
+    return (current - previous) & ((1u << bits) - 1u);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUTOMATE_INT_H */
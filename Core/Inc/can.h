@@ -15,6 +15,30 @@ extern "C" {
 #include <stdint.h>
 #include <stdbool.h>
 
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+/*
+ * CAN FD mode (0 = classic CAN only, 1 = FD with bit-rate switching).
+ * Only for segments where every node is FD-capable: a classic controller
+ * answers FD frames with error frames. Override from CMake, e.g.
+ *   -DCAN_FD_ENABLED=1
+ */
+#ifndef CAN_FD_ENABLED
+#define CAN_FD_ENABLED              0
+#endif
+
+/* Payload capacity of one ring slot (CAN FD frames carry up to 64 bytes) */
+#if CAN_FD_ENABLED
+#define CAN_MAX_DATA_LEN            64u
+#else
+#define CAN_MAX_DATA_LEN            8u
+#endif
+
+/** Largest payload of a classic CAN frame */
+#define CAN_CLASSIC_MAX_DATA_LEN    8u
+
 /* ============================================================================
  * Type Definitions
  * ============================================================================ */
@@ -22,15 +46,118 @@ extern "C" {
 /**
  * @brief CAN message structure
  * 
- * Represents a single CAN frame with identifier, data, and metadata
+ * Represents a single CAN frame with identifier, data, and metadata.
+ * Slot size follows CAN_MAX_DATA_LEN, so classic builds keep 8-byte slots.
  */
 typedef struct {
     uint32_t id;            /**< CAN identifier (11-bit standard or 29-bit extended) */
-    uint8_t data[8];        /**< Message data payload (0-8 bytes) */
-    uint8_t len;            /**< Data length (0-8) */
+    uint8_t data[CAN_MAX_DATA_LEN]; /**< Message data payload (0-CAN_MAX_DATA_LEN bytes) */
+    uint8_t len;            /**< Data length (0-8, FD frames 0-64 on a valid DLC step) */
     bool is_extended;       /**< true for 29-bit extended ID, false for 11-bit standard */
+    bool is_fd;             /**< true for CAN FD format (sent with bit-rate switch) */
+    uint8_t filter_index;   /**< RX only: matching filter element, CAN_FILTER_INDEX_NONE if none */
+    uint32_t rx_cycles;     /**< RX only: GetCycles() time of frame start, from the FDCAN RX timestamp */
 } CAN_Message_t;
 
+/** filter_index of a frame accepted by the global (non-matching) filter */
+#define CAN_FILTER_INDEX_NONE       0xFFu
+
+/**
+ * @brief TX priority class
+ * 
+ * Each class has its own software TX ring. The high class is always moved
+ * into the hardware TX FIFO first, so heartbeats and fault frames do not
+ * wait behind a telemetry backlog.
+ */
+typedef enum {
+    CAN_TX_PRIORITY_NORMAL = 0,     /**< Telemetry and other periodic data */
+    CAN_TX_PRIORITY_HIGH            /**< Heartbeat and safety/fault frames */
+} CAN_TxPriority_t;
+
+/**
+ * @brief CAN driver queue statistics
+ * 
+ * Counters are cumulative since CAN_Driver_Init(). Use the high-watermarks
+ * to size CAN_RX_BUFFER_SIZE / CAN_TX_BUFFER_SIZE from field data.
+ */
+typedef struct {
+    uint32_t rx_frames;         /**< Frames stored in RX queue */
+    uint32_t rx_dropped;        /**< Frames dropped because RX queue was full */
+    uint32_t tx_frames;         /**< Frames handed to the FDCAN TX FIFO */
+    uint32_t tx_dropped;        /**< Send requests rejected because TX queue was full */
+    uint32_t tx_high_dropped;   /**< High-priority send requests rejected (queue full) */
+    uint32_t rx_fifo_full_events; /**< Hardware RX FIFO 0/1 reached full level */
+    uint32_t rx_fifo_lost;      /**< Hardware RX FIFO 0/1 message-lost events */
+    uint16_t rx_high_watermark; /**< Maximum RX queue fill level observed */
+    uint16_t tx_high_watermark; /**< Maximum TX queue fill level observed */
+    uint16_t tx_high_prio_watermark; /**< Maximum high-priority TX queue fill level observed */
+    uint16_t rx_queue_size;     /**< Configured RX queue depth */
+    uint16_t tx_queue_size;     /**< Configured TX queue depth */
+    uint16_t tx_high_queue_size; /**< Configured high-priority TX queue depth */
+} CAN_Driver_Stats_t;
+
+/**
+ * @brief Bus state tracked by CAN_Driver_Supervise()
+ * 
+ * Ordered by severity.
+ */
+typedef enum {
+    CAN_BUS_STATE_ACTIVE = 0,       /**< Error active, TEC and REC below 96 */
+    CAN_BUS_STATE_WARNING,          /**< TEC or REC reached the warning limit (96) */
+    CAN_BUS_STATE_PASSIVE,          /**< TEC or REC above 127, no active error flags */
+    CAN_BUS_STATE_RECOVERING,       /**< Restarted after bus-off, waiting for 128 x 11 recessive bits */
+    CAN_BUS_STATE_BUS_OFF           /**< Off the bus, restart held off */
+} CAN_BusState_t;
+
+/**
+ * @brief What happens to queued TX frames when the node rejoins after bus-off
+ * 
+ * Frames in the hardware TX FIFO (up to three) are kept unless the policy
+ * is CAN_RECOVERY_FLUSH_ALL.
+ */
+typedef enum {
+    CAN_RECOVERY_KEEP_QUEUED = 0,   /**< Send everything queued before and during bus-off */
+    CAN_RECOVERY_FLUSH_NORMAL,      /**< Drop stale normal-priority frames, keep heartbeat/fault frames */
+    CAN_RECOVERY_FLUSH_ALL          /**< Drop both TX rings and abort the hardware TX FIFO */
+} CAN_RecoveryPolicy_t;
+
+/**
+ * @brief FDCAN error state
+ * 
+ * Counters come straight from the FDCAN error counter (ECR) and protocol
+ * status (PSR) registers; the event counters and state are kept by the
+ * driver.
+ */
+typedef struct {
+    uint8_t tx_error_count;     /**< Transmit error counter (TEC, 0-255) */
+    uint8_t rx_error_count;     /**< Receive error counter (REC, 0-127) */
+    bool error_passive;         /**< Node is error passive (TEC or REC > 127) */
+    bool bus_off;               /**< Node is currently bus-off */
+    uint32_t bus_off_events;    /**< Transitions into bus-off since CAN_Driver_Init() */
+    CAN_BusState_t state;       /**< State as of the last CAN_Driver_Supervise() */
+    uint32_t recoveries;        /**< Completed rejoins after bus-off */
+    uint32_t last_recovery_ms;  /**< Bus-off entry to rejoin of the last recovery */
+} CAN_Driver_BusStatus_t;
+
+/** Mask value that requires every bit of a 29-bit extended ID to match */
+#define CAN_FILTER_MASK_EXACT_EXT   0x1FFFFFFFu
+
+/** Mask value that requires every bit of an 11-bit standard ID to match */
+#define CAN_FILTER_MASK_EXACT_STD   0x7FFu
+
+/**
+ * @brief Hardware acceptance filter entry
+ * 
+ * A frame is accepted when (frame_id & mask) == (id & mask).
+ * Each entry occupies one FDCAN standard or extended filter element.
+ */
+typedef struct {
+    uint32_t id;            /**< Identifier to match */
+    uint32_t mask;          /**< Identifier bits that must match */
+    bool is_extended;       /**< true for 29-bit extended filter element */
+    bool high_priority;     /**< true to route into RX FIFO 1, drained before FIFO 0 */
+} CAN_Filter_t;
+
 /* ============================================================================
  * Public Function Prototypes
  * ============================================================================ */
@@ -44,21 +171,64 @@ typedef struct {
  */
 void CAN_Driver_Init(void);
 
+/**
+ * @brief Program hardware acceptance filters
+ * 
+ * Writes one FDCAN filter element per table entry (routed to RX FIFO 0, or
+ * RX FIFO 1 for high_priority entries) and sets the global filter for non-matching frames.
+ * Must be called after CAN_Driver_Init() and before CAN_Driver_Start().
+ * 
+ * @param filters Filter table
+ * @param count Number of entries in filter table
+ * @param reject_non_matching true to discard frames (and remote frames)
+ *        that match no entry in hardware, false to accept them into RX FIFO 0
+ * 
+ * @return true if all filters were programmed
+ * @return false if table exceeds the filter elements reserved in
+ *         MX_FDCAN1_Init (StdFiltersNbr / ExtFiltersNbr) or HAL failed
+ * 
+ * Example:
+ * @code
+ * static const CAN_Filter_t filters[] = {
+ *     { AUTOMATE_LEFT_BRAKE_CMD_FRAME_ID, CAN_FILTER_MASK_EXACT_EXT, true, true },
+ * };
+ * CAN_Driver_ConfigFilters(filters, 1, true);
+ * @endcode
+ */
+bool CAN_Driver_ConfigFilters(const CAN_Filter_t *filters, uint8_t count, bool reject_non_matching);
+
+/**
+ * @brief Start CAN peripheral
+ * 
+ * Enables RX FIFO 0/1 notifications and starts the FDCAN peripheral.
+ * With CAN_FD_ENABLED also enables transmitter delay compensation for
+ * the fast data phase (MX_FDCAN1_Init must have selected FD format).
+ * Call once after filters are configured.
+ * 
+ * @return true if peripheral started successfully
+ */
+bool CAN_Driver_Start(void);
+
 /**
  * @brief Queue a CAN message for transmission
  * 
- * Adds message to the TX ring buffer. Message will be transmitted
- * when CAN_Driver_Transmit() is called.
+ * Same as CAN_Driver_SendPriority() with CAN_TX_PRIORITY_NORMAL.
+ * Adds message to the TX ring buffer and starts transmission immediately
+ * if the hardware TX FIFO has room. Remaining messages are sent from the
+ * TX-complete interrupt as earlier frames leave the peripheral.
  * 
  * @param id CAN identifier (11 or 29 bits depending on extended flag)
- * @param data Pointer to message data (up to 8 bytes)
- * @param len Data length in bytes (0-8)
+ * @param data Pointer to message data (up to CAN_MAX_DATA_LEN bytes)
+ * @param len Data length in bytes (0-CAN_MAX_DATA_LEN)
  * 
  * @return true if message queued successfully
  * @return false if buffer full or invalid parameters
  * 
+ * @note Payloads above 8 bytes go out as CAN FD frames, padded with zeros
+ *       up to the next DLC step (12, 16, 20, 24, 32, 48, 64)
  * @note Messages are transmitted in FIFO order
  * @note This function is non-blocking
+ * @note Call from main loop context only (single TX producer)
  * 
  * Example:
  * @code
@@ -71,22 +241,103 @@ void CAN_Driver_Init(void);
 bool CAN_Driver_Send(uint32_t id, const uint8_t *data, uint8_t len);
 
 /**
- * @brief Process pending CAN transmissions
+ * @brief Queue a CAN message for transmission in a priority class
  * 
- * Attempts to send all queued messages from TX buffer to the CAN peripheral.
- * Should be called periodically from main loop or timer interrupt.
+ * High-priority frames are handed to the peripheral before any queued
+ * normal frame. Worst-case wait is the frames already loaded into the
+ * 3-element hardware TX FIFO (about 0.8 ms at 500 kbit/s).
  * 
- * @note Non-blocking - returns immediately if peripheral TX FIFO is full
- * @note Messages that cannot be sent are kept in buffer for next attempt
+ * @param id CAN identifier (11 or 29 bits depending on extended flag)
+ * @param data Pointer to message data (up to CAN_MAX_DATA_LEN bytes)
+ * @param len Data length in bytes (0-CAN_MAX_DATA_LEN)
+ * @param priority CAN_TX_PRIORITY_NORMAL or CAN_TX_PRIORITY_HIGH
+ * 
+ * @return true if message queued successfully
+ * @return false if the class queue is full or invalid parameters
+ * 
+ * @note Messages are transmitted in FIFO order within a class
+ * @note Call from main loop context only (single TX producer)
+ */
+bool CAN_Driver_SendPriority(uint32_t id, const uint8_t *data, uint8_t len, CAN_TxPriority_t priority);
+
+/**
+ * @brief Reserve a TX ring slot for in-place message construction
+ * 
+ * Returns the next free slot of the priority class so the caller can pack
+ * payload directly into it. Fill id, len, is_extended and data, then call
+ * CAN_Driver_TxCommit() with the same priority. A reservation that is not
+ * committed is simply reused by the next reserve. The slot comes back as a
+ * classic frame; set is_fd for payloads above 8 bytes.
+ * 
+ * @param priority TX priority class
+ * 
+ * @return Pointer to free slot
+ * @return NULL if the class queue is full (counted in tx_dropped / tx_high_dropped)
+ * 
+ * @note Call from main loop context only (single TX producer)
  * 
  * Example:
  * @code
- * while (1) {
- *     CAN_Driver_Transmit();  // Send pending messages
- *     // Other tasks...
+ * CAN_Message_t *slot = CAN_Driver_TxReserve(CAN_TX_PRIORITY_NORMAL);
+ * if (slot != NULL) {
+ *     int len = automate_left_brake_msg_pack(slot->data, &msg, sizeof(slot->data));
+ *     if (len > 0) {
+ *         slot->id = AUTOMATE_LEFT_BRAKE_MSG_FRAME_ID;
+ *         slot->len = (uint8_t)len;
+ *         slot->is_extended = true;
+ *         CAN_Driver_TxCommit(CAN_TX_PRIORITY_NORMAL);
+ *     }
  * }
  * @endcode
  */
+CAN_Message_t *CAN_Driver_TxReserve(CAN_TxPriority_t priority);
+
+/**
+ * @brief Queue the slot returned by CAN_Driver_TxReserve()
+ * 
+ * Publishes the slot to the TX consumer and starts transmission if the
+ * hardware TX FIFO has room.
+ * 
+ * @param priority TX priority class passed to CAN_Driver_TxReserve()
+ * 
+ * @return true if message queued
+ * @return false if the class queue is full, i.e. the reserve failed and
+ *         nothing was published, if slot length is above 8
+ *         (CAN_MAX_DATA_LEN for FD frames) or if is_fd is set in a classic
+ *         build; the slot stays free in every case
+ */
+bool CAN_Driver_TxCommit(CAN_TxPriority_t priority);
+
+/**
+ * @brief Convert a payload length to the FDCAN DLC code
+ * 
+ * Lengths between DLC steps round up (e.g. 13 -> DLC 10 / 16 bytes).
+ * 
+ * @param len Payload length in bytes (0-64)
+ * @return DLC code 0-15 (15 for anything above 48)
+ */
+uint8_t CAN_Driver_LenToDlc(uint8_t len);
+
+/**
+ * @brief Convert an FDCAN DLC code to the payload length
+ * 
+ * @param dlc DLC code (only the low 4 bits are used)
+ * @return Payload length in bytes (DLC 9-15 map to 12-64)
+ */
+uint8_t CAN_Driver_DlcToLen(uint8_t dlc);
+
+/**
+ * @brief Kick pending CAN transmissions
+ * 
+ * Attempts to move queued messages from TX buffer to the CAN peripheral.
+ * CAN_Driver_Send() and the TX-complete interrupt already do this, so
+ * periodic calls are no longer required; use after bus recovery or to
+ * force a retry.
+ * 
+ * @note Non-blocking - returns immediately if peripheral TX FIFO is full
+ * @note Messages that cannot be sent are kept in buffer for next attempt
+ * @note Call from main loop context only
+ */
 void CAN_Driver_Transmit(void);
 
 /**
@@ -110,17 +361,45 @@ void CAN_Driver_Transmit(void);
  */
 bool CAN_Driver_Get(CAN_Message_t *msg);
 
+/**
+ * @brief Access oldest received message in place
+ * 
+ * Returns a pointer into the RX ring without copying. The slot stays
+ * valid until CAN_Driver_RxRelease() is called.
+ * 
+ * @return Pointer to oldest message
+ * @return NULL if no messages available
+ * 
+ * Example:
+ * @code
+ * const CAN_Message_t *msg;
+ * while ((msg = CAN_Driver_RxPeek()) != NULL) {
+ *     // Unpack directly from msg->data
+ *     CAN_Driver_RxRelease();
+ * }
+ * @endcode
+ */
+const CAN_Message_t *CAN_Driver_RxPeek(void);
+
+/**
+ * @brief Release the message returned by CAN_Driver_RxPeek()
+ * 
+ * Hands the RX slot back to the interrupt producer.
+ * Does nothing if RX buffer is empty.
+ */
+void CAN_Driver_RxRelease(void);
+
 /**
  * @brief Get number of received messages waiting in buffer
  * 
- * @return Number of unread messages (0-8)
+ * @return Number of unread messages (0-CAN_RX_BUFFER_SIZE)
  */
 uint8_t CAN_Driver_GetRxCount(void);
 
 /**
  * @brief Get number of messages pending transmission
  * 
- * @return Number of messages in TX buffer (0-8)
+ * @return Number of messages in both TX priority buffers
  */
 uint8_t CAN_Driver_GetTxCount(void);
 
@@ -137,7 +416,7 @@ bool CAN_Driver_HasMessage(void);
 /**
  * @brief Clear all pending transmissions
  * 
- * Discards all messages waiting in TX buffer.
+ * Discards all messages waiting in both TX priority buffers.
  * Useful for emergency stop or system reset.
  * 
  * @warning Messages already submitted to hardware FIFO will still be sent
@@ -151,10 +430,92 @@ void CAN_Driver_ClearTxBuffer(void);
  */
 void CAN_Driver_ClearRxBuffer(void);
 
+/**
+ * @brief Get CAN driver queue statistics
+ * 
+ * Reports frame counters, drop counters and queue high-watermarks.
+ * 
+ * @param stats Pointer to structure to fill (ignored if NULL)
+ * 
+ * Example:
+ * @code
+ * CAN_Driver_Stats_t stats;
+ * CAN_Driver_GetStats(&stats);
+ * if (stats.rx_dropped > 0) {
+ *     // RX queue too shallow for observed bursts
+ * }
+ * @endcode
+ */
+void CAN_Driver_GetStats(CAN_Driver_Stats_t *stats);
+
+/**
+ * @brief Get FDCAN error counters and bus-off state
+ * 
+ * @param status Pointer to structure to fill
+ * @return false if status is NULL or the registers could not be read
+ */
+bool CAN_Driver_GetBusStatus(CAN_Driver_BusStatus_t *status);
+
+/**
+ * @brief Track the bus state and rejoin after bus-off
+ * 
+ * Call periodically from the main loop (the controller runs it as a
+ * scheduler task every few milliseconds). Reads the FDCAN protocol status
+ * and error counters and updates the bus state. After bus-off the
+ * peripheral is restarted on the next call, or after a hold-off that
+ * doubles with every bus-off following a short stable period; the
+ * hardware then rejoins after 128 x 11 recessive bits (2.8 ms at
+ * 500 kbit/s). Queued TX frames are kept or flushed per
+ * CAN_Driver_SetRecoveryPolicy().
+ * 
+ * @note Not for interrupt context (restart goes through HAL_FDCAN_Stop/Start)
+ */
+void CAN_Driver_Supervise(void);
+
+/**
+ * @brief Get the bus state of the last CAN_Driver_Supervise() call
+ */
+CAN_BusState_t CAN_Driver_GetBusState(void);
+
+/**
+ * @brief Choose what happens to queued TX frames on rejoin after bus-off
+ * 
+ * @param policy Recovery policy (default CAN_RECOVERY_FLUSH_NORMAL)
+ */
+void CAN_Driver_SetRecoveryPolicy(CAN_RecoveryPolicy_t policy);
+
+/**
+ * @brief HAL FDCAN TX buffer complete callback
+ * 
+ * Called by HAL from FDCAN1_IT1 when a frame has been transmitted, or
+ * from FDCAN1_IT0 if its handler runs while the flag is pending.
+ * Refills the hardware TX FIFO from the TX ring buffer.
+ * 
+ * @param hfdcan Pointer to FDCAN handle
+ * @param BufferIndexes Completed TX buffer indexes
+ * 
+ * @note Do not call this function directly
+ */
+void HAL_FDCAN_TxBufferCompleteCallback(FDCAN_HandleTypeDef *hfdcan, uint32_t BufferIndexes);
+
+/**
+ * @brief HAL FDCAN RX FIFO 1 callback
+ * 
+ * Called by HAL when a priority message arrives in RX FIFO 1.
+ * Drains both FIFOs, like HAL_FDCAN_RxFifo0Callback().
+ * 
+ * @param hfdcan Pointer to FDCAN handle
+ * @param RxFifo1ITs Interrupt flags indicating event type
+ * 
+ * @note Do not call this function directly
+ */
+void HAL_FDCAN_RxFifo1Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo1ITs);
+
 /**
  * @brief HAL FDCAN RX FIFO 0 callback
  * 
  * This function is called by HAL when a new message arrives.
+ * All pending elements of RX FIFO 1 and RX FIFO 0 are drained per call.
  * It should be registered with the HAL FDCAN driver.
  * 
  * @param hfdcan Pointer to FDCAN handle
@@ -165,6 +526,19 @@ void CAN_Driver_ClearRxBuffer(void);
  */
 void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo0ITs);
 
+/**
+ * @brief HAL FDCAN error status callback
+ * 
+ * Called by HAL from FDCAN1_IT0 on bus-off. Counts bus-off events and
+ * flags the restart for CAN_Driver_Supervise().
+ * 
+ * @param hfdcan Pointer to FDCAN handle
+ * @param ErrorStatusITs Error status interrupt flags
+ * 
+ * @note Do not call this function directly
+ */
+void HAL_FDCAN_ErrorStatusCallback(FDCAN_HandleTypeDef *hfdcan, uint32_t ErrorStatusITs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,120 @@
+/**
+ * @file control_loop.h
+ * @brief Fixed-rate real-time control loop on the TIM1 update interrupt
+ * 
+ * TIM1 generates the motor PWM and, through its repetition counter, a
+ * 1 kHz update interrupt. Position sampling and the brake state machine
+ * run inside that interrupt at a guaranteed period; the main loop only
+ * handles background work (CAN, business logic) and sleeps with WFI.
+ */
+
+#ifndef CONTROL_LOOP_H
+#define CONTROL_LOOP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+/* TIM1: 170 MHz / (8499 + 1) = 20 kHz PWM. Update event fires every
+ * RepetitionCounter + 1 PWM periods - keep in sync with MX_TIM1_Init(). */
+#define PWM_FREQUENCY_HZ            20000u
+#define PWM_CYCLES_PER_CONTROL_TICK 20u     /* -> 1 kHz control tick */
+#define CONTROL_TICK_HZ             (PWM_FREQUENCY_HZ / PWM_CYCLES_PER_CONTROL_TICK)
+
+/* ============================================================================
+ * Type Definitions
+ * ============================================================================ */
+
+/**
+ * @brief Tasks executed from the control interrupt, in execution order
+ */
+typedef enum {
+    CONTROL_TASK_POSITION = 0,      /**< Brake_UpdatePosition() */
+    CONTROL_TASK_STATE_MACHINE,     /**< Brake_Update() */
+    CONTROL_TASK_TRACE,             /**< Trace_Sample() */
+    CONTROL_TASK_COUNT
+} ControlLoop_Task_t;
+
+/**
+ * @brief Measured timing of one control task
+ * 
+ * Times are in CPU cycles (170 MHz). Period is measured between start of
+ * consecutive runs; jitter is the largest deviation from the nominal
+ * period (SystemCoreClock / CONTROL_TICK_HZ).
+ */
+typedef struct {
+    uint32_t runs;              /**< Number of completed runs */
+    uint32_t last_period;       /**< Most recent start-to-start period */
+    uint32_t min_period;        /**< Shortest period seen */
+    uint32_t max_period;        /**< Longest period seen */
+    uint32_t max_jitter;        /**< Largest |period - nominal| */
+    uint32_t max_exec;          /**< Longest execution time */
+} ControlLoop_TaskStats_t;
+
+/* ============================================================================
+ * Public Function Prototypes
+ * ============================================================================ */
+
+/**
+ * @brief Start running control tasks from the TIM1 update interrupt
+ * 
+ * Call after Brake_Init() once all modules are initialized. Enables the
+ * DWT cycle counter used for timing and clears task statistics.
+ */
+void ControlLoop_Start(void);
+
+/**
+ * @brief Number of control ticks since TIM1 start
+ * 
+ * @return Tick count (CONTROL_TICK_HZ)
+ */
+uint32_t GetControlTick(void);
+
+/**
+ * @brief Number of completed PWM cycles since TIM1 start
+ * 
+ * Resolution is one control tick (PWM_CYCLES_PER_CONTROL_TICK cycles).
+ * 
+ * @return PWM cycle count
+ */
+uint32_t GetPwmCycle(void);
+
+/**
+ * @brief Mask the control interrupt
+ * 
+ * Use around main-context code that modifies state owned by control tasks.
+ * Not nestable; keep the section short.
+ */
+void ControlLoop_Lock(void);
+
+/**
+ * @brief Unmask the control interrupt
+ */
+void ControlLoop_Unlock(void);
+
+/**
+ * @brief Get timing statistics of a control task
+ * 
+ * @param task Task identifier
+ * @param stats Output statistics
+ * @return false if task is invalid
+ */
+bool ControlLoop_GetTaskStats(ControlLoop_Task_t task, ControlLoop_TaskStats_t *stats);
+
+/**
+ * @brief Clear timing statistics of all control tasks
+ */
+void ControlLoop_ResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROL_LOOP_H */
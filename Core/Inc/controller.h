@@ -9,26 +9,40 @@
  * 
  * MCU → PC (Transmitted by this controller):
  * - Heart_Beat_MSG (CAN ID: 0x98FF0D00, Node_id: 0xF0)
- *   * Period: 50ms
+ *   * Period: 50ms (default, see MCU_Config_CMD)
  *   * Purpose: Signal MCU availability and health status
  * 
- * - Left_Brake_MSG (CAN ID: 0x98FF0D0A)
- *   * Period: 100ms
- *   * Purpose: Report actual brake actuator state
+ * - Left_Brake_MSG (CAN ID: 0x98FF0D0A), Right_Brake_MSG (CAN ID: 0x98FF0D0C)
+ *   * Period: 100ms keep-alive (default), plus immediately on every state change
+ *     (at most one extra frame per CONTROLLER_TELEMETRY_MIN_GAP_MS)
+ *   * Purpose: Report actual brake actuator state, one frame per instance
+ * 
+ * - MCU_Diag_MSG (CAN ID: 0x98FF0D0E, optional)
+ *   * Period: CONTROLLER_DIAG_INTERVAL_MS (500ms, 0 = not sent)
+ *   * Purpose: CAN driver counters, bus error state, overruns, CPU load
  * 
  * PC → MCU (Received and processed):
  * - Heart_Beat_MSG (CAN ID: 0x98FF0D00, Node_id: 0x10)
  *   * Expected period: 50ms
  *   * Purpose: Monitor PC availability
- *   * Timeout: 200ms (4 missed messages)
+ *   * Timeout: 200ms (4 missed messages, default)
  * 
- * - Left_Brake_CMD (CAN ID: 0x98FF0D09)
- *   * Purpose: Receive brake control commands
+ * - Left_Brake_CMD (CAN ID: 0x98FF0D09), Right_Brake_CMD (CAN ID: 0x98FF0D0B)
+ *   * Purpose: Receive brake control commands for that instance
  *   * Brake_State: 0 = release, 1 = push
  * 
+ * - MCU_Config_CMD (CAN ID: 0x98FF0D0F)
+ *   * Purpose: Set Node_id, heartbeat/telemetry cycle times and the PC
+ *     watchdog timeout of the node whose Node_id is Target_Node_id;
+ *     applied at once and kept in flash (see Controller_SetConfig())
+ * 
+ * - Trace_CMD (CAN ID: 0x1800ADF1, outside the DBC)
+ *   * Purpose: Arm / stream the 1 kHz position trace (see trace.h)
+ * 
  * Node Identification:
  * ===================
- * - MCU Node_id: 0xF0 (fixed, used in outgoing Heart_Beat_MSG)
+ * - MCU Node_id: 0xF0 by default, used in outgoing Heart_Beat_MSG;
+ *   MCU_Config_CMD changes it so several nodes can share one bus
  * - PC Node_id: 0x10 (expected in incoming Heart_Beat_MSG)
  */
 
@@ -41,6 +55,71 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+/** Maximum number of RX frame handlers (one hardware filter element each) */
+#ifndef CONTROLLER_MAX_HANDLERS
+#define CONTROLLER_MAX_HANDLERS     8u
+#endif
+
+/** Minimum gap between an on-change Left_Brake_MSG and the previous one, ms */
+#ifndef CONTROLLER_TELEMETRY_MIN_GAP_MS
+#define CONTROLLER_TELEMETRY_MIN_GAP_MS 10u
+#endif
+
+/** MCU_Diag_MSG period in ms, 0 disables the diagnostics frame */
+#ifndef CONTROLLER_DIAG_INTERVAL_MS
+#define CONTROLLER_DIAG_INTERVAL_MS 500u
+#endif
+
+/** Shortest heartbeat/telemetry cycle and watchdog timeout accepted at runtime, ms */
+#ifndef CONTROLLER_CYCLE_MIN_MS
+#define CONTROLLER_CYCLE_MIN_MS     10u
+#endif
+
+/** Longest heartbeat/telemetry cycle and watchdog timeout accepted at runtime, ms */
+#ifndef CONTROLLER_CYCLE_MAX_MS
+#define CONTROLLER_CYCLE_MAX_MS     10000u
+#endif
+
+/** Maximum size of an unpacked message struct passed to a handler */
+#define CONTROLLER_MSG_MAX_SIZE     16u
+
+/* ============================================================================
+ * Type Definitions
+ * ============================================================================ */
+
+/**
+ * @brief Decode frame payload into a message struct
+ * 
+ * Same contract as automate_*_unpack(): dst points to a buffer of
+ * CONTROLLER_MSG_MAX_SIZE bytes, return zero(0) or negative error code.
+ */
+typedef int (*Controller_UnpackFn_t)(void *dst, const uint8_t *src, size_t size);
+
+/**
+ * @brief Handle an unpacked message
+ * 
+ * @param msg Message struct produced by the matching Controller_UnpackFn_t
+ */
+typedef void (*Controller_HandlerFn_t)(const void *msg);
+
+/**
+ * @brief Runtime configuration (STORAGE_KEY_CONFIG)
+ * 
+ * Defaults are the DBC cycle times, a 200 ms watchdog and Node_id 0xF0.
+ */
+typedef struct {
+    uint16_t heartbeat_interval_ms;     /**< Heart_Beat_MSG period */
+    uint16_t telemetry_interval_ms;     /**< Left/Right_Brake_MSG keep-alive period */
+    uint16_t watchdog_timeout_ms;       /**< PC heartbeat timeout before WARNING */
+    uint8_t node_id;                    /**< Node_id sent in Heart_Beat_MSG */
+    uint8_t reserved;                   /**< Zero */
+} Controller_Config_t;
 
 /* ============================================================================
  * Public Function Prototypes
@@ -50,10 +129,36 @@ extern "C" {
  * @brief Initialize controller subsystem
  * 
  * Must be called once during system initialization before calling BusinessLoop().
- * Initializes all controller state variables and timing.
+ * Initializes all controller state variables and timing, and programs the
+ * CAN hardware acceptance filters for the frames it handles.
+ * 
+ * @note Call after CAN_Driver_Init() and before CAN_Driver_Start()
  */
 void Controller_Init(void);
 
+/**
+ * @brief Register handler for a received frame
+ * 
+ * Each handler owns one CAN hardware filter element. The filter match index
+ * reported with every received frame selects the handler directly, so
+ * dispatch cost does not grow with the number of protocol messages.
+ * 
+ * @param frame_id CAN identifier to accept
+ * @param is_extended true for 29-bit extended identifier
+ * @param unpack_fn Payload decoder (e.g. wrapper around automate_*_unpack)
+ * @param handler_fn Called with the unpacked message
+ * @param high_priority true to route frame into priority RX FIFO 1
+ * 
+ * @return true if registered
+ * @return false if table or filter elements are exhausted, arguments are
+ *         NULL, or CAN_Driver_Start() was already called
+ * 
+ * @note Call after Controller_Init() and before CAN_Driver_Start()
+ */
+bool Controller_RegisterHandler(uint32_t frame_id, bool is_extended,
+                                Controller_UnpackFn_t unpack_fn, Controller_HandlerFn_t handler_fn,
+                                bool high_priority);
+
 /**
  * @brief Main business logic loop
  * 
@@ -65,6 +170,9 @@ void Controller_Init(void);
  * - System health monitoring
  * - Status LED control
  * 
+ * Tasks run from a static table with fixed period/offset/deadline
+ * (see scheduler.h), query timing with Scheduler_GetTaskStats().
+ * 
  * @note This is a non-blocking function that returns immediately
  */
 void Business_Loop(void);
@@ -72,11 +180,13 @@ void Business_Loop(void);
 /**
  * @brief Set node identifier
  * 
- * Changes the node ID used in heartbeat messages.
+ * Changes the node ID used in heartbeat messages through
+ * Controller_SetConfig(), so it is checked and kept in flash the same way.
  * 
- * @param id Node identifier (0-255)
+ * @param id Node identifier, other than the PC's (0x10)
+ * @return false if id is rejected (nothing changes)
  */
-void Controller_SetNodeID(uint8_t id);
+bool Controller_SetNodeID(uint8_t id);
 
 /**
  * @brief Get current node identifier
@@ -113,17 +223,39 @@ uint8_t Controller_GetHealth(void);
  * 
  * Bypasses the periodic timer and sends a heartbeat immediately.
  * Useful for testing or critical status updates.
+ * The periodic schedule keeps its phase.
  */
 void Controller_SendHeartbeatNow(void);
 
 /**
  * @brief Force immediate telemetry transmission
  * 
- * Bypasses the periodic timer and sends telemetry immediately.
+ * Bypasses the periodic timer and sends telemetry of every brake immediately.
  * Useful for testing or on-demand status reporting.
+ * The periodic schedule keeps its phase.
  */
 void Controller_SendTelemetryNow(void);
 
+/**
+ * @brief Apply a new runtime configuration and keep it in flash
+ * 
+ * Cycle times take effect from the next release of each task, the node
+ * ID and watchdog timeout at once. The flash record is written by a
+ * background task while no brake is moving, so it may follow later.
+ * 
+ * @param config Cycles and timeout in CONTROLLER_CYCLE_MIN_MS..
+ *               CONTROLLER_CYCLE_MAX_MS, node ID other than the PC's (0x10)
+ * @return false if config is NULL or out of range (nothing changes)
+ */
+bool Controller_SetConfig(const Controller_Config_t *config);
+
+/**
+ * @brief Get the runtime configuration in force
+ * 
+ * @param config Output configuration
+ */
+void Controller_GetConfig(Controller_Config_t *config);
+
 #ifdef __cplusplus
 }
 #endif
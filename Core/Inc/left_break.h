@@ -1,8 +1,10 @@
 /**
  * @file left_brake.h
- * @brief Left brake actuator control interface
+ * @brief Brake actuator control interface
  * 
- * Provides high-level control for brake actuator with position feedback
+ * Provides high-level control for BRAKE_COUNT brake actuators with position
+ * feedback. Each actuator is a Brake_t instance with its own TIM1 PWM
+ * channel, direction pin, ADC1 scan rank and CAN frame IDs.
  */
 
 #ifndef LEFT_BRAKE_H
@@ -14,44 +16,181 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "stm32g4xx_hal.h"
+#include "common.h"
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+/** Number of brake actuators driven by this image (1 or 2) */
+#ifndef BRAKE_COUNT
+#define BRAKE_COUNT                 2u
+#endif
+
+/** Instance indices for Brake_Get() */
+#define BRAKE_LEFT                  0u
+#define BRAKE_RIGHT                 1u
+
+/* ============================================================================
+ * Public Types
+ * ============================================================================ */
+
+/**
+ * @brief Brake actuator instance (opaque, see Brake_Get())
+ */
+typedef struct Brake_s Brake_t;
+
+/**
+ * @brief Hardware and protocol mapping of one actuator
+ */
+typedef struct {
+    const char *name;           /**< Instance name for diagnostics */
+    uint32_t pwm_channel;       /**< TIM1 channel driving the BTN7971B IN pin */
+    GPIO_TypeDef *inh_port;     /**< Direction (INH) pin port */
+    uint16_t inh_pin;           /**< Direction (INH) pin */
+    uint8_t adc_rank;           /**< Position in the ADC1 regular sequence (0-based) */
+    uint32_t cmd_frame_id;      /**< Brake command frame (Left_Brake_CMD layout) */
+    uint32_t msg_frame_id;      /**< Brake telemetry frame (Left_Brake_MSG layout) */
+} Brake_Config_t;
+
+/**
+ * @brief Motor control mode used for push/release operations
+ */
+typedef enum {
+    BRAKE_CONTROL_FIXED_DUTY = 0,   /**< Constant duty until position threshold */
+    BRAKE_CONTROL_PROFILED          /**< Trapezoidal trajectory tracked by PID */
+} Brake_ControlMode_t;
+
+/**
+ * @brief Profiled position controller tuning
+ * 
+ * All values are fixed point. Position unit is one 12-bit ADC count, time
+ * unit is one control tick (1 ms, CONTROL_TICK_HZ). Controller output is
+ * motor duty in percent, Q8 (25600 = 100%).
+ */
+typedef struct {
+    int32_t kp;                 /**< Q8: duty % per count of error */
+    int32_t ki;                 /**< Q8: duty % per count of error per tick */
+    int32_t kd;                 /**< Q8: duty % per count/tick of error change */
+    int32_t kff;                /**< Q8: duty % per count/tick of reference velocity */
+    int32_t max_velocity;       /**< Q16: cruise velocity, counts/tick */
+    int32_t acceleration;       /**< Q16: counts/tick^2, also used to decelerate */
+} Brake_ControlParams_t;
+
+/**
+ * @brief Learned stroke-time model
+ * 
+ * Mean stroke velocity per direction in Q16 counts per millisecond,
+ * an exponential average over completed strokes. Time_to_end_operation is
+ * the remaining distance divided by the velocity of the current direction.
+ */
+typedef struct {
+    uint32_t push_velocity;     /**< Q16: counts/ms while pushing */
+    uint32_t release_velocity;  /**< Q16: counts/ms while releasing */
+} Brake_StrokeModel_t;
+
+/**
+ * @brief Position of the mechanical end stops
+ * 
+ * A stroke ends POSITION_TOLERANCE counts before the end stop it is
+ * heading for; profiled mode drives to the end stop itself.
+ */
+typedef struct {
+    uint16_t released;          /**< ADC counts at full release */
+    uint16_t pushed;            /**< ADC counts at full push */
+} Brake_EndStops_t;
+
+/**
+ * @brief Timing of the last command that started an operation
+ * 
+ * Measured from the FDCAN RX timestamp of the command frame (start of
+ * frame on the bus) with the DWT cycle counter.
+ */
+typedef struct {
+    uint8_t msg_id;             /**< Left_Brake_CMD MSG_Id */
+    bool valid;                 /**< A timed command has been received */
+    bool actuated;              /**< Motor has been driven for this command */
+    bool completed;             /**< Target position reached */
+    uint32_t actuation_us;      /**< Frame start -> first motor drive */
+    uint32_t completion_ms;     /**< Frame start -> target reached */
+} Brake_CommandTiming_t;
 
 /* ============================================================================
  * Public Function Prototypes
  * ============================================================================ */
 
 /**
- * @brief Initialize brake system
+ * @brief Initialize all brake instances
  * 
  * Must be called once during system initialization after peripherals are configured.
- * - Calibrates ADC
- * - Reads initial position
- * - Determines initial state
- * - Ensures motor is stopped
+ * - Ensures every motor is stopped, then starts its TIM1 PWM channel
+ * - Restores ADC calibration, end stops and stroke models from storage,
+ *   or calibrates the ADC and keeps the defaults if no valid record exists
+ * - Starts the PWM-triggered DMA scan of all channels
+ * - Reads initial positions
+ * - Determines initial states
  * 
  * Call sequence:
  * 1. HAL_Init()
- * 2. MX_GPIO_Init(), MX_ADC_Init(), MX_TIM_Init()
- * 3. Brake_Init() ← Call this
+ * 2. MX_GPIO_Init(), MX_ADC_Init(), MX_TIM_Init(), TIM1 started (ADC trigger)
+ * 3. Storage_Init()
+ * 4. Brake_Init() ← Call this
  */
 void Brake_Init(void);
 
 /**
- * @brief Update current position reading from ADC
+ * @brief Check whether Brake_Init() restored a stored calibration
+ * 
+ * @return true if the ADC was not recalibrated at boot
+ */
+bool Brake_IsCalibrationRestored(void);
+
+/**
+ * @brief Store calibration of all instances if it changed
  * 
- * Reads potentiometer value and validates it. Should be called periodically
- * (recommended: every 10ms) from main loop or timer interrupt.
+ * Writes ADC calibration, end stops and stroke models under
+ * STORAGE_KEY_CALIBRATION when they differ from the stored copy; stroke
+ * velocities only count as changed once they drift by more than 1/16.
+ * Skipped while any instance is moving, the flash write stalls the
+ * control interrupt.
+ * 
+ * @return true if the stored copy is up to date
+ * 
+ * @note Call from main loop context only
+ */
+bool Brake_SaveCalibration(void);
+
+/**
+ * @brief Get brake instance
+ * 
+ * @param index BRAKE_LEFT, BRAKE_RIGHT, ... (< BRAKE_COUNT)
+ * @return Instance, or NULL if index is out of range
+ */
+Brake_t *Brake_Get(uint8_t index);
+
+/**
+ * @brief Get hardware and protocol mapping of an instance
+ * 
+ * @param brake Instance from Brake_Get()
+ * @return Constant configuration
+ */
+const Brake_Config_t *Brake_GetConfig(const Brake_t *brake);
+
+/**
+ * @brief Update current position readings of all instances from ADC
+ * 
+ * Reads potentiometer values and validates them once per control tick.
+ * Samples are captured by DMA in the background, so this never blocks.
  * 
  * Handles:
- * - ADC reading
+ * - ADC reading (one pass over new DMA scans, streaming filter per channel)
  * - Position validation
  * - Error detection and counting
  * - Automatic error state entry on repeated failures
  * 
- * Example:
- * @code
- * // In main loop or 10ms timer
- * Brake_UpdatePosition();
- * @endcode
+ * @note Called from the TIM1 update interrupt by control_loop.c as
+ *       CONTROL_TASK_POSITION, once per control tick (1 kHz).
  */
 void Brake_UpdatePosition(void);
 
@@ -61,31 +200,56 @@ void Brake_UpdatePosition(void);
  * Initiates push or release operation based on command.
  * Ignores duplicate commands (already pushing/releasing).
  * 
+ * @param brake Instance from Brake_Get()
  * @param brake_state Command state:
  *        - AUTOMATE_LEFT_BRAKE_CMD_BRAKE_STATE_PUSH_CHOICE (0)
  *        - AUTOMATE_LEFT_BRAKE_CMD_BRAKE_STATE_RELEASE_CHOICE (1)
  * 
- * @note Command is ignored if system is in error state
+ * @note Command is ignored if the instance is in error state
  * 
  * Example:
  * @code
  * struct automate_left_brake_cmd_t cmd;
  * if (automate_left_brake_cmd_unpack(&cmd, can_data, 8) == 0) {
- *     Brake_ProcessCommand(cmd.brake_state);
+ *     Brake_ProcessCommand(Brake_Get(BRAKE_LEFT), cmd.brake_state);
  * }
  * @endcode
  */
-void Brake_ProcessCommand(uint8_t brake_state);
+void Brake_ProcessCommand(Brake_t *brake, uint8_t brake_state);
 
 /**
- * @brief Update brake state machine
+ * @brief Process brake command and track its latency
+ * 
+ * Same as Brake_ProcessCommand(). A command that starts a push/release
+ * operation becomes the tracked command: the control loop records when it
+ * first drives the motor and when the target is reached, see
+ * Brake_GetCommandTiming(). Duplicates keep the running measurement.
  * 
- * Executes current state logic and performs transitions.
- * Call this periodically (recommended: every 10-50ms) from main loop.
+ * @param brake Instance from Brake_Get()
+ * @param brake_state Command state (PUSH or RELEASE)
+ * @param msg_id Brake command MSG_Id, echoed in telemetry
+ * @param rx_cycles GetCycles() time of frame reception (CAN_Message_t.rx_cycles)
+ */
+void Brake_ProcessCommandTimed(Brake_t *brake, uint8_t brake_state, uint8_t msg_id, uint32_t rx_cycles);
+
+/**
+ * @brief Get timing of the last command that started an operation
+ * 
+ * @param brake Instance from Brake_Get()
+ * @param timing Output (snapshot)
+ */
+void Brake_GetCommandTiming(const Brake_t *brake, Brake_CommandTiming_t *timing);
+
+/**
+ * @brief Update state machines of all instances
+ * 
+ * Executes current state logic and performs transitions once per control
+ * tick (1 ms). In BRAKE_CONTROL_PROFILED mode the controller steps once
+ * per elapsed tick.
  * 
  * Handles:
  * - State transitions based on position
- * - Motor control (PWM and direction)
+ * - Motor control (PWM and direction, fixed duty or profiled PID)
  * - Operation timeout detection
  * - Automatic motor stop on completion
  * 
@@ -96,37 +260,136 @@ void Brake_ProcessCommand(uint8_t brake_state);
  *     ↓
  * RELEASED
  * 
- * Example:
- * @code
- * while (1) {
- *     Brake_UpdatePosition();  // Update position first
- *     Brake_Update();          // Then update state machine
- *     HAL_Delay(10);
- * }
- * @endcode
+ * @note Called from the TIM1 control interrupt by control_loop.c, right
+ *       after Brake_UpdatePosition(). Main-context API calls mask that
+ *       interrupt while they modify brake state.
  */
 void Brake_Update(void);
 
+/**
+ * @brief Get brake state
+ * 
+ * @param brake Instance from Brake_Get()
+ * @return Current state (written by the control interrupt)
+ */
+BrakeState_t Brake_GetState(const Brake_t *brake);
+
+/**
+ * @brief Select motor control mode
+ * 
+ * @param brake Instance from Brake_Get()
+ * @param mode BRAKE_CONTROL_FIXED_DUTY or BRAKE_CONTROL_PROFILED
+ * @return false if an operation is in progress (mode unchanged)
+ */
+bool Brake_SetControlMode(Brake_t *brake, Brake_ControlMode_t mode);
+
+/**
+ * @brief Get active motor control mode
+ * 
+ * @param brake Instance from Brake_Get()
+ * @return Current control mode
+ */
+Brake_ControlMode_t Brake_GetControlMode(const Brake_t *brake);
+
+/**
+ * @brief Set profiled controller gains and trajectory limits
+ * 
+ * Applied from the next control tick.
+ * 
+ * @param brake Instance from Brake_Get()
+ * @param params New tuning (velocity and acceleration must be > 0)
+ * @return false if parameters are invalid (tuning unchanged)
+ */
+bool Brake_SetControlParams(Brake_t *brake, const Brake_ControlParams_t *params);
+
+/**
+ * @brief Get profiled controller gains and trajectory limits
+ * 
+ * @param brake Instance from Brake_Get()
+ * @param params Output tuning
+ */
+void Brake_GetControlParams(const Brake_t *brake, Brake_ControlParams_t *params);
+
 /**
  * @brief Get estimated time remaining for current operation
  * 
- * Provides dynamic estimate based on current progress.
+ * Remaining distance over the learned velocity of the current direction,
+ * updated every control tick from the actual start position.
  * Returns 0 if not currently in motion.
  * 
- * @return Time remaining in milliseconds (0-5000)
+ * @param brake Instance from Brake_Get()
+ * @return Time remaining in milliseconds (saturates at 65535)
+ */
+uint16_t Brake_GetTimeToEnd(const Brake_t *brake);
+
+/**
+ * @brief Load learned stroke velocities (e.g. restored from storage)
  * 
- * @note Estimate becomes more accurate as operation progresses
+ * @param brake Instance from Brake_Get()
+ * @param model Velocities, each 1/16 to 64 counts/ms (Q16)
+ * @return false if model is NULL or out of range (model unchanged)
  */
-uint16_t Brake_GetTimeToEnd(void);
+bool Brake_SetStrokeModel(Brake_t *brake, const Brake_StrokeModel_t *model);
+
+/**
+ * @brief Get learned stroke velocities
+ * 
+ * Defaults correspond to ESTIMATED_PUSH_TIME_MS / ESTIMATED_RELEASE_TIME_MS
+ * for a full stroke until the first stroke completes.
+ * 
+ * @param brake Instance from Brake_Get()
+ * @param model Output velocities
+ */
+void Brake_GetStrokeModel(const Brake_t *brake, Brake_StrokeModel_t *model);
+
+/**
+ * @brief Set end stop positions (e.g. measured on the installed actuator)
+ * 
+ * Only accepted while the instance is not moving.
+ * 
+ * @param brake Instance from Brake_Get()
+ * @param end_stops Positions within the valid ADC range, pushed at least
+ *        4 * POSITION_TOLERANCE above released
+ * @return false if end_stops is NULL or invalid, or the instance is moving
+ */
+bool Brake_SetEndStops(Brake_t *brake, const Brake_EndStops_t *end_stops);
+
+/**
+ * @brief Get end stop positions
+ * 
+ * @param brake Instance from Brake_Get()
+ * @param end_stops Output positions, 200 / 3800 unless set or restored
+ */
+void Brake_GetEndStops(const Brake_t *brake, Brake_EndStops_t *end_stops);
 
 /**
  * @brief Get current position from ADC
  * 
+ * @param brake Instance from Brake_Get()
  * @return ADC value (typically 0-4095 for 12-bit ADC)
  *         - ~200: Fully released
  *         - ~3800: Fully pushed
  */
-uint16_t Brake_GetPosition(void);
+uint16_t Brake_GetPosition(const Brake_t *brake);
+
+/**
+ * @brief Get filtered position at oversampled resolution
+ * 
+ * @param brake Instance from Brake_Get()
+ * @return 14-bit ADC value (0-16383), 4x Brake_GetPosition() scale
+ */
+uint16_t Brake_GetPositionHighRes(const Brake_t *brake);
+
+/**
+ * @brief Get PWM cycle tag of the current filtered position
+ * 
+ * ADC conversions are triggered by TIM1 at a fixed point of the PWM period,
+ * so every sample maps to a PWM cycle count (see GetPwmCycle()).
+ * 
+ * @param brake Instance from Brake_Get()
+ * @return PWM cycle count since TIM1 start
+ */
+uint32_t Brake_GetPositionCycle(const Brake_t *brake);
 
 /**
  * @brief Get position as percentage
@@ -135,15 +398,16 @@ uint16_t Brake_GetPosition(void);
  * - 0% = Fully released
  * - 100% = Fully pushed
  * 
+ * @param brake Instance from Brake_Get()
  * @return Position percentage (0-100)
  * 
  * Example:
  * @code
- * uint8_t percent = Brake_GetPositionPercent();
+ * uint8_t percent = Brake_GetPositionPercent(Brake_Get(BRAKE_LEFT));
  * printf("Brake position: %d%%\n", percent);
  * @endcode
  */
-uint8_t Brake_GetPositionPercent(void);
+uint8_t Brake_GetPositionPercent(const Brake_t *brake);
 
 /**
  * @brief Emergency stop motor immediately
@@ -151,16 +415,20 @@ uint8_t Brake_GetPositionPercent(void);
  * Halts motor and enters STOPPED state regardless of current position.
  * Use in emergency situations or system shutdown.
  * 
+ * @param brake Instance from Brake_Get()
+ * 
  * @warning Motor stops immediately without controlled deceleration
  * 
  * Example:
  * @code
  * if (emergency_button_pressed) {
- *     Brake_EmergencyStop();
+ *     for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+ *         Brake_EmergencyStop(Brake_Get(i));
+ *     }
  * }
  * @endcode
  */
-void Brake_EmergencyStop(void);
+void Brake_EmergencyStop(Brake_t *brake);
 
 /**
  * @brief Clear error state and attempt recovery
@@ -168,13 +436,14 @@ void Brake_EmergencyStop(void);
  * Resets error counters and attempts to determine valid state
  * based on current position.
  * 
+ * @param brake Instance from Brake_Get()
  * @return true if recovery successful (valid position found)
  * @return false if still in error (invalid position)
  * 
  * Example:
  * @code
- * if (Brake_HasError()) {
- *     if (Brake_ClearError()) {
+ * if (Brake_HasError(brake)) {
+ *     if (Brake_ClearError(brake)) {
  *         // Recovery successful
  *     } else {
  *         // Still in error - may need hardware check
@@ -182,19 +451,20 @@ void Brake_EmergencyStop(void);
  * }
  * @endcode
  */
-bool Brake_ClearError(void);
+bool Brake_ClearError(Brake_t *brake);
 
 /**
- * @brief Check if brake system has detected an error
+ * @brief Check if brake instance has detected an error
  * 
  * Returns true if:
  * - Too many consecutive invalid position readings
  * - Operation timeout occurred
  * - System is in STOPPED state due to error
  * 
+ * @param brake Instance from Brake_Get()
  * @return true if error detected, false if operating normally
  */
-bool Brake_HasError(void);
+bool Brake_HasError(const Brake_t *brake);
 
 #ifdef __cplusplus
 }
@@ -63,8 +63,12 @@ void Error_Handler(void);
 #define MOTOR_PWM_GPIO_Port GPIOA
 #define MOTOR_INH_Pin GPIO_PIN_9
 #define MOTOR_INH_GPIO_Port GPIOA
+#define RIGHT_MOTOR_PWM_Pin GPIO_PIN_10
+#define RIGHT_MOTOR_PWM_GPIO_Port GPIOA
 #define STATUS_LED_Pin GPIO_PIN_3
 #define STATUS_LED_GPIO_Port GPIOB
+#define RIGHT_MOTOR_INH_Pin GPIO_PIN_4
+#define RIGHT_MOTOR_INH_GPIO_Port GPIOB
 
 /* USER CODE BEGIN Private defines */
 
@@ -0,0 +1,134 @@
+/**
+ * @file profile.h
+ * @brief Cycle-accurate hot-path profiling with the DWT cycle counter
+ * 
+ * Wrap a code section with PROFILE_START()/PROFILE_STOP() to collect
+ * min/max/average execution time in CPU cycles. Results live in the
+ * global profile_sections[] table (inspect it from the debugger) and can
+ * be exported over CAN with Profile_ExportCan().
+ * 
+ * Built only when PROFILING_ENABLED is 1 (CMake ENABLE_PROFILING, on by
+ * default for Debug). Otherwise the macros expand to nothing and the
+ * module has no code or data.
+ * 
+ * Each section must be recorded from a single execution context (one
+ * interrupt or the main loop); sections do not nest.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef PROFILING_ENABLED
+#define PROFILING_ENABLED           0
+#endif
+
+/* Export frame: one per section, 29-bit ID outside the DBC range */
+#ifndef PROFILE_CAN_FRAME_ID
+#define PROFILE_CAN_FRAME_ID        0x1800ADF0u
+#endif
+
+/* ============================================================================
+ * Type Definitions
+ * ============================================================================ */
+
+/**
+ * @brief Profiled sections
+ */
+typedef enum {
+    PROFILE_FDCAN_RX_ISR = 0,       /**< HAL_FDCAN_RxFifo0Callback */
+    PROFILE_PROCESS_RX,             /**< ProcessReceivedMessage */
+    PROFILE_PACK,                   /**< automate_codec_*_pack in Send* */
+    PROFILE_ADC_READ,               /**< ADC_ReadPosition */
+    /* Tick sections come from the TIM1 counter, which restarts every
+     * 50 us PWM period: delays of a period or more are recorded as one
+     * period (SystemCoreClock / PWM_FREQUENCY_HZ, 8500 cycles) */
+    PROFILE_TICK_WAKE,              /**< TIM1 update to control callback, CPU was asleep */
+    PROFILE_TICK_ACTIVE,            /**< TIM1 update to control callback, CPU was busy */
+    PROFILE_SECTION_COUNT
+} Profile_SectionId_t;
+
+/**
+ * @brief Statistics of one section, CPU cycles
+ */
+typedef struct {
+    const char *name;
+    uint32_t count;                 /**< Recorded runs */
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;                 /**< Sum for average (total / count) */
+} Profile_Section_t;
+
+#if PROFILING_ENABLED
+
+#include "common.h"
+
+/** Results table, exported for debugger inspection */
+extern Profile_Section_t profile_sections[PROFILE_SECTION_COUNT];
+
+/* ============================================================================
+ * Instrumentation Macros
+ * ============================================================================ */
+
+/** Mark start of section, declares a local start timestamp */
+#define PROFILE_START(id)           uint32_t profile_start_##id = GetCycles()
+
+/** Mark end of section started in the same scope */
+#define PROFILE_STOP(id)            Profile_Record((id), GetCycles() - profile_start_##id)
+
+/* ============================================================================
+ * Public Function Prototypes
+ * ============================================================================ */
+
+/**
+ * @brief Enable cycle counter and clear all sections
+ */
+void Profile_Init(void);
+
+/**
+ * @brief Add one measurement to a section
+ * 
+ * @param id Section identifier
+ * @param cycles Elapsed CPU cycles
+ */
+void Profile_Record(Profile_SectionId_t id, uint32_t cycles);
+
+/**
+ * @brief Get average cycles of a section
+ * 
+ * @param id Section identifier
+ * @return Average cycles, 0 if never recorded
+ */
+uint32_t Profile_GetAverage(Profile_SectionId_t id);
+
+/**
+ * @brief Queue one PROFILE_CAN_FRAME_ID frame per section
+ * 
+ * Payload (little-endian): [0] section id, [1] count (low byte),
+ * [2..3] min, [4..5] max, [6..7] average; cycles saturate at 0xFFFF.
+ * 
+ * @return true if all frames were queued
+ */
+bool Profile_ExportCan(void);
+
+#else /* !PROFILING_ENABLED */
+
+#define PROFILE_START(id)           ((void)0)
+#define PROFILE_STOP(id)            ((void)0)
+
+static inline void Profile_Init(void) {}
+static inline bool Profile_ExportCan(void) { return true; }
+
+#endif /* PROFILING_ENABLED */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILE_H */
@@ -0,0 +1,187 @@
+/**
+ * @file scheduler.h
+ * @brief Cooperative background task scheduler with deadline tracking
+ * 
+ * Runs a static table of tasks from the main loop. Each task is released
+ * every period_ms, shifted by offset_ms from scheduler start, so tasks
+ * with a common period can be phase-separated. Lateness against the
+ * per-task deadline and worst-case execution time are recorded.
+ * 
+ * Hard real-time work (position sampling, state machine) runs on the
+ * control interrupt instead, see control_loop.h.
+ * 
+ * The main loop sleeps through Scheduler_Idle(); the cycles spent asleep
+ * give the CPU load over each SCHEDULER_LOAD_WINDOW_MS window.
+ * 
+ * Sleep is WFI in Sleep mode: TIM1 (control tick), FDCAN and SysTick keep
+ * running and wake the core. Stop mode and clock scaling are not used, as
+ * the PWM, ADC trigger and CAN bit timing all derive from SYSCLK. With
+ * LOW_POWER_IDLE_ENABLED the flash is also powered down during sleep
+ * while the caller reports the actuators parked.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS         16u
+#endif
+
+/** CPU load averaging window */
+#ifndef SCHEDULER_LOAD_WINDOW_MS
+#define SCHEDULER_LOAD_WINDOW_MS    250u
+#endif
+
+/** Flash power-down in sleep while parked (CMake ENABLE_LOW_POWER_IDLE) */
+#ifndef LOW_POWER_IDLE_ENABLED
+#define LOW_POWER_IDLE_ENABLED      0
+#endif
+
+/* ============================================================================
+ * Type Definitions
+ * ============================================================================ */
+
+/**
+ * @brief Task table entry
+ * 
+ * period_ms = 0 runs the task on every Scheduler_Run() pass (event
+ * polling); offset and deadline are ignored for such tasks.
+ */
+typedef struct {
+    const char *name;           /**< For debugging */
+    void (*fn)(void);           /**< Task body, must not block */
+    uint16_t period_ms;         /**< Release period, 0 = every pass */
+    uint16_t offset_ms;         /**< Phase of first release after start */
+    uint16_t deadline_ms;       /**< Allowed start lateness after release */
+} Scheduler_Task_t;
+
+/**
+ * @brief Measured behaviour of one task
+ */
+typedef struct {
+    uint32_t runs;              /**< Completed runs */
+    uint32_t max_exec_cycles;   /**< Worst-case execution time, CPU cycles */
+    uint32_t max_lateness_ms;   /**< Worst start delay after release */
+    uint32_t deadline_misses;   /**< Runs started later than deadline_ms */
+    uint32_t skipped;           /**< Releases dropped because task ran too late */
+} Scheduler_TaskStats_t;
+
+/* ============================================================================
+ * Public Function Prototypes
+ * ============================================================================ */
+
+/**
+ * @brief Install task table and start schedule at current time
+ * 
+ * @param tasks Task table (must stay valid, typically static const)
+ * @param count Number of entries (max SCHEDULER_MAX_TASKS)
+ * @return false if table is NULL, too large, or has a NULL task body
+ */
+bool Scheduler_Init(const Scheduler_Task_t *tasks, uint8_t count);
+
+/**
+ * @brief Run all tasks that are due
+ * 
+ * Call repeatedly from the main loop. Due tasks run in table order.
+ */
+void Scheduler_Run(void);
+
+/**
+ * @brief Change the release period of a periodic task at runtime
+ * 
+ * The table stays const; the new period replaces its period_ms until the
+ * next Scheduler_Init(). Offset and deadline are unchanged, so tasks that
+ * shared a period may now meet in the same millisecond.
+ * 
+ * @param index Task table index
+ * @param period_ms New period, must not be 0
+ * @return false if index is out of range, period_ms is 0 or the task runs
+ *         on every pass (period_ms = 0 in the table)
+ */
+bool Scheduler_SetPeriod(uint8_t index, uint16_t period_ms);
+
+/**
+ * @brief Get the release period in force for a task
+ * 
+ * @param index Task table index
+ * @return Period in ms, 0 for every-pass tasks or an out-of-range index
+ */
+uint16_t Scheduler_GetPeriod(uint8_t index);
+
+/**
+ * @brief Get statistics of a task
+ * 
+ * @param index Task table index
+ * @param stats Output statistics
+ * @return false if index is out of range
+ */
+bool Scheduler_GetTaskStats(uint8_t index, Scheduler_TaskStats_t *stats);
+
+/**
+ * @brief Clear statistics of all tasks
+ */
+void Scheduler_ResetStats(void);
+
+/**
+ * @brief Total overruns of all tasks
+ * 
+ * @return Sum of deadline misses and skipped releases since last reset
+ */
+uint32_t Scheduler_GetOverruns(void);
+
+/**
+ * @brief Sleep until the next interrupt and account the idle time
+ * 
+ * Call from the main loop in place of a bare __WFI().
+ */
+void Scheduler_Idle(void);
+
+/**
+ * @brief Get the wake-up time while interrupts woken by it are running
+ * 
+ * Between the wake-up from Scheduler_Idle() and its return, reports when
+ * the core woke, so a handler can tell whether its interrupt fired while
+ * the core was asleep.
+ * 
+ * @param cycle Output DWT cycle count of the wake-up
+ * @return true if called from a handler entered on return from sleep
+ */
+bool Scheduler_GetWakeCycle(uint32_t *cycle);
+
+/**
+ * @brief Select flash power-down during sleep
+ * 
+ * Saves flash power in sleep at the cost of a longer wake-up, measured
+ * by the PROFILE_TICK_WAKE profile section. Ignored unless
+ * LOW_POWER_IDLE_ENABLED.
+ * 
+ * @param enable true while nothing time-critical is running
+ */
+void Scheduler_SetLowPowerIdle(bool enable);
+
+/**
+ * @brief CPU load of the last completed window
+ * 
+ * Includes interrupt handlers and background tasks, i.e. everything
+ * but Scheduler_Idle() sleep.
+ * 
+ * @return Busy time in percent (0-100)
+ */
+uint8_t Scheduler_GetCpuLoad(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCHEDULER_H */
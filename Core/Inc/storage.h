@@ -0,0 +1,104 @@
+/**
+ * @file storage.h
+ * @brief Wear-levelled persistent records in the STORAGE flash region
+ * 
+ * The region reserved in STM32G431XX_FLASH.ld holds STORAGE_PAGE_COUNT
+ * flash pages used as an append-only log of fixed-size records. Each
+ * record carries a key, a sequence number and a CRC-32; the newest valid
+ * record of a key wins. When the active page is full, the other page is
+ * erased, the newest record of every key is copied over and writing
+ * continues there, so erases alternate between the pages and an
+ * interrupted write or erase never loses the previous value.
+ * 
+ * A reset while a record is programmed can leave a double word with a bad
+ * ECC code. Reading it raises the ECC double error NMI, which must call
+ * Storage_HandleEccError() so the boot scan can skip the slot.
+ * 
+ * Flash writes stall instruction fetch (up to ~22 ms for a page erase),
+ * including the control interrupt. Only write while no actuator is moving.
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+/** Flash pages in the STORAGE region (must match STM32G431XX_FLASH.ld) */
+#define STORAGE_PAGE_COUNT          2u
+
+/** Largest payload of one record in bytes */
+#define STORAGE_DATA_MAX            48u
+
+/* ============================================================================
+ * Type Definitions
+ * ============================================================================ */
+
+/**
+ * @brief Record keys, one value kept per key
+ */
+typedef enum {
+    STORAGE_KEY_CALIBRATION = 0,    /**< ADC calibration, end stops and stroke model */
+    STORAGE_KEY_CONFIG,             /**< Node ID, message cycle times and watchdog timeout */
+    STORAGE_KEY_COUNT
+} Storage_Key_t;
+
+/* ============================================================================
+ * Public Function Prototypes
+ * ============================================================================ */
+
+/**
+ * @brief Scan the STORAGE region for the newest record of each key
+ * 
+ * Call before any module loads its persisted data.
+ */
+void Storage_Init(void);
+
+/**
+ * @brief Acknowledge a flash ECC double error inside the STORAGE region
+ * 
+ * Call first thing from NMI_Handler(). Storage_Init() is the only reader
+ * of unverified slots and marks the slot that failed as used.
+ * 
+ * @return true if the NMI was an ECC double error in STORAGE and its flag
+ *         is cleared, false if the NMI has another cause
+ */
+bool Storage_HandleEccError(void);
+
+/**
+ * @brief Copy the newest valid record of a key
+ * 
+ * @param key Record key
+ * @param data Output buffer
+ * @param size Expected payload size, a record of another size is ignored
+ * @return true if a valid record was copied
+ */
+bool Storage_Read(Storage_Key_t key, void *data, uint16_t size);
+
+/**
+ * @brief Append a new record for a key
+ * 
+ * Does nothing if the newest record already holds the same payload.
+ * 
+ * @param key Record key
+ * @param data Payload
+ * @param size Payload size (max STORAGE_DATA_MAX)
+ * @return true if the payload is stored
+ * 
+ * @note Blocks while flash is programmed; call from main loop context only
+ */
+bool Storage_Write(Storage_Key_t key, const void *data, uint16_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STORAGE_H */
@@ -0,0 +1,151 @@
+/**
+ * @file trace.h
+ * @brief High-rate brake position trace streamed as delta-encoded CAN frames
+ * 
+ * While armed, the control interrupt records the position of the first
+ * brake that starts a push or release, once per control tick, until that
+ * brake stops moving. The ADC scan is shorter than a control tick, so each
+ * sample carries at least one conversion not seen by the previous one. The capture stays in a RAM ring and is
+ * streamed to the PC on request. Stream frames go out at normal TX
+ * priority and are only queued while the TX queue is almost empty, so
+ * heartbeat and brake frames are never held behind the trace.
+ * 
+ * PC -> MCU, TRACE_CMD_FRAME_ID: [0] Trace_Command_t
+ * 
+ * MCU -> PC, one TRACE_INFO_FRAME_ID frame per stream (little-endian):
+ *   [0] brake index
+ *   [1] BrakeState_t at capture end, bit 7 set if oldest samples were overwritten
+ *   [2..3] sample count
+ *   [4..7] HAL_GetTick() of the first sample (samples are one control tick apart)
+ * 
+ * followed by ceil(count / TRACE_SAMPLES_PER_FRAME) TRACE_DATA_FRAME_ID
+ * frames, 64-bit little-endian bit fields:
+ *   bits 0-7    frame sequence number (0, 1, ... wrapping)
+ *   bits 8-19   absolute position of the frame's first sample
+ *   bits 20+    4-bit signed delta to each following sample (-8..+7)
+ * 
+ * Deltas saturate; the encoder tracks the value the PC reconstructs, so a
+ * clipped step is caught up by the next deltas and each frame re-bases.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can.h"
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+/** Capture ring depth in samples (power of 2), 2048 = 2 s of control ticks */
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE           2048u
+#endif
+
+/* Trace frames: 29-bit IDs outside the DBC range, next to PROFILE_CAN_FRAME_ID */
+#ifndef TRACE_CMD_FRAME_ID
+#define TRACE_CMD_FRAME_ID          0x1800ADF1u
+#endif
+
+#ifndef TRACE_INFO_FRAME_ID
+#define TRACE_INFO_FRAME_ID         0x1800ADF2u
+#endif
+
+#ifndef TRACE_DATA_FRAME_ID
+#define TRACE_DATA_FRAME_ID         0x1800ADF3u
+#endif
+
+/** Trace frames are only queued while fewer TX frames than this are pending */
+#ifndef TRACE_TX_QUEUE_LIMIT
+#define TRACE_TX_QUEUE_LIMIT        2u
+#endif
+
+/* Data frame layout: 8-bit sequence, 12-bit base, then 4-bit deltas.
+ * Classic frames carry 12 samples, CAN FD builds 124. */
+#define TRACE_FRAME_LEN             CAN_MAX_DATA_LEN
+#define TRACE_DELTA_FIRST_BIT       20u
+#define TRACE_DELTA_BITS            4u
+#define TRACE_SAMPLES_PER_FRAME     (1u + (TRACE_FRAME_LEN * 8u - TRACE_DELTA_FIRST_BIT) / TRACE_DELTA_BITS)
+
+/** Info frame byte 1 flag: capture ran longer than TRACE_BUFFER_SIZE samples */
+#define TRACE_INFO_FLAG_WRAPPED     0x80u
+
+/* ============================================================================
+ * Type Definitions
+ * ============================================================================ */
+
+/**
+ * @brief Command byte of TRACE_CMD_FRAME_ID
+ */
+typedef enum {
+    TRACE_CMD_DISARM = 0,           /**< Stop capturing and abort a running stream */
+    TRACE_CMD_ARM,                  /**< Capture the next push/release */
+    TRACE_CMD_STREAM                /**< Send the last capture (after it completes) */
+} Trace_Command_t;
+
+/**
+ * @brief Capture state
+ */
+typedef enum {
+    TRACE_STATE_IDLE = 0,           /**< No capture recorded */
+    TRACE_STATE_CAPTURING,          /**< Recording from the control interrupt */
+    TRACE_STATE_READY,              /**< Capture complete, kept until the next one */
+    TRACE_STATE_STREAMING           /**< Sending capture; new moves are not recorded */
+} Trace_State_t;
+
+/* ============================================================================
+ * Public Function Prototypes
+ * ============================================================================ */
+
+/**
+ * @brief Clear capture and disarm
+ * 
+ * Call after Brake_Init() and before ControlLoop_Start().
+ */
+void Trace_Init(void);
+
+/**
+ * @brief Record one sample (control task)
+ * 
+ * Runs from the control interrupt after the brake state machine.
+ */
+void Trace_Sample(void);
+
+/**
+ * @brief Apply a TRACE_CMD_FRAME_ID command
+ * 
+ * @param command Trace_Command_t value
+ * @return false if command is unknown
+ * 
+ * @note Call from main loop context only
+ */
+bool Trace_Command(uint8_t command);
+
+/**
+ * @brief Queue the next stream frame (background task)
+ * 
+ * Sends at most one frame per call, and none while TRACE_TX_QUEUE_LIMIT
+ * or more frames are waiting for transmission.
+ * 
+ * @note Call from main loop context only
+ */
+void Trace_Stream(void);
+
+/**
+ * @brief Get capture state
+ * 
+ * @return Current state
+ */
+Trace_State_t Trace_GetState(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H */
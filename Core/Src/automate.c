@@ -346,6 +346,8 @@ int automate_left_brake_msg_pack(
     dst_p[3] |= pack_left_shift_u8(src_p->brake_pushed, 3u, 0x08u);
     dst_p[4] |= pack_left_shift_u16(src_p->time_to_end_operation, 0u, 0xffu);
     dst_p[5] |= pack_right_shift_u16(src_p->time_to_end_operation, 8u, 0xffu);
+    dst_p[6] |= pack_left_shift_u8(src_p->cmd_msg_id, 0u, 0xffu);
+    dst_p[7] |= pack_left_shift_u8(src_p->cmd_latency, 0u, 0xffu);
 
     return (8);
 }
@@ -368,6 +370,8 @@ int automate_left_brake_msg_unpack(
     dst_p->brake_pushed = unpack_right_shift_u8(src_p[3], 3u, 0x08u);
     dst_p->time_to_end_operation = unpack_right_shift_u16(src_p[4], 0u, 0xffu);
     dst_p->time_to_end_operation |= unpack_left_shift_u16(src_p[5], 8u, 0xffu);
+    dst_p->cmd_msg_id = unpack_right_shift_u8(src_p[6], 0u, 0xffu);
+    dst_p->cmd_latency = unpack_right_shift_u8(src_p[7], 0u, 0xffu);
 
     return (0);
 }
@@ -491,3 +495,373 @@ bool automate_left_brake_msg_time_to_end_operation_is_in_range(uint16_t value)
 
     return (true);
 }
+
+uint8_t automate_left_brake_msg_cmd_msg_id_encode(double value)
+{
+    return (uint8_t)(value);
+}
+
+double automate_left_brake_msg_cmd_msg_id_decode(uint8_t value)
+{
+    return ((double)value);
+}
+
+bool automate_left_brake_msg_cmd_msg_id_is_in_range(uint8_t value)
+{
+    (void)value;
+
+    return (true);
+}
+
+uint8_t automate_left_brake_msg_cmd_latency_encode(double value)
+{
+    return (uint8_t)(value / 0.1);
+}
+
+double automate_left_brake_msg_cmd_latency_decode(uint8_t value)
+{
+    return ((double)value * 0.1);
+}
+
+bool automate_left_brake_msg_cmd_latency_is_in_range(uint8_t value)
+{
+    (void)value;
+
+    return (true);
+}
+
+int automate_mcu_diag_msg_pack(
+    uint8_t *dst_p,
+    const struct automate_mcu_diag_msg_t *src_p,
+    size_t size)
+{
+    if (size < 8u) {
+        return (-EINVAL);
+    }
+
+    memset(&dst_p[0], 0, 8);
+
+    dst_p[0] |= pack_left_shift_u16(src_p->rx_frames, 0u, 0xffu);
+    dst_p[1] |= pack_right_shift_u16(src_p->rx_frames, 8u, 0x0fu);
+    dst_p[1] |= pack_left_shift_u16(src_p->tx_frames, 4u, 0xf0u);
+    dst_p[2] |= pack_right_shift_u16(src_p->tx_frames, 4u, 0xffu);
+    dst_p[3] |= pack_left_shift_u8(src_p->ring_drops, 0u, 0xffu);
+    dst_p[4] |= pack_left_shift_u8(src_p->tec, 0u, 0xffu);
+    dst_p[5] |= pack_left_shift_u8(src_p->rec, 0u, 0x7fu);
+    dst_p[5] |= pack_left_shift_u8(src_p->bus_off, 7u, 0x80u);
+    dst_p[6] |= pack_left_shift_u8(src_p->bus_off_count, 0u, 0x0fu);
+    dst_p[6] |= pack_left_shift_u8(src_p->loop_overruns, 4u, 0xf0u);
+    dst_p[7] |= pack_left_shift_u8(src_p->cpu_load, 0u, 0xffu);
+
+    return (8);
+}
+
+int automate_mcu_diag_msg_unpack(
+    struct automate_mcu_diag_msg_t *dst_p,
+    const uint8_t *src_p,
+    size_t size)
+{
+    if (size < 8u) {
+        return (-EINVAL);
+    }
+
+    dst_p->rx_frames = unpack_right_shift_u16(src_p[0], 0u, 0xffu);
+    dst_p->rx_frames |= unpack_left_shift_u16(src_p[1], 8u, 0x0fu);
+    dst_p->tx_frames = unpack_right_shift_u16(src_p[1], 4u, 0xf0u);
+    dst_p->tx_frames |= unpack_left_shift_u16(src_p[2], 4u, 0xffu);
+    dst_p->ring_drops = unpack_right_shift_u8(src_p[3], 0u, 0xffu);
+    dst_p->tec = unpack_right_shift_u8(src_p[4], 0u, 0xffu);
+    dst_p->rec = unpack_right_shift_u8(src_p[5], 0u, 0x7fu);
+    dst_p->bus_off = unpack_right_shift_u8(src_p[5], 7u, 0x80u);
+    dst_p->bus_off_count = unpack_right_shift_u8(src_p[6], 0u, 0x0fu);
+    dst_p->loop_overruns = unpack_right_shift_u8(src_p[6], 4u, 0xf0u);
+    dst_p->cpu_load = unpack_right_shift_u8(src_p[7], 0u, 0xffu);
+
+    return (0);
+}
+
+int automate_mcu_diag_msg_init(struct automate_mcu_diag_msg_t *msg_p)
+{
+    if (msg_p == NULL) return -1;
+
+    memset(msg_p, 0, sizeof(struct automate_mcu_diag_msg_t));
+
+    return 0;
+}
+
+uint16_t automate_mcu_diag_msg_rx_frames_encode(double value)
+{
+    return (uint16_t)(value);
+}
+
+double automate_mcu_diag_msg_rx_frames_decode(uint16_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_diag_msg_rx_frames_is_in_range(uint16_t value)
+{
+    return (value <= 4095u);
+}
+
+uint16_t automate_mcu_diag_msg_tx_frames_encode(double value)
+{
+    return (uint16_t)(value);
+}
+
+double automate_mcu_diag_msg_tx_frames_decode(uint16_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_diag_msg_tx_frames_is_in_range(uint16_t value)
+{
+    return (value <= 4095u);
+}
+
+uint8_t automate_mcu_diag_msg_ring_drops_encode(double value)
+{
+    return (uint8_t)(value);
+}
+
+double automate_mcu_diag_msg_ring_drops_decode(uint8_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_diag_msg_ring_drops_is_in_range(uint8_t value)
+{
+    (void)value;
+
+    return (true);
+}
+
+uint8_t automate_mcu_diag_msg_tec_encode(double value)
+{
+    return (uint8_t)(value);
+}
+
+double automate_mcu_diag_msg_tec_decode(uint8_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_diag_msg_tec_is_in_range(uint8_t value)
+{
+    (void)value;
+
+    return (true);
+}
+
+uint8_t automate_mcu_diag_msg_rec_encode(double value)
+{
+    return (uint8_t)(value);
+}
+
+double automate_mcu_diag_msg_rec_decode(uint8_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_diag_msg_rec_is_in_range(uint8_t value)
+{
+    return (value <= 127u);
+}
+
+uint8_t automate_mcu_diag_msg_bus_off_encode(double value)
+{
+    return (uint8_t)(value);
+}
+
+double automate_mcu_diag_msg_bus_off_decode(uint8_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_diag_msg_bus_off_is_in_range(uint8_t value)
+{
+    return (value <= 1u);
+}
+
+uint8_t automate_mcu_diag_msg_bus_off_count_encode(double value)
+{
+    return (uint8_t)(value);
+}
+
+double automate_mcu_diag_msg_bus_off_count_decode(uint8_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_diag_msg_bus_off_count_is_in_range(uint8_t value)
+{
+    return (value <= 15u);
+}
+
+uint8_t automate_mcu_diag_msg_loop_overruns_encode(double value)
+{
+    return (uint8_t)(value);
+}
+
+double automate_mcu_diag_msg_loop_overruns_decode(uint8_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_diag_msg_loop_overruns_is_in_range(uint8_t value)
+{
+    return (value <= 15u);
+}
+
+uint8_t automate_mcu_diag_msg_cpu_load_encode(double value)
+{
+    return (uint8_t)(value);
+}
+
+double automate_mcu_diag_msg_cpu_load_decode(uint8_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_diag_msg_cpu_load_is_in_range(uint8_t value)
+{
+    return (value <= 100u);
+}
+
+int automate_mcu_config_cmd_pack(
+    uint8_t *dst_p,
+    const struct automate_mcu_config_cmd_t *src_p,
+    size_t size)
+{
+    if (size < 8u) {
+        return (-EINVAL);
+    }
+
+    memset(&dst_p[0], 0, 8);
+
+    dst_p[0] |= pack_left_shift_u8(src_p->target_node_id, 0u, 0xffu);
+    dst_p[1] |= pack_left_shift_u8(src_p->node_id, 0u, 0xffu);
+    dst_p[2] |= pack_left_shift_u16(src_p->heartbeat_cycle, 0u, 0xffu);
+    dst_p[3] |= pack_right_shift_u16(src_p->heartbeat_cycle, 8u, 0xffu);
+    dst_p[4] |= pack_left_shift_u16(src_p->telemetry_cycle, 0u, 0xffu);
+    dst_p[5] |= pack_right_shift_u16(src_p->telemetry_cycle, 8u, 0xffu);
+    dst_p[6] |= pack_left_shift_u16(src_p->watchdog_timeout, 0u, 0xffu);
+    dst_p[7] |= pack_right_shift_u16(src_p->watchdog_timeout, 8u, 0xffu);
+
+    return (8);
+}
+
+int automate_mcu_config_cmd_unpack(
+    struct automate_mcu_config_cmd_t *dst_p,
+    const uint8_t *src_p,
+    size_t size)
+{
+    if (size < 8u) {
+        return (-EINVAL);
+    }
+
+    dst_p->target_node_id = unpack_right_shift_u8(src_p[0], 0u, 0xffu);
+    dst_p->node_id = unpack_right_shift_u8(src_p[1], 0u, 0xffu);
+    dst_p->heartbeat_cycle = unpack_right_shift_u16(src_p[2], 0u, 0xffu);
+    dst_p->heartbeat_cycle |= unpack_left_shift_u16(src_p[3], 8u, 0xffu);
+    dst_p->telemetry_cycle = unpack_right_shift_u16(src_p[4], 0u, 0xffu);
+    dst_p->telemetry_cycle |= unpack_left_shift_u16(src_p[5], 8u, 0xffu);
+    dst_p->watchdog_timeout = unpack_right_shift_u16(src_p[6], 0u, 0xffu);
+    dst_p->watchdog_timeout |= unpack_left_shift_u16(src_p[7], 8u, 0xffu);
+
+    return (0);
+}
+
+int automate_mcu_config_cmd_init(struct automate_mcu_config_cmd_t *msg_p)
+{
+    if (msg_p == NULL) return -1;
+
+    memset(msg_p, 0, sizeof(struct automate_mcu_config_cmd_t));
+
+    return 0;
+}
+
+uint8_t automate_mcu_config_cmd_target_node_id_encode(double value)
+{
+    return (uint8_t)(value);
+}
+
+double automate_mcu_config_cmd_target_node_id_decode(uint8_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_config_cmd_target_node_id_is_in_range(uint8_t value)
+{
+    (void)value;
+
+    return (true);
+}
+
+uint8_t automate_mcu_config_cmd_node_id_encode(double value)
+{
+    return (uint8_t)(value);
+}
+
+double automate_mcu_config_cmd_node_id_decode(uint8_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_config_cmd_node_id_is_in_range(uint8_t value)
+{
+    (void)value;
+
+    return (true);
+}
+
+uint16_t automate_mcu_config_cmd_heartbeat_cycle_encode(double value)
+{
+    return (uint16_t)(value);
+}
+
+double automate_mcu_config_cmd_heartbeat_cycle_decode(uint16_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_config_cmd_heartbeat_cycle_is_in_range(uint16_t value)
+{
+    (void)value;
+
+    return (true);
+}
+
+uint16_t automate_mcu_config_cmd_telemetry_cycle_encode(double value)
+{
+    return (uint16_t)(value);
+}
+
+double automate_mcu_config_cmd_telemetry_cycle_decode(uint16_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_config_cmd_telemetry_cycle_is_in_range(uint16_t value)
+{
+    (void)value;
+
+    return (true);
+}
+
+uint16_t automate_mcu_config_cmd_watchdog_timeout_encode(double value)
+{
+    return (uint16_t)(value);
+}
+
+double automate_mcu_config_cmd_watchdog_timeout_decode(uint16_t value)
+{
+    return ((double)value);
+}
+
+bool automate_mcu_config_cmd_watchdog_timeout_is_in_range(uint16_t value)
+{
+    (void)value;
+
+    return (true);
+}
@@ -3,55 +3,178 @@
  * @brief CAN driver with ring buffer implementation for STM32 FDCAN
  * 
  * Features:
- * - Thread-safe ring buffers for RX and TX
+ * - Lock-free single-producer/single-consumer ring buffers for RX and TX
+ * - Two TX priority classes: high-priority ring always drained first
+ * - Zero-copy reserve/commit (TX) and peek/release (RX) on ring slots
  * - Support for extended 29-bit and standard 11-bit IDs
- * - Non-blocking transmission with automatic retry
- * - Interrupt-driven reception
+ * - Interrupt-driven transmission: TX-complete ISR refills the hardware FIFO
+ * - Interrupt-driven reception, whole FIFO drained per interrupt
+ * - RX FIFO 1 for priority frames (selected per hardware filter)
+ * - Optional CAN FD (CAN_FD_ENABLED): up to 64-byte frames with bit-rate switch
+ * - Bus state supervision with automatic rejoin after bus-off
+ *
+ * Ring buffer concurrency model:
+ * - RX: producer = FDCAN RX ISR, consumer = main loop
+ * - TX: producer = main loop,    consumer = FDCAN TX-complete callback
+ *       (same model for both TX priority rings)
+ * Each index is written by exactly one side, so no global interrupt masking
+ * is required. Indices are free-running and wrapped with a power-of-two mask.
+ * The main loop "kicks" TX by running the consumer itself with both FDCAN
+ * lines masked: HAL_FDCAN_IRQHandler() services TX complete from the RX
+ * line as well, so masking line 1 alone would let the consumer run twice.
+ * RX is held off only for the few frames loaded into the hardware FIFO.
  */
 
 #include <string.h>
 #include "common.h"
 #include "can.h"
+#include "profile.h"
 
 /* ============================================================================
  * Configuration
  * ============================================================================ */
 
-/* Ring buffer size (must be power of 2 for efficient modulo operation) */
-#define CAN_RX_BUFFER_SIZE          8
-#define CAN_TX_BUFFER_SIZE          8
+/*
+ * Ring buffer size (must be power of 2 for mask-based wrap-around).
+ * Override per direction at build time, e.g. from CMake:
+ *   -DCAN_RX_BUFFER_SIZE=64 -DCAN_TX_BUFFER_SIZE=16
+ * Maximum is 128 so that the fill level fits the uint8_t count API.
+ */
+#ifndef CAN_RX_BUFFER_SIZE
+#define CAN_RX_BUFFER_SIZE          32
+#endif
+
+#ifndef CAN_TX_BUFFER_SIZE
+#define CAN_TX_BUFFER_SIZE          16
+#endif
+
+/* High-priority TX ring (heartbeat, fault frames) - only needs a few slots */
+#ifndef CAN_TX_HIGH_BUFFER_SIZE
+#define CAN_TX_HIGH_BUFFER_SIZE     4
+#endif
+
+#define CAN_IS_POWER_OF_2(x)        (((x) != 0u) && (((x) & ((x) - 1u)) == 0u))
+
+_Static_assert(CAN_IS_POWER_OF_2(CAN_RX_BUFFER_SIZE), "CAN_RX_BUFFER_SIZE must be a power of 2");
+_Static_assert(CAN_IS_POWER_OF_2(CAN_TX_BUFFER_SIZE), "CAN_TX_BUFFER_SIZE must be a power of 2");
+_Static_assert(CAN_RX_BUFFER_SIZE <= 128, "CAN_RX_BUFFER_SIZE must not exceed 128");
+_Static_assert(CAN_TX_BUFFER_SIZE <= 128, "CAN_TX_BUFFER_SIZE must not exceed 128");
+_Static_assert(CAN_IS_POWER_OF_2(CAN_TX_HIGH_BUFFER_SIZE), "CAN_TX_HIGH_BUFFER_SIZE must be a power of 2");
+_Static_assert(CAN_TX_BUFFER_SIZE + CAN_TX_HIGH_BUFFER_SIZE <= 255, "Total TX queue depth must fit uint8_t");
+
+/*
+ * Bus-off rejoin hold-off. The first bus-off restarts at once; a bus-off
+ * within CAN_RECOVERY_STABLE_MS of the last rejoin waits
+ * CAN_RECOVERY_HOLDOFF_MIN_MS, doubling up to CAN_RECOVERY_HOLDOFF_MAX_MS,
+ * so a node with a wiring fault stops disturbing the bus ever more rarely.
+ */
+#ifndef CAN_RECOVERY_HOLDOFF_MIN_MS
+#define CAN_RECOVERY_HOLDOFF_MIN_MS 10u
+#endif
+
+#ifndef CAN_RECOVERY_HOLDOFF_MAX_MS
+#define CAN_RECOVERY_HOLDOFF_MAX_MS 640u
+#endif
+
+#ifndef CAN_RECOVERY_STABLE_MS
+#define CAN_RECOVERY_STABLE_MS      1000u
+#endif
+
+#define CAN_ERROR_WARNING_LIMIT     96u     /* ISO 11898-1 error warning limit */
+#define CAN_TX_BUFFERS_ALL          (FDCAN_TX_BUFFER0 | FDCAN_TX_BUFFER1 | FDCAN_TX_BUFFER2)
+
+#if CAN_FD_ENABLED
+/*
+ * Transmitter delay compensation for the data phase: secondary sample point
+ * at the data-phase sample point, measured from the start of the bit.
+ */
+#define CAN_FD_TDC_OFFSET           (hfdcan1.Init.DataPrescaler * (1u + hfdcan1.Init.DataTimeSeg1))
+#define CAN_FD_TDC_FILTER           0u
+#endif
 
 /* ============================================================================
  * Type Definitions
  * ============================================================================ */
 
 /**
- * @brief Ring buffer structure for CAN messages
+ * @brief Single-producer/single-consumer ring buffer for CAN messages
+ * 
+ * head is only written by the producer, tail only by the consumer.
+ * Both are free-running counters; (head - tail) is the fill level and
+ * (index & mask) is the slot position.
+ * Statistics are updated by the producer only.
  */
 typedef struct {
-    CAN_Message_t buffer[CAN_TX_BUFFER_SIZE];  /* Message storage */
-    volatile uint8_t head;                      /* Write index */
-    volatile uint8_t tail;                      /* Read index */
-    volatile uint8_t count;                     /* Number of messages in buffer */
+    CAN_Message_t *buffer;                      /* Message storage */
+    uint32_t mask;                              /* Buffer size - 1 */
+    volatile uint32_t head;                     /* Write index (producer only) */
+    volatile uint32_t tail;                     /* Read index (consumer only) */
+    volatile uint32_t dropped;                  /* Put attempts rejected (buffer full) */
+    volatile uint32_t high_watermark;           /* Maximum fill level observed */
 } CAN_RingBuffer_t;
 
 /* ============================================================================
  * Private Variables
  * ============================================================================ */
 
-/* Separate ring buffers for RX and TX */
-static CAN_RingBuffer_t can_rx_buffer = {0};
-static CAN_RingBuffer_t can_tx_buffer = {0};
+/* Message storage for RX and TX */
+static CAN_Message_t can_rx_storage[CAN_RX_BUFFER_SIZE];
+static CAN_Message_t can_tx_storage[CAN_TX_BUFFER_SIZE];
+static CAN_Message_t can_tx_high_storage[CAN_TX_HIGH_BUFFER_SIZE];
+
+/* Separate ring buffers for RX and TX (normal + high priority) */
+static CAN_RingBuffer_t can_rx_buffer = { can_rx_storage, CAN_RX_BUFFER_SIZE - 1u, 0u, 0u, 0u, 0u };
+static CAN_RingBuffer_t can_tx_buffer = { can_tx_storage, CAN_TX_BUFFER_SIZE - 1u, 0u, 0u, 0u, 0u };
+static CAN_RingBuffer_t can_tx_high_buffer = { can_tx_high_storage, CAN_TX_HIGH_BUFFER_SIZE - 1u, 0u, 0u, 0u, 0u };
+
+/* Frame counters (RX written by ISR, TX written by main loop) */
+static volatile uint32_t can_rx_frames = 0;
+static volatile uint32_t can_tx_frames = 0;
+
+/* Hardware RX FIFO events (written by ISR) */
+static volatile uint32_t can_rx_fifo_full_events = 0;
+static volatile uint32_t can_rx_fifo_lost = 0;
+
+/* Bus-off entries (written by ISR) */
+static volatile uint32_t can_bus_off_events = 0;
+
+/* Bus supervision, main loop only except the bus-off flag set by the error ISR */
+static volatile bool can_bus_off_pending = false;
+static CAN_BusState_t can_bus_state = CAN_BUS_STATE_ACTIVE;
+static CAN_RecoveryPolicy_t can_recovery_policy = CAN_RECOVERY_FLUSH_NORMAL;
+static uint32_t can_bus_off_tick = 0;       /* Entry into the current bus-off */
+static uint32_t can_restart_tick = 0;       /* Earliest restart of the current bus-off */
+static uint32_t can_holdoff_ms = 0;         /* Hold-off applied to the next bus-off */
+static uint32_t can_rejoin_tick = 0;        /* Last completed rejoin */
+static uint32_t can_recoveries = 0;
+static uint32_t can_last_recovery_ms = 0;
+
+/* CPU cycles per FDCAN timestamp tick (one nominal bit time) */
+static uint32_t can_cycles_per_bit = 0;
+
+/* Payload length of DLC codes 9-15 (CAN FD) */
+static const uint8_t can_fd_dlc_len[7] = { 12u, 16u, 20u, 24u, 32u, 48u, 64u };
 
 /* ============================================================================
  * Private Function Prototypes
  * ============================================================================ */
 
-static bool RingBuffer_Put(CAN_RingBuffer_t *buffer, const CAN_Message_t *msg, uint8_t buffer_size);
-static bool RingBuffer_Get(CAN_RingBuffer_t *buffer, CAN_Message_t *msg, uint8_t buffer_size);
-static bool RingBuffer_IsFull(const CAN_RingBuffer_t *buffer, uint8_t buffer_size);
+static CAN_Message_t *RingBuffer_Reserve(CAN_RingBuffer_t *buffer);
+static void RingBuffer_Commit(CAN_RingBuffer_t *buffer);
+static bool RingBuffer_Get(CAN_RingBuffer_t *buffer, CAN_Message_t *msg);
+static CAN_Message_t *RingBuffer_Peek(CAN_RingBuffer_t *buffer);
+static void RingBuffer_Advance(CAN_RingBuffer_t *buffer);
+static void RingBuffer_Flush(CAN_RingBuffer_t *buffer);
 static bool RingBuffer_IsEmpty(const CAN_RingBuffer_t *buffer);
-static uint8_t RingBuffer_GetCount(const CAN_RingBuffer_t *buffer);
+static uint32_t RingBuffer_GetCount(const CAN_RingBuffer_t *buffer);
+static void CAN_Driver_RefillTx(FDCAN_HandleTypeDef *hfdcan);
+static void CAN_Driver_MaskIrq(void);
+static void CAN_Driver_UnmaskIrq(void);
+static uint32_t CAN_Driver_RxTimestampToCycles(FDCAN_HandleTypeDef *hfdcan, uint32_t rx_timestamp);
+static CAN_BusState_t CAN_Driver_ErrorState(const FDCAN_ErrorCountersTypeDef *counters,
+                                            const FDCAN_ProtocolStatusTypeDef *protocol);
+static void CAN_Driver_EnterBusOff(uint32_t now);
+static bool CAN_Driver_Restart(void);
 
 /* ============================================================================
  * Public Functions
@@ -65,79 +188,396 @@ static uint8_t RingBuffer_GetCount(const CAN_RingBuffer_t *buffer);
 void CAN_Driver_Init(void)
 {
     /* Clear ring buffers */
-    memset(&can_rx_buffer, 0, sizeof(can_rx_buffer));
-    memset(&can_tx_buffer, 0, sizeof(can_tx_buffer));
+    memset(can_rx_storage, 0, sizeof(can_rx_storage));
+    memset(can_tx_storage, 0, sizeof(can_tx_storage));
+    memset(can_tx_high_storage, 0, sizeof(can_tx_high_storage));
+    can_rx_buffer.head = 0;
+    can_rx_buffer.tail = 0;
+    can_tx_buffer.head = 0;
+    can_tx_buffer.tail = 0;
+    can_tx_high_buffer.head = 0;
+    can_tx_high_buffer.tail = 0;
+    
+    /* Clear statistics */
+    can_rx_buffer.dropped = 0;
+    can_rx_buffer.high_watermark = 0;
+    can_tx_buffer.dropped = 0;
+    can_tx_buffer.high_watermark = 0;
+    can_tx_high_buffer.dropped = 0;
+    can_tx_high_buffer.high_watermark = 0;
+    can_rx_frames = 0;
+    can_tx_frames = 0;
+    can_rx_fifo_full_events = 0;
+    can_rx_fifo_lost = 0;
+    can_bus_off_events = 0;
+    
+    /* Reset bus supervision */
+    can_bus_off_pending = false;
+    can_bus_state = CAN_BUS_STATE_ACTIVE;
+    can_recovery_policy = CAN_RECOVERY_FLUSH_NORMAL;
+    can_holdoff_ms = 0;
+    can_rejoin_tick = 0;
+    can_recoveries = 0;
+    can_last_recovery_ms = 0;
 }
 
 /**
- * @brief Queue a CAN message for transmission
+ * @brief Program hardware acceptance filters
+ * 
+ * Standard and extended entries are numbered independently, in table order.
+ * 
+ * @param filters Filter table
+ * @param count Number of entries in filter table
+ * @param reject_non_matching true to reject frames matching no filter
+ * @return true if all filters were programmed
+ */
+bool CAN_Driver_ConfigFilters(const CAN_Filter_t *filters, uint8_t count, bool reject_non_matching)
+{
+    uint32_t std_index = 0;
+    uint32_t ext_index = 0;
+    
+    if (filters == NULL && count > 0) {
+        return false;
+    }
+    
+    for (uint8_t i = 0; i < count; i++) {
+        FDCAN_FilterTypeDef filter;
+        
+        /* Allocate next filter element of the matching type */
+        if (filters[i].is_extended) {
+            if (ext_index >= hfdcan1.Init.ExtFiltersNbr) {
+                return false;
+            }
+            filter.IdType = FDCAN_EXTENDED_ID;
+            filter.FilterIndex = ext_index++;
+        } else {
+            if (std_index >= hfdcan1.Init.StdFiltersNbr) {
+                return false;
+            }
+            filter.IdType = FDCAN_STANDARD_ID;
+            filter.FilterIndex = std_index++;
+        }
+        
+        /* Classic ID/mask filter into RX FIFO 0, or priority RX FIFO 1 */
+        filter.FilterType = FDCAN_FILTER_MASK;
+        filter.FilterConfig = filters[i].high_priority ? FDCAN_FILTER_TO_RXFIFO1 : FDCAN_FILTER_TO_RXFIFO0;
+        filter.FilterID1 = filters[i].id;
+        filter.FilterID2 = filters[i].mask;
+        
+        if (HAL_FDCAN_ConfigFilter(&hfdcan1, &filter) != HAL_OK) {
+            return false;
+        }
+    }
+    
+    /* Decide fate of frames that match no filter element */
+    if (reject_non_matching) {
+        return HAL_FDCAN_ConfigGlobalFilter(&hfdcan1,
+                                            FDCAN_REJECT, FDCAN_REJECT,
+                                            FDCAN_REJECT_REMOTE, FDCAN_REJECT_REMOTE) == HAL_OK;
+    }
+    
+    return HAL_FDCAN_ConfigGlobalFilter(&hfdcan1,
+                                        FDCAN_ACCEPT_IN_RX_FIFO0, FDCAN_ACCEPT_IN_RX_FIFO0,
+                                        FDCAN_FILTER_REMOTE, FDCAN_FILTER_REMOTE) == HAL_OK;
+}
+
+/**
+ * @brief Start CAN peripheral
+ * 
+ * @return true if peripheral started successfully
+ */
+bool CAN_Driver_Start(void)
+{
+    /* Route TX complete (SMSG group) to interrupt line 1, RX stays on line 0 */
+    if (HAL_FDCAN_ConfigInterruptLines(&hfdcan1, FDCAN_IT_GROUP_SMSG, FDCAN_INTERRUPT_LINE1) != HAL_OK) {
+        return false;
+    }
+    
+    /* Refill hardware TX FIFO as soon as any of its three buffers completes */
+    if (HAL_FDCAN_ActivateNotification(&hfdcan1, FDCAN_IT_TX_COMPLETE,
+                                       FDCAN_TX_BUFFER0 | FDCAN_TX_BUFFER1 | FDCAN_TX_BUFFER2) != HAL_OK) {
+        return false;
+    }
+    
+    /* Enable RX FIFO 0/1 interrupts (new message, full, message lost) */
+    if (HAL_FDCAN_ActivateNotification(&hfdcan1,
+                                       FDCAN_IT_RX_FIFO0_NEW_MESSAGE |
+                                       FDCAN_IT_RX_FIFO0_FULL |
+                                       FDCAN_IT_RX_FIFO0_MESSAGE_LOST |
+                                       FDCAN_IT_RX_FIFO1_NEW_MESSAGE |
+                                       FDCAN_IT_RX_FIFO1_FULL |
+                                       FDCAN_IT_RX_FIFO1_MESSAGE_LOST, 0) != HAL_OK) {
+        return false;
+    }
+    
+    /* RX timestamps count nominal bit times (FDCAN kernel clock = PCLK1, ClockDivider DIV1) */
+    can_cycles_per_bit = (uint32_t)(((uint64_t)SystemCoreClock * hfdcan1.Init.NominalPrescaler *
+                                     (1u + hfdcan1.Init.NominalTimeSeg1 + hfdcan1.Init.NominalTimeSeg2)) /
+                                    HAL_RCC_GetPCLK1Freq());
+    if (HAL_FDCAN_ConfigTimestampCounter(&hfdcan1, FDCAN_TIMESTAMP_PRESC_1) != HAL_OK ||
+        HAL_FDCAN_EnableTimestampCounter(&hfdcan1, FDCAN_TIMESTAMP_INTERNAL) != HAL_OK) {
+        return false;
+    }
+    EnableCycleCounter();
+    
+#if CAN_FD_ENABLED
+    /* Data phase runs faster than the transceiver loop delay allows without TDC */
+    if (hfdcan1.Init.FrameFormat != FDCAN_FRAME_FD_BRS ||
+        HAL_FDCAN_ConfigTxDelayCompensation(&hfdcan1, CAN_FD_TDC_OFFSET, CAN_FD_TDC_FILTER) != HAL_OK ||
+        HAL_FDCAN_EnableTxDelayCompensation(&hfdcan1) != HAL_OK) {
+        return false;
+    }
+#endif
+    
+    /* Count bus-off entries (protocol error group, line 0) */
+    if (HAL_FDCAN_ActivateNotification(&hfdcan1, FDCAN_IT_BUS_OFF, 0) != HAL_OK) {
+        return false;
+    }
+    
+    if (HAL_FDCAN_Start(&hfdcan1) != HAL_OK) {
+        return false;
+    }
+    
+    /* Send anything queued before the peripheral was running */
+    CAN_Driver_Transmit();
+    
+    return true;
+}
+
+/**
+ * @brief Queue a CAN message for transmission (normal priority)
  * 
  * @param id CAN identifier (11-bit standard or 29-bit extended)
- * @param data Pointer to message data (up to 8 bytes)
- * @param len Data length (0-8 bytes)
+ * @param data Pointer to message data (up to CAN_MAX_DATA_LEN bytes)
+ * @param len Data length (0-CAN_MAX_DATA_LEN bytes)
  * @return true if message queued successfully, false if buffer full or invalid parameters
  */
 bool CAN_Driver_Send(uint32_t id, const uint8_t *data, uint8_t len)
 {
+    return CAN_Driver_SendPriority(id, data, len, CAN_TX_PRIORITY_NORMAL);
+}
+
+/**
+ * @brief Queue a CAN message for transmission in a priority class
+ * 
+ * Payloads above 8 bytes are sent as CAN FD frames and zero-padded up to
+ * the next DLC step.
+ * 
+ * @param id CAN identifier (11-bit standard or 29-bit extended)
+ * @param data Pointer to message data (up to CAN_MAX_DATA_LEN bytes)
+ * @param len Data length (0-CAN_MAX_DATA_LEN bytes)
+ * @param priority TX priority class
+ * @return true if message queued successfully, false if buffer full or invalid parameters
+ */
+bool CAN_Driver_SendPriority(uint32_t id, const uint8_t *data, uint8_t len, CAN_TxPriority_t priority)
+{
+    CAN_Message_t *msg;
+    uint8_t frame_len;
+    
     /* Validate parameters */
-    if (data == NULL || len > 8) {
+    if (data == NULL || len > CAN_MAX_DATA_LEN) {
         return false;
     }
     
-    /* Create message */
-    CAN_Message_t msg;
-    msg.id = id;
-    msg.len = len;
-    msg.is_extended = true;  /* Default to extended ID (29-bit) */
+    /* Round up to the length the DLC actually encodes */
+    frame_len = CAN_Driver_DlcToLen(CAN_Driver_LenToDlc(len));
+    
+    /* Build message directly in the ring slot (rejections are counted per class) */
+    msg = CAN_Driver_TxReserve(priority);
+    if (msg == NULL) {
+        return false;
+    }
+    
+    msg->id = id;
+    msg->len = frame_len;
+    msg->is_extended = true;  /* Default to extended ID (29-bit) */
+    msg->is_fd = (len > CAN_CLASSIC_MAX_DATA_LEN);
+    msg->filter_index = CAN_FILTER_INDEX_NONE;
     
     /* Copy data (only up to len bytes) */
-    memcpy(msg.data, data, len);
+    memcpy(msg->data, data, len);
+    
+    /* Clear padding and unused bytes for safety */
+    if (len < CAN_MAX_DATA_LEN) {
+        memset(&msg->data[len], 0, CAN_MAX_DATA_LEN - len);
+    }
+    
+    return CAN_Driver_TxCommit(priority);
+}
+
+/**
+ * @brief Reserve the next TX ring slot of a priority class
+ * 
+ * @param priority TX priority class
+ * @return Pointer to free slot (classic format), or NULL if the class queue is full
+ */
+CAN_Message_t *CAN_Driver_TxReserve(CAN_TxPriority_t priority)
+{
+    CAN_Message_t *slot = RingBuffer_Reserve((priority == CAN_TX_PRIORITY_HIGH) ? &can_tx_high_buffer
+                                                                                : &can_tx_buffer);
+    
+    /* Slots are reused: do not inherit the format of the previous frame */
+    if (slot != NULL) {
+        slot->is_fd = false;
+    }
+    
+    return slot;
+}
+
+/**
+ * @brief Publish the slot returned by CAN_Driver_TxReserve() and start TX
+ * 
+ * @param priority TX priority class used for the reservation
+ * @return true if message queued, false if the class queue is full (no
+ *         reservation) or the slot holds an invalid length or format
+ */
+bool CAN_Driver_TxCommit(CAN_TxPriority_t priority)
+{
+    CAN_RingBuffer_t *ring = (priority == CAN_TX_PRIORITY_HIGH) ? &can_tx_high_buffer : &can_tx_buffer;
+    const CAN_Message_t *slot = &ring->buffer[ring->head & ring->mask];
+    
+    /* Without a successful reserve the head slot is the oldest queued frame */
+    if (ring->head - ring->tail > ring->mask) {
+        return false;
+    }
     
-    /* Clear unused bytes for safety */
-    if (len < 8) {
-        memset(&msg.data[len], 0, 8 - len);
+    /* Slot is only published when its length is valid; otherwise it stays free */
+    if (slot->is_fd ? (!CAN_FD_ENABLED || slot->len > CAN_MAX_DATA_LEN)
+                    : (slot->len > CAN_CLASSIC_MAX_DATA_LEN)) {
+        return false;
     }
     
-    /* Add to TX ring buffer */
-    return RingBuffer_Put(&can_tx_buffer, &msg, CAN_TX_BUFFER_SIZE);
+    RingBuffer_Commit(ring);
+    
+    /* Start transmission now if hardware TX FIFO has room */
+    CAN_Driver_Transmit();
+    
+    return true;
 }
 
 /**
- * @brief Process pending CAN transmissions
+ * @brief Kick pending CAN transmissions
  * 
- * Call this periodically from main loop to send queued messages.
- * Messages are transmitted in FIFO order.
+ * Moves queued messages into the hardware TX FIFO from thread context.
+ * The TX-complete callback is the other caller of the refill routine and
+ * can run from either FDCAN line, so both are masked while this runs.
  * 
  * @note Non-blocking - returns immediately even if transmission fails
  */
 void CAN_Driver_Transmit(void)
 {
-    CAN_Message_t msg;
+    CAN_Driver_MaskIrq();
+    CAN_Driver_RefillTx(&hfdcan1);
+    CAN_Driver_UnmaskIrq();
+}
+
+/**
+ * @brief Convert a payload length to the FDCAN DLC code
+ * 
+ * @param len Payload length in bytes (0-64)
+ * @return Smallest DLC code whose payload holds len bytes (15 above 48)
+ */
+uint8_t CAN_Driver_LenToDlc(uint8_t len)
+{
+    uint8_t dlc = 9u;
+    
+    if (len <= CAN_CLASSIC_MAX_DATA_LEN) {
+        return len;
+    }
+    
+    while (dlc < 15u && can_fd_dlc_len[dlc - 9u] < len) {
+        dlc++;
+    }
+    
+    return dlc;
+}
+
+/**
+ * @brief Convert an FDCAN DLC code to the payload length
+ * 
+ * @param dlc DLC code (only the low 4 bits are used)
+ * @return Payload length in bytes
+ */
+uint8_t CAN_Driver_DlcToLen(uint8_t dlc)
+{
+    dlc &= 0x0Fu;
     
-    /* Process all messages in TX buffer */
-    while (RingBuffer_Get(&can_tx_buffer, &msg, CAN_TX_BUFFER_SIZE)) {
+    return (dlc <= CAN_CLASSIC_MAX_DATA_LEN) ? dlc : can_fd_dlc_len[dlc - 9u];
+}
+
+/**
+ * @brief Move queued messages into the hardware TX FIFO (TX consumer)
+ * 
+ * The high-priority ring is checked before every hardware slot is filled,
+ * so a high-priority frame waits at most for the frames already in the
+ * 3-element hardware TX FIFO. Within a class messages are transmitted in
+ * FIFO order: a message stays at the head of its ring until the peripheral
+ * accepts it. Runs in FDCAN interrupt context, or from
+ * CAN_Driver_Transmit() with both FDCAN lines masked.
+ * 
+ * @param hfdcan Pointer to FDCAN handle
+ */
+static void CAN_Driver_RefillTx(FDCAN_HandleTypeDef *hfdcan)
+{
+    for (;;) {
+        CAN_RingBuffer_t *ring = &can_tx_high_buffer;
+        CAN_Message_t *msg = RingBuffer_Peek(ring);
         FDCAN_TxHeaderTypeDef tx_header;
         
+        /* Fall back to normal class only when no high-priority frame waits */
+        if (msg == NULL) {
+            ring = &can_tx_buffer;
+            msg = RingBuffer_Peek(ring);
+            if (msg == NULL) {
+                break;  /* Both TX rings empty */
+            }
+        }
+        
         /* Configure TX header */
-        tx_header.Identifier = msg.id;
-        tx_header.IdType = msg.is_extended ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID;
+        tx_header.Identifier = msg->id;
+        tx_header.IdType = msg->is_extended ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID;
         tx_header.TxFrameType = FDCAN_DATA_FRAME;
-        tx_header.DataLength = msg.len << 16; /* Convert DLC to FDCAN format */
+        tx_header.DataLength = (uint32_t)CAN_Driver_LenToDlc(msg->len) << 16; /* Convert DLC to FDCAN format */
         tx_header.ErrorStateIndicator = FDCAN_ESI_ACTIVE;
-        tx_header.BitRateSwitch = FDCAN_BRS_OFF;
-        tx_header.FDFormat = FDCAN_CLASSIC_CAN;
+        tx_header.BitRateSwitch = msg->is_fd ? FDCAN_BRS_ON : FDCAN_BRS_OFF;
+        tx_header.FDFormat = msg->is_fd ? FDCAN_FD_CAN : FDCAN_CLASSIC_CAN;
         tx_header.TxEventFifoControl = FDCAN_NO_TX_EVENTS;
         tx_header.MessageMarker = 0;
         
         /* Attempt transmission */
-        if (HAL_FDCAN_AddMessageToTxFifoQ(&hfdcan1, &tx_header, msg.data) != HAL_OK) {
-            /* TX FIFO full - put message back and retry later */
-            RingBuffer_Put(&can_tx_buffer, &msg, CAN_TX_BUFFER_SIZE);
+        if (HAL_FDCAN_AddMessageToTxFifoQ(hfdcan, &tx_header, msg->data) != HAL_OK) {
+            /* TX FIFO full - leave message at the head of the queue for the next TX complete */
             break;  /* Stop processing to avoid infinite loop */
         }
+        
+        /* Message accepted by hardware - release the slot */
+        RingBuffer_Advance(ring);
+        can_tx_frames++;
     }
 }
 
+/**
+ * @brief Keep the FDCAN interrupts out of a thread-side TX ring consumer
+ * 
+ * TX complete is routed to line 1, but HAL_FDCAN_IRQHandler() services
+ * every enabled flag whichever line fired, so an RX interrupt on line 0
+ * runs a pending TX-complete callback too. Both lines are masked.
+ */
+static void CAN_Driver_MaskIrq(void)
+{
+    HAL_NVIC_DisableIRQ(FDCAN1_IT0_IRQn);
+    HAL_NVIC_DisableIRQ(FDCAN1_IT1_IRQn);
+}
+
+/**
+ * @brief Unmask the FDCAN interrupts, pending ones run at once
+ */
+static void CAN_Driver_UnmaskIrq(void)
+{
+    HAL_NVIC_EnableIRQ(FDCAN1_IT0_IRQn);
+    HAL_NVIC_EnableIRQ(FDCAN1_IT1_IRQn);
+}
+
 /**
  * @brief Get a received CAN message from the queue
  * 
@@ -150,7 +590,28 @@ bool CAN_Driver_Get(CAN_Message_t *msg)
         return false;
     }
     
-    return RingBuffer_Get(&can_rx_buffer, msg, CAN_RX_BUFFER_SIZE);
+    return RingBuffer_Get(&can_rx_buffer, msg);
+}
+
+/**
+ * @brief Get pointer to the oldest received message without copying it
+ * 
+ * @return Pointer to RX ring slot, or NULL if no messages available
+ */
+const CAN_Message_t *CAN_Driver_RxPeek(void)
+{
+    return RingBuffer_Peek(&can_rx_buffer);
+}
+
+/**
+ * @brief Release the message returned by CAN_Driver_RxPeek()
+ */
+void CAN_Driver_RxRelease(void)
+{
+    /* Ignore release without a pending message */
+    if (!RingBuffer_IsEmpty(&can_rx_buffer)) {
+        RingBuffer_Advance(&can_rx_buffer);
+    }
 }
 
 /**
@@ -160,17 +621,17 @@ bool CAN_Driver_Get(CAN_Message_t *msg)
  */
 uint8_t CAN_Driver_GetRxCount(void)
 {
-    return RingBuffer_GetCount(&can_rx_buffer);
+    return (uint8_t)RingBuffer_GetCount(&can_rx_buffer);
 }
 
 /**
  * @brief Get number of messages waiting in TX buffer
  * 
- * @return Number of pending transmissions (0-CAN_TX_BUFFER_SIZE)
+ * @return Number of pending transmissions in both priority classes
  */
 uint8_t CAN_Driver_GetTxCount(void)
 {
-    return RingBuffer_GetCount(&can_tx_buffer);
+    return (uint8_t)(RingBuffer_GetCount(&can_tx_buffer) + RingBuffer_GetCount(&can_tx_high_buffer));
 }
 
 /**
@@ -187,26 +648,229 @@ bool CAN_Driver_HasMessage(void)
  * @brief Clear all pending TX messages
  * 
  * Useful for emergency stop or reset scenarios
+ * 
+ * @note Must be called from the main loop (both FDCAN lines are masked
+ *       while flushing, as the TX consumer can run from either)
  */
 void CAN_Driver_ClearTxBuffer(void)
 {
-    __disable_irq();
-    can_tx_buffer.head = 0;
-    can_tx_buffer.tail = 0;
-    can_tx_buffer.count = 0;
-    __enable_irq();
+    CAN_Driver_MaskIrq();
+    RingBuffer_Flush(&can_tx_buffer);
+    RingBuffer_Flush(&can_tx_high_buffer);
+    CAN_Driver_UnmaskIrq();
 }
 
 /**
  * @brief Clear all received messages
+ * 
+ * @note Must be called from the RX consumer context (main loop)
  */
 void CAN_Driver_ClearRxBuffer(void)
 {
-    __disable_irq();
-    can_rx_buffer.head = 0;
-    can_rx_buffer.tail = 0;
-    can_rx_buffer.count = 0;
-    __enable_irq();
+    RingBuffer_Flush(&can_rx_buffer);
+}
+
+/**
+ * @brief Get CAN driver queue statistics
+ * 
+ * Each counter is read atomically, but the snapshot as a whole is not:
+ * RX fields may advance between reads while the RX ISR is active.
+ * 
+ * @param stats Pointer to structure to fill
+ */
+void CAN_Driver_GetStats(CAN_Driver_Stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    
+    stats->rx_frames = can_rx_frames;
+    stats->rx_dropped = can_rx_buffer.dropped;
+    stats->tx_frames = can_tx_frames;
+    stats->tx_dropped = can_tx_buffer.dropped;
+    stats->tx_high_dropped = can_tx_high_buffer.dropped;
+    stats->rx_fifo_full_events = can_rx_fifo_full_events;
+    stats->rx_fifo_lost = can_rx_fifo_lost;
+    stats->rx_high_watermark = (uint16_t)can_rx_buffer.high_watermark;
+    stats->tx_high_watermark = (uint16_t)can_tx_buffer.high_watermark;
+    stats->tx_high_prio_watermark = (uint16_t)can_tx_high_buffer.high_watermark;
+    stats->rx_queue_size = CAN_RX_BUFFER_SIZE;
+    stats->tx_queue_size = CAN_TX_BUFFER_SIZE;
+    stats->tx_high_queue_size = CAN_TX_HIGH_BUFFER_SIZE;
+}
+
+/**
+ * @brief Get FDCAN error counters and bus-off state
+ * 
+ * @param status Pointer to structure to fill
+ * @return false if status is NULL or the registers could not be read
+ */
+bool CAN_Driver_GetBusStatus(CAN_Driver_BusStatus_t *status)
+{
+    FDCAN_ErrorCountersTypeDef counters;
+    FDCAN_ProtocolStatusTypeDef protocol;
+    
+    if (status == NULL) {
+        return false;
+    }
+    
+    if (HAL_FDCAN_GetErrorCounters(&hfdcan1, &counters) != HAL_OK ||
+        HAL_FDCAN_GetProtocolStatus(&hfdcan1, &protocol) != HAL_OK) {
+        return false;
+    }
+    
+    status->tx_error_count = (uint8_t)counters.TxErrorCnt;
+    status->rx_error_count = (uint8_t)counters.RxErrorCnt;
+    status->error_passive = (protocol.ErrorPassive != 0);
+    status->bus_off = (protocol.BusOff != 0);
+    status->bus_off_events = can_bus_off_events;
+    status->state = can_bus_state;
+    status->recoveries = can_recoveries;
+    status->last_recovery_ms = can_last_recovery_ms;
+    
+    return true;
+}
+
+/**
+ * @brief Track the bus state and rejoin after bus-off
+ */
+void CAN_Driver_Supervise(void)
+{
+    FDCAN_ErrorCountersTypeDef counters;
+    FDCAN_ProtocolStatusTypeDef protocol;
+    uint32_t now = HAL_GetTick();
+    
+    if (HAL_FDCAN_GetErrorCounters(&hfdcan1, &counters) != HAL_OK ||
+        HAL_FDCAN_GetProtocolStatus(&hfdcan1, &protocol) != HAL_OK) {
+        return;
+    }
+    
+    /* New bus-off: flagged by the error ISR, or seen in PSR if the interrupt
+     * was missed. PSR keeps BO set while recovering, so only the flag counts then. */
+    if (can_bus_off_pending ||
+        (protocol.BusOff != 0 && can_bus_state < CAN_BUS_STATE_RECOVERING)) {
+        can_bus_off_pending = false;
+        CAN_Driver_EnterBusOff(now);
+    }
+    
+    switch (can_bus_state) {
+        case CAN_BUS_STATE_BUS_OFF:
+            if ((int32_t)(now - can_restart_tick) >= 0 && CAN_Driver_Restart()) {
+                can_bus_state = CAN_BUS_STATE_RECOVERING;
+            }
+            break;
+        
+        case CAN_BUS_STATE_RECOVERING:
+            /* Hardware clears BO and the error counters once the recovery sequence is done */
+            if (protocol.BusOff == 0) {
+                can_recoveries++;
+                can_last_recovery_ms = now - can_bus_off_tick;
+                can_rejoin_tick = now;
+                can_bus_state = CAN_Driver_ErrorState(&counters, &protocol);
+                CAN_Driver_Transmit();
+            }
+            break;
+        
+        default:
+            can_bus_state = CAN_Driver_ErrorState(&counters, &protocol);
+            
+            /* Stable since the last rejoin - the next bus-off restarts at once again */
+            if (can_holdoff_ms > 0u && (now - can_rejoin_tick) >= CAN_RECOVERY_STABLE_MS) {
+                can_holdoff_ms = 0;
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Get the bus state of the last CAN_Driver_Supervise() call
+ */
+CAN_BusState_t CAN_Driver_GetBusState(void)
+{
+    return can_bus_state;
+}
+
+/**
+ * @brief Choose what happens to queued TX frames on rejoin after bus-off
+ */
+void CAN_Driver_SetRecoveryPolicy(CAN_RecoveryPolicy_t policy)
+{
+    can_recovery_policy = policy;
+}
+
+/* ============================================================================
+ * Bus Supervision Helpers
+ * ============================================================================ */
+
+/**
+ * @brief Classify the error state of a node that is on the bus
+ */
+static CAN_BusState_t CAN_Driver_ErrorState(const FDCAN_ErrorCountersTypeDef *counters,
+                                            const FDCAN_ProtocolStatusTypeDef *protocol)
+{
+    if (protocol->ErrorPassive != 0) {
+        return CAN_BUS_STATE_PASSIVE;
+    }
+    
+    if (protocol->Warning != 0 ||
+        counters->TxErrorCnt >= CAN_ERROR_WARNING_LIMIT ||
+        counters->RxErrorCnt >= CAN_ERROR_WARNING_LIMIT) {
+        return CAN_BUS_STATE_WARNING;
+    }
+    
+    return CAN_BUS_STATE_ACTIVE;
+}
+
+/**
+ * @brief Record a bus-off entry and schedule the restart
+ * 
+ * @param now HAL_GetTick() at detection
+ */
+static void CAN_Driver_EnterBusOff(uint32_t now)
+{
+    can_bus_state = CAN_BUS_STATE_BUS_OFF;
+    can_bus_off_tick = now;
+    can_restart_tick = now + can_holdoff_ms;
+    
+    /* A bus-off soon after this rejoin waits longer */
+    if (can_holdoff_ms == 0u) {
+        can_holdoff_ms = CAN_RECOVERY_HOLDOFF_MIN_MS;
+    } else if (can_holdoff_ms < CAN_RECOVERY_HOLDOFF_MAX_MS) {
+        can_holdoff_ms = (2u * can_holdoff_ms < CAN_RECOVERY_HOLDOFF_MAX_MS) ? 2u * can_holdoff_ms
+                                                                           : CAN_RECOVERY_HOLDOFF_MAX_MS;
+    }
+}
+
+/**
+ * @brief Apply the recovery policy and restart the peripheral after bus-off
+ * 
+ * Bus-off leaves the FDCAN in INIT with the HAL still BUSY: Stop brings
+ * the handle back to READY (filters and notifications are kept), Start
+ * clears INIT and the hardware begins the recovery sequence.
+ * 
+ * @return true if restarted, false to retry on the next call
+ */
+static bool CAN_Driver_Restart(void)
+{
+    /* TX consumer stays out (either line) while the rings and hardware FIFO are touched */
+    CAN_Driver_MaskIrq();
+    if (can_recovery_policy == CAN_RECOVERY_FLUSH_ALL) {
+        (void)HAL_FDCAN_AbortTxRequest(&hfdcan1, CAN_TX_BUFFERS_ALL);
+        RingBuffer_Flush(&can_tx_high_buffer);
+    }
+    if (can_recovery_policy != CAN_RECOVERY_KEEP_QUEUED) {
+        RingBuffer_Flush(&can_tx_buffer);
+    }
+    CAN_Driver_UnmaskIrq();
+    
+    if (HAL_FDCAN_Stop(&hfdcan1) != HAL_OK || HAL_FDCAN_Start(&hfdcan1) != HAL_OK) {
+        return false;
+    }
+    
+    /* Preload the hardware FIFO, frames leave as soon as the node rejoins */
+    CAN_Driver_Transmit();
+    
+    return true;
 }
 
 /* ============================================================================
@@ -214,42 +878,97 @@ void CAN_Driver_ClearRxBuffer(void)
  * ============================================================================ */
 
 /**
- * @brief Internal RX callback handler
+ * @brief Convert an FDCAN RX timestamp into GetCycles() time
+ * 
+ * The 16-bit timestamp counter wraps every 65536 bit times (131 ms at
+ * 500 kbit/s); frames are drained well within that.
+ * 
+ * @param hfdcan Pointer to FDCAN handle
+ * @param rx_timestamp RX header timestamp (counter value at frame start)
+ * @return Cycle count at frame start
+ */
+static uint32_t CAN_Driver_RxTimestampToCycles(FDCAN_HandleTypeDef *hfdcan, uint32_t rx_timestamp)
+{
+    uint16_t age = (uint16_t)(HAL_FDCAN_GetTimestampCounter(hfdcan) - (uint16_t)rx_timestamp);
+    
+    return GetCycles() - (uint32_t)age * can_cycles_per_bit;
+}
+
+/**
+ * @brief Drain all pending messages from one FDCAN RX FIFO
+ * 
+ * Reads the FIFO fill level and moves every pending element into the RX
+ * ring in a single pass, so a burst costs one interrupt entry instead of
+ * one per frame. Header fields are written straight into the reserved
+ * ring slot.
  * 
  * @param hfdcan Pointer to FDCAN handle
+ * @param fifo FDCAN_RX_FIFO0 or FDCAN_RX_FIFO1
  */
-static void CAN_Driver_RxCallback(FDCAN_HandleTypeDef *hfdcan)
+static void CAN_Driver_DrainRxFifo(FDCAN_HandleTypeDef *hfdcan, uint32_t fifo)
 {
     FDCAN_RxHeaderTypeDef rx_header;
-    uint8_t rx_data[8];
+    uint8_t rx_data[64];    /* HAL copies up to 64 bytes for DLC 9-15, even in classic mode */
+    uint32_t level;
     
-    /* Get message from FDCAN peripheral */
-    if (HAL_FDCAN_GetRxMessage(hfdcan, FDCAN_RX_FIFO0, &rx_header, rx_data) == HAL_OK) {
-        CAN_Message_t msg;
-        
-        /* Extract message information */
-        msg.id = rx_header.Identifier;
-        msg.is_extended = (rx_header.IdType == FDCAN_EXTENDED_ID);
-        msg.len = (uint8_t)(rx_header.DataLength >> 16); /* Extract DLC */
-        
-        /* Limit DLC to valid range */
-        if (msg.len > 8) {
-            msg.len = 8;
-        }
-        
-        /* Copy data */
-        memcpy(msg.data, rx_data, msg.len);
-        
-        /* Clear unused bytes */
-        if (msg.len < 8) {
-            memset(&msg.data[msg.len], 0, 8 - msg.len);
+    /* Re-read fill level after each batch: frames may arrive while draining */
+    while ((level = HAL_FDCAN_GetRxFifoFillLevel(hfdcan, fifo)) > 0) {
+        for (; level > 0; level--) {
+            CAN_Message_t *msg;
+            
+            /* Get message from FDCAN peripheral (always, to free the hardware element) */
+            if (HAL_FDCAN_GetRxMessage(hfdcan, fifo, &rx_header, rx_data) != HAL_OK) {
+                return;
+            }
+            
+            /* Reserve RX slot (if buffer full, message is dropped and counted) */
+            msg = RingBuffer_Reserve(&can_rx_buffer);
+            if (msg == NULL) {
+                continue;
+            }
+            
+            /* Extract message information */
+            msg->id = rx_header.Identifier;
+            msg->is_extended = (rx_header.IdType == FDCAN_EXTENDED_ID);
+            msg->filter_index = (rx_header.IsFilterMatchingFrame == 0u) ? (uint8_t)rx_header.FilterIndex
+                                                                        : CAN_FILTER_INDEX_NONE;
+            msg->is_fd = (rx_header.FDFormat == FDCAN_FD_CAN);
+            msg->len = CAN_Driver_DlcToLen((uint8_t)(rx_header.DataLength >> 16)); /* Extract DLC */
+            msg->rx_cycles = CAN_Driver_RxTimestampToCycles(hfdcan, rx_header.RxTimestamp);
+            
+            /* Limit length to slot size (classic DLC 9-15 still means 8 bytes) */
+            if (msg->len > (msg->is_fd ? CAN_MAX_DATA_LEN : CAN_CLASSIC_MAX_DATA_LEN)) {
+                msg->len = msg->is_fd ? CAN_MAX_DATA_LEN : CAN_CLASSIC_MAX_DATA_LEN;
+            }
+            
+            /* Copy data */
+            memcpy(msg->data, rx_data, msg->len);
+            
+            /* Clear unused bytes */
+            if (msg->len < CAN_MAX_DATA_LEN) {
+                memset(&msg->data[msg->len], 0, CAN_MAX_DATA_LEN - msg->len);
+            }
+            
+            RingBuffer_Commit(&can_rx_buffer);
+            can_rx_frames++;
         }
-        
-        /* Add to RX buffer (if buffer full, message is dropped) */
-        RingBuffer_Put(&can_rx_buffer, &msg, CAN_RX_BUFFER_SIZE);
     }
 }
 
+/**
+ * @brief Drain both RX FIFOs, priority FIFO 1 first
+ * 
+ * Called from both FIFO callbacks. The HAL services FIFO 0 and FIFO 1 in
+ * the same interrupt, so the second call normally finds both empty.
+ * 
+ * @param hfdcan Pointer to FDCAN handle
+ */
+static void CAN_Driver_RxCallback(FDCAN_HandleTypeDef *hfdcan)
+{
+    CAN_Driver_DrainRxFifo(hfdcan, FDCAN_RX_FIFO1);
+    CAN_Driver_DrainRxFifo(hfdcan, FDCAN_RX_FIFO0);
+}
+
 /**
  * @brief HAL FDCAN RX FIFO 0 callback
  * 
@@ -260,21 +979,85 @@ static void CAN_Driver_RxCallback(FDCAN_HandleTypeDef *hfdcan)
  */
 void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo0ITs)
 {
-    /* Check if new message interrupt */
-    if ((RxFifo0ITs & FDCAN_IT_RX_FIFO0_NEW_MESSAGE) != 0) {
+    PROFILE_START(PROFILE_FDCAN_RX_ISR);
+    
+    /* Check if new message or FIFO full - drain everything pending */
+    if ((RxFifo0ITs & (FDCAN_IT_RX_FIFO0_NEW_MESSAGE | FDCAN_IT_RX_FIFO0_FULL)) != 0) {
         CAN_Driver_RxCallback(hfdcan);
     }
     
     /* Check for FIFO full warning */
     if ((RxFifo0ITs & FDCAN_IT_RX_FIFO0_FULL) != 0) {
-        /* FIFO is full - messages may be lost */
-        /* Could set error flag here */
+        can_rx_fifo_full_events++;
     }
     
-    /* Check for message lost */
+    /* Check for message lost (frame arrived while hardware FIFO was full) */
     if ((RxFifo0ITs & FDCAN_IT_RX_FIFO0_MESSAGE_LOST) != 0) {
-        /* Messages were lost due to FIFO overflow */
-        /* Could increment error counter here */
+        can_rx_fifo_lost++;
+    }
+    
+    PROFILE_STOP(PROFILE_FDCAN_RX_ISR);
+}
+
+/**
+ * @brief HAL FDCAN TX buffer complete callback
+ * 
+ * Called by HAL (FDCAN1_IT1) when a frame has left the peripheral.
+ * Refills the freed hardware TX FIFO slot from the software queue.
+ * 
+ * @param hfdcan Pointer to FDCAN handle
+ * @param BufferIndexes Completed TX buffers
+ */
+void HAL_FDCAN_TxBufferCompleteCallback(FDCAN_HandleTypeDef *hfdcan, uint32_t BufferIndexes)
+{
+    (void)BufferIndexes;
+    
+    CAN_Driver_RefillTx(hfdcan);
+}
+
+/**
+ * @brief HAL FDCAN RX FIFO 1 callback
+ * 
+ * Called by HAL when new message arrives in RX FIFO 1 (priority frames)
+ * 
+ * @param hfdcan Pointer to FDCAN handle
+ * @param RxFifo1ITs Interrupt flags
+ */
+void HAL_FDCAN_RxFifo1Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo1ITs)
+{
+    /* Check if new message or FIFO full - drain everything pending */
+    if ((RxFifo1ITs & (FDCAN_IT_RX_FIFO1_NEW_MESSAGE | FDCAN_IT_RX_FIFO1_FULL)) != 0) {
+        CAN_Driver_RxCallback(hfdcan);
+    }
+    
+    /* Check for FIFO full warning */
+    if ((RxFifo1ITs & FDCAN_IT_RX_FIFO1_FULL) != 0) {
+        can_rx_fifo_full_events++;
+    }
+    
+    /* Check for message lost (frame arrived while hardware FIFO was full) */
+    if ((RxFifo1ITs & FDCAN_IT_RX_FIFO1_MESSAGE_LOST) != 0) {
+        can_rx_fifo_lost++;
+    }
+}
+
+/**
+ * @brief HAL FDCAN error status callback
+ * 
+ * Called by HAL (FDCAN1_IT0) on bus-off entry. Only flags the event; the
+ * restart needs HAL calls that wait on the peripheral, so it runs from
+ * CAN_Driver_Supervise() in the main loop.
+ * 
+ * @param hfdcan Pointer to FDCAN handle
+ * @param ErrorStatusITs Error status flags
+ */
+void HAL_FDCAN_ErrorStatusCallback(FDCAN_HandleTypeDef *hfdcan, uint32_t ErrorStatusITs)
+{
+    (void)hfdcan;
+    
+    if ((ErrorStatusITs & FDCAN_IT_BUS_OFF) != 0) {
+        can_bus_off_events++;
+        can_bus_off_pending = true;     /* Restart from CAN_Driver_Supervise() */
     }
 }
 
@@ -283,73 +1066,115 @@ void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo0ITs)
  * ============================================================================ */
 
 /**
- * @brief Add message to ring buffer
+ * @brief Get pointer to the next free slot (producer side)
+ * 
+ * The slot is not visible to the consumer until RingBuffer_Commit().
+ * Reserving again without a commit returns the same slot.
  * 
  * @param buffer Pointer to ring buffer
- * @param msg Pointer to message to add
- * @param buffer_size Maximum size of buffer
- * @return true if added successfully, false if buffer full
+ * @return Pointer to free slot, or NULL if buffer full (counted as dropped)
  */
-static bool RingBuffer_Put(CAN_RingBuffer_t *buffer, const CAN_Message_t *msg, uint8_t buffer_size)
+static CAN_Message_t *RingBuffer_Reserve(CAN_RingBuffer_t *buffer)
 {
+    uint32_t head = buffer->head;
+    
     /* Check if buffer is full */
-    if (RingBuffer_IsFull(buffer, buffer_size)) {
-        return false;
+    if (head - buffer->tail > buffer->mask) {
+        buffer->dropped++;
+        return NULL;
     }
     
-    /* Add message to buffer */
-    buffer->buffer[buffer->head] = *msg;
-    
-    /* Update head pointer with wrap-around */
-    buffer->head = (buffer->head + 1) % buffer_size;
+    return &buffer->buffer[head & buffer->mask];
+}
+
+/**
+ * @brief Publish the reserved slot to the consumer (producer side)
+ * 
+ * The slot is written before head is published, with a barrier in between,
+ * so the consumer never observes a partially written message.
+ * Updates the high-watermark statistic.
+ * 
+ * @param buffer Pointer to ring buffer
+ */
+static void RingBuffer_Commit(CAN_RingBuffer_t *buffer)
+{
+    uint32_t head = buffer->head;
+    uint32_t level = head - buffer->tail + 1u;
     
-    /* Increment count atomically */
-    __disable_irq();
-    buffer->count++;
-    __enable_irq();
+    /* Make the slot contents visible before publishing the new head */
+    __DMB();
+    buffer->head = head + 1u;
     
-    return true;
+    /* Track deepest fill level for queue sizing */
+    if (level > buffer->high_watermark) {
+        buffer->high_watermark = level;
+    }
 }
 
 /**
- * @brief Get message from ring buffer
+ * @brief Get message from ring buffer (consumer side)
  * 
  * @param buffer Pointer to ring buffer
  * @param msg Pointer to message structure to fill
- * @param buffer_size Maximum size of buffer
  * @return true if message retrieved, false if buffer empty
  */
-static bool RingBuffer_Get(CAN_RingBuffer_t *buffer, CAN_Message_t *msg, uint8_t buffer_size)
+static bool RingBuffer_Get(CAN_RingBuffer_t *buffer, CAN_Message_t *msg)
 {
+    const CAN_Message_t *slot = RingBuffer_Peek(buffer);
+    
     /* Check if buffer is empty */
-    if (RingBuffer_IsEmpty(buffer)) {
+    if (slot == NULL) {
         return false;
     }
     
     /* Get message from buffer */
-    *msg = buffer->buffer[buffer->tail];
-    
-    /* Update tail pointer with wrap-around */
-    buffer->tail = (buffer->tail + 1) % buffer_size;
+    *msg = *slot;
     
-    /* Decrement count atomically */
-    __disable_irq();
-    buffer->count--;
-    __enable_irq();
+    RingBuffer_Advance(buffer);
     
     return true;
 }
 
 /**
- * @brief Check if ring buffer is full
+ * @brief Get pointer to the oldest message without removing it (consumer side)
  * 
  * @param buffer Pointer to ring buffer
- * @param buffer_size Maximum size of buffer
- * @return true if full, false otherwise
+ * @return Pointer to oldest slot, or NULL if buffer empty
  */
-static bool RingBuffer_IsFull(const CAN_RingBuffer_t *buffer, uint8_t buffer_size)
+static CAN_Message_t *RingBuffer_Peek(CAN_RingBuffer_t *buffer)
 {
-    return (buffer->count >= buffer_size);
+    uint32_t tail = buffer->tail;
+    
+    if (buffer->head == tail) {
+        return NULL;
+    }
+    
+    /* Do not read slot contents before the head that published them */
+    __DMB();
+    
+    return &buffer->buffer[tail & buffer->mask];
+}
+
+/**
+ * @brief Release the oldest slot back to the producer (consumer side)
+ * 
+ * @param buffer Pointer to ring buffer
+ */
+static void RingBuffer_Advance(CAN_RingBuffer_t *buffer)
+{
+    /* Finish reading the slot before handing it back to the producer */
+    __DMB();
+    buffer->tail = buffer->tail + 1u;
+}
+
+/**
+ * @brief Discard all messages in ring buffer (consumer side)
+ * 
+ * @param buffer Pointer to ring buffer
+ */
+static void RingBuffer_Flush(CAN_RingBuffer_t *buffer)
+{
+    buffer->tail = buffer->head;
 }
 
 /**
@@ -360,23 +1185,20 @@ static bool RingBuffer_IsFull(const CAN_RingBuffer_t *buffer, uint8_t buffer_siz
  */
 static bool RingBuffer_IsEmpty(const CAN_RingBuffer_t *buffer)
 {
-    return (buffer->count == 0);
+    return (buffer->head == buffer->tail);
 }
 
 /**
  * @brief Get number of messages in buffer
  * 
+ * Single 32-bit reads of head and tail are atomic on Cortex-M, so no
+ * interrupt masking is needed. The result may be stale by one message
+ * if the other side is active, which is safe for both sides.
+ * 
  * @param buffer Pointer to ring buffer
- * @return Number of messages (0-buffer_size)
+ * @return Number of messages (0-buffer size)
  */
-static uint8_t RingBuffer_GetCount(const CAN_RingBuffer_t *buffer)
+static uint32_t RingBuffer_GetCount(const CAN_RingBuffer_t *buffer)
 {
-    uint8_t count;
-    
-    /* Read count atomically */
-    __disable_irq();
-    count = buffer->count;
-    __enable_irq();
-    
-    return count;
-}
\ No newline at end of file
+    return buffer->head - buffer->tail;
+}
@@ -4,3 +4,9 @@ uint32_t GetTick(void)
 {
     return HAL_GetTick();
 }
+
+void EnableCycleCounter(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
@@ -0,0 +1,242 @@
+/**
+ * @file control_loop.c
+ * @brief Fixed-rate real-time control loop on the TIM1 update interrupt
+ * 
+ * TIM1_UP_TIM16_IRQn runs at NVIC priority 4, above FDCAN (5) and the ADC
+ * DMA (6), so CAN traffic cannot delay the control tasks.
+ */
+
+#include <string.h>
+#include "common.h"
+#include "control_loop.h"
+#include "left_break.h"
+#include "trace.h"
+#include "scheduler.h"
+#include "profile.h"
+
+/* ============================================================================
+ * Private Types
+ * ============================================================================ */
+
+typedef void (*ControlLoop_TaskFn_t)(void);
+
+/* ============================================================================
+ * Private Variables
+ * ============================================================================ */
+
+/* Task functions, indexed by ControlLoop_Task_t */
+static const ControlLoop_TaskFn_t control_tasks[CONTROL_TASK_COUNT] = {
+    [CONTROL_TASK_POSITION] = Brake_UpdatePosition,
+    [CONTROL_TASK_STATE_MACHINE] = Brake_Update,
+    [CONTROL_TASK_TRACE] = Trace_Sample,
+};
+
+static volatile uint32_t control_tick = 0;
+static volatile bool control_running = false;
+
+/* Timing, written only from the control interrupt */
+static ControlLoop_TaskStats_t task_stats[CONTROL_TASK_COUNT];
+static uint32_t task_last_start[CONTROL_TASK_COUNT];
+
+#if PROFILING_ENABLED
+/* Previous TIM1 update event in DWT cycles and its tick, 0 if none */
+static uint32_t latency_last_event = 0;
+static uint32_t latency_last_tick = 0;
+#endif
+
+/* ============================================================================
+ * Private Functions
+ * ============================================================================ */
+
+/**
+ * @brief Record one task run
+ * 
+ * @param task Task index
+ * @param start DWT cycle count at task start
+ * @param end DWT cycle count at task end
+ */
+static void ControlLoop_Record(uint32_t task, uint32_t start, uint32_t end)
+{
+    ControlLoop_TaskStats_t *s = &task_stats[task];
+    uint32_t nominal = SystemCoreClock / CONTROL_TICK_HZ;
+    uint32_t exec = end - start;
+    
+    if (s->runs > 0) {
+        uint32_t period = start - task_last_start[task];
+        uint32_t jitter = (period > nominal) ? (period - nominal) : (nominal - period);
+        
+        s->last_period = period;
+        if (period < s->min_period) {
+            s->min_period = period;
+        }
+        if (period > s->max_period) {
+            s->max_period = period;
+        }
+        if (jitter > s->max_jitter) {
+            s->max_jitter = jitter;
+        }
+    }
+    
+    if (exec > s->max_exec) {
+        s->max_exec = exec;
+    }
+    
+    task_last_start[task] = start;
+    s->runs++;
+}
+
+/**
+ * @brief Record delay from the TIM1 update event to the control callback
+ * 
+ * TIM1 counts CPU cycles (prescaler 0, same clock as the core) and
+ * restarts from 0 at the update event, so its counter is the latency.
+ * The counter also restarts every PWM period, PWM_CYCLES_PER_CONTROL_TICK
+ * times per update: a callback one period late or more is told apart by
+ * the previous update event plus one tick and recorded as one full PWM
+ * period. Split by whether the core slept through the event, to show the
+ * cost of waking up.
+ * 
+ * @param counter TIM1 counter at callback entry
+ */
+static void ControlLoop_RecordLatency(uint32_t counter)
+{
+#if PROFILING_ENABLED
+    uint32_t pwm_period = SystemCoreClock / PWM_FREQUENCY_HZ;
+    uint32_t now = GetCycles();
+    uint32_t event = now - counter;
+    uint32_t latency = counter;
+    uint32_t wake;
+    
+    if (latency_last_tick != 0u && latency_last_tick == control_tick - 1u) {
+        uint32_t expected = latency_last_event + (SystemCoreClock / CONTROL_TICK_HZ);
+    
+        /* Counter wrapped: saturate */
+        if ((int32_t)(now - expected) >= (int32_t)pwm_period) {
+            event = expected;
+            latency = pwm_period;
+        }
+    }
+    latency_last_event = event;
+    latency_last_tick = control_tick;
+    
+    if (Scheduler_GetWakeCycle(&wake) && (int32_t)(wake - event) >= 0) {
+        Profile_Record(PROFILE_TICK_WAKE, latency);
+    } else {
+        Profile_Record(PROFILE_TICK_ACTIVE, latency);
+    }
+#else
+    (void)counter;
+#endif
+}
+
+/* ============================================================================
+ * Public Functions
+ * ============================================================================ */
+
+/**
+ * @brief Start running control tasks from the TIM1 update interrupt
+ */
+void ControlLoop_Start(void)
+{
+    /* DWT cycle counter for task timing */
+    EnableCycleCounter();
+    
+    ControlLoop_ResetStats();
+    control_running = true;
+}
+
+/**
+ * @brief Number of control ticks since TIM1 start
+ */
+uint32_t GetControlTick(void)
+{
+    return control_tick;
+}
+
+/**
+ * @brief Number of completed PWM cycles since TIM1 start
+ */
+uint32_t GetPwmCycle(void)
+{
+    return control_tick * PWM_CYCLES_PER_CONTROL_TICK;
+}
+
+/**
+ * @brief Mask the control interrupt
+ */
+void ControlLoop_Lock(void)
+{
+    HAL_NVIC_DisableIRQ(TIM1_UP_TIM16_IRQn);
+    __DSB();
+    __ISB();
+}
+
+/**
+ * @brief Unmask the control interrupt
+ */
+void ControlLoop_Unlock(void)
+{
+    HAL_NVIC_EnableIRQ(TIM1_UP_TIM16_IRQn);
+}
+
+/**
+ * @brief Get timing statistics of a control task
+ */
+bool ControlLoop_GetTaskStats(ControlLoop_Task_t task, ControlLoop_TaskStats_t *stats)
+{
+    if (task >= CONTROL_TASK_COUNT || stats == NULL) {
+        return false;
+    }
+    
+    ControlLoop_Lock();
+    *stats = task_stats[task];
+    ControlLoop_Unlock();
+    
+    return true;
+}
+
+/**
+ * @brief Clear timing statistics of all control tasks
+ */
+void ControlLoop_ResetStats(void)
+{
+    ControlLoop_Lock();
+    memset(task_stats, 0, sizeof(task_stats));
+    for (uint32_t i = 0; i < CONTROL_TASK_COUNT; i++) {
+        task_stats[i].min_period = UINT32_MAX;
+    }
+    ControlLoop_Unlock();
+}
+
+/* ============================================================================
+ * Interrupt Callbacks
+ * ============================================================================ */
+
+/**
+ * @brief TIM period elapsed callback (HAL weak override)
+ * 
+ * TIM1 update happens once per PWM_CYCLES_PER_CONTROL_TICK PWM periods.
+ */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    uint32_t counter;
+    
+    if (htim->Instance != TIM1) {
+        return;
+    }
+    counter = __HAL_TIM_GET_COUNTER(htim);
+    
+    control_tick++;
+    
+    if (!control_running) {
+        return;
+    }
+    
+    ControlLoop_RecordLatency(counter);
+    
+    for (uint32_t i = 0; i < CONTROL_TASK_COUNT; i++) {
+        uint32_t start = GetCycles();
+        control_tasks[i]();
+        ControlLoop_Record(i, start, GetCycles());
+    }
+}
@@ -7,12 +7,21 @@
  * - Periodic message transmission
  * - Status LED indication
  * - System health monitoring
+ * - Runtime configuration (node ID, cycle times, watchdog) kept in flash
  */
 
+#include <string.h>
 #include "common.h"
+#include "controller.h"
 #include "can.h"
 #include "left_break.h"
 #include "automate.h"
+#include "automate_int.h"
+#include "automate_codec.h"
+#include "scheduler.h"
+#include "storage.h"
+#include "profile.h"
+#include "trace.h"
 #include "main.h"
 
 /* ============================================================================
@@ -23,28 +32,115 @@
 #define NODE_ID_MCU                     0xF0    /* MCU identifier */
 #define NODE_ID_PC                      0x10    /* PC identifier */
 
+/* Defaults of Controller_Config_t, MCU_Config_CMD changes them at runtime */
 #define HEARTBEAT_INTERVAL_MS           AUTOMATE_HEART_BEAT_MSG_CYCLE_TIME_MS    /* 50 ms */
 #define TELEMETRY_INTERVAL_MS           AUTOMATE_LEFT_BRAKE_CMD_CYCLE_TIME_MS   /* 100 ms */
-#define STATUS_LED_BLINK_PERIOD_MS      500     /* 500 ms for blinking */
 #define WATCHDOG_TIMEOUT_MS             200     /* PC heartbeat timeout (4 missed heartbeats @ 50ms) */
 
+#define STATUS_LED_BLINK_PERIOD_MS      500     /* 500 ms for blinking */
+#define HEALTH_INIT_TIME_MS             1000    /* INIT after a boot that calibrated the ADC */
+#define HEALTH_INIT_RESTORED_MS         100     /* INIT after a boot from stored calibration */
+#define CAN_REJOIN_WARNING_MS           1000    /* WARNING held after a rejoin from bus-off */
+
+/* Background task schedule. Phases keep tasks out of each other's
+ * millisecond: heartbeat at 0 mod 50, telemetry at 25 mod 50, health at
+ * 7 mod 10, CAN TX kick at 3 mod 10, CAN bus supervision at 8 mod 10,
+ * LED at 11 mod 25, diagnostics at 19 mod 50. */
+#define TELEMETRY_PHASE_MS              (HEARTBEAT_INTERVAL_MS / 2)
+#define HEALTH_INTERVAL_MS              10
+#define HEALTH_PHASE_MS                 7
+#define CAN_TX_KICK_INTERVAL_MS         10
+#define CAN_TX_KICK_PHASE_MS            3
+#define CAN_SUPERVISE_INTERVAL_MS       10      /* Bounds bus-off detection to rejoin start */
+#define CAN_SUPERVISE_PHASE_MS          8
+#define STATUS_LED_INTERVAL_MS          25
+#define STATUS_LED_PHASE_MS             11
+#define PROFILE_EXPORT_INTERVAL_MS      1000
+#define PROFILE_EXPORT_PHASE_MS         41
+#define DIAG_PHASE_MS                   19
+#define TRACE_STREAM_INTERVAL_MS        2       /* <= 500 trace frames/s, ~15% of 500 kbit/s */
+#define TRACE_STREAM_PHASE_MS           1
+#define CALIBRATION_SAVE_INTERVAL_MS    60000   /* At most one storage record a minute */
+#define CALIBRATION_SAVE_PHASE_MS       33
+#define POWER_MODE_INTERVAL_MS          10
+#define POWER_MODE_PHASE_MS             5
+#define CONFIG_SAVE_INTERVAL_MS         1000    /* Flash write follows MCU_Config_CMD within a second */
+#define CONFIG_SAVE_PHASE_MS            46
+
+#define HANDLER_SLOT_NONE               0xFFu   /* Dispatch slot without handler */
+
+/* ============================================================================
+ * Private Types
+ * ============================================================================ */
+
+/**
+ * @brief Registered RX frame handler (one hardware filter element each)
+ */
+typedef struct {
+    uint32_t frame_id;                      /* CAN identifier */
+    Controller_UnpackFn_t unpack_fn;        /* Payload -> message struct */
+    Controller_HandlerFn_t handler_fn;      /* Called with unpacked struct */
+    bool is_extended;                       /* 29-bit identifier */
+    bool high_priority;                     /* Routed to RX FIFO 1 */
+} Controller_Handler_t;
+
+/**
+ * @brief Storage for one unpacked message of any registered type
+ */
+typedef union {
+    uint8_t bytes[CONTROLLER_MSG_MAX_SIZE];
+    uint32_t align_u32;
+    struct automate_heart_beat_msg_t heart_beat;
+    struct automate_left_brake_cmd_t left_brake_cmd;
+    struct automate_mcu_config_cmd_t mcu_config_cmd;
+    uint8_t trace_command;
+} Controller_MsgBuffer_t;
+
+_Static_assert(sizeof(Controller_MsgBuffer_t) == CONTROLLER_MSG_MAX_SIZE,
+               "Unpacked protocol struct exceeds CONTROLLER_MSG_MAX_SIZE");
+_Static_assert(sizeof(Controller_Config_t) <= STORAGE_DATA_MAX,
+               "Controller_Config_t does not fit one storage record");
+
 /* ============================================================================
  * Private Variables
  * ============================================================================ */
 
+/* RX dispatch table: entry i owns the i-th standard or extended filter element,
+ * so only frames the controller handles reach the RX ring */
+static Controller_Handler_t handlers[CONTROLLER_MAX_HANDLERS];
+static uint8_t handler_count = 0;
+
+/* Hardware filter index -> handler slot, per identifier type */
+static uint8_t ext_dispatch[CONTROLLER_MAX_HANDLERS];
+static uint8_t std_dispatch[CONTROLLER_MAX_HANDLERS];
+static uint8_t ext_filter_count = 0;
+static uint8_t std_filter_count = 0;
+
+/* Runtime configuration, and whether it still has to be written to flash */
+static const Controller_Config_t config_defaults = {
+    HEARTBEAT_INTERVAL_MS, TELEMETRY_INTERVAL_MS, WATCHDOG_TIMEOUT_MS, NODE_ID_MCU, 0
+};
+static Controller_Config_t config;
+static bool config_unsaved = false;
+
 /* Controller state - MCU node */
-static uint8_t node_id = NODE_ID_MCU;                   /* MCU identifier (0xF0) */
 static uint32_t heartbeat_msg_count = 0;                /* MCU heartbeat counter */
 static uint8_t node_health = AUTOMATE_HEART_BEAT_MSG_HEALTH_INIT_CHOICE;
 
 /* Timing tracking */
-static uint32_t last_heartbeat_tick = 0;                /* Last MCU heartbeat sent */
-static uint32_t last_telemetry_tick = 0;                /* Last telemetry sent */
 static uint32_t last_pc_heartbeat_tick = 0;             /* Last PC heartbeat received */
 static uint32_t last_led_toggle_tick = 0;
 
-/* Message ID counter for telemetry */
-static uint8_t telemetry_msg_id = 0;                    /* Left_Brake_MSG counter */
+/* Message ID counter for telemetry, per brake instance */
+static uint8_t telemetry_msg_id[BRAKE_COUNT];           /* Left/Right_Brake_MSG counters */
+
+/* Frame being dispatched: identifier and reception time (FDCAN RX timestamp) */
+static uint32_t dispatch_frame_id = 0;
+static uint32_t dispatch_rx_cycles = 0;
+
+/* On-change telemetry: state in the last frame sent, and time of last attempt */
+static BrakeState_t telemetry_state[BRAKE_COUNT];
+static uint32_t last_telemetry_tick[BRAKE_COUNT];
 
 /* LED blink state */
 static bool led_state = false;
@@ -53,15 +149,80 @@ static bool led_state = false;
 static uint32_t pc_heartbeat_msg_count = 0;             /* Last received PC MSG_Count */
 static bool pc_heartbeat_received = false;               /* Flag: at least one PC heartbeat received */
 
+/* CAN bus-off rejoins seen by the health task */
+static uint32_t can_recoveries_seen = 0;
+static uint32_t last_can_rejoin_tick = 0;
+
 /* ============================================================================
  * Private Function Prototypes
  * ============================================================================ */
 
 static void SendHeartbeat(void);
+static void SendBrakeTelemetry(uint8_t index);
 static void SendTelemetry(void);
+static void SendTelemetryOnChange(void);
+static BrakeState_t AggregateBrakeState(void);
+static bool AnyBrakeError(void);
+static bool AnyBrakeMoving(void);
+static bool CanBusDegraded(uint32_t now);
 static void ProcessReceivedMessage(void);
+static void HandleHeartbeat(const void *msg);
+static void HandleBrakeCommand(const void *msg);
+static void HandleTraceCommand(const void *msg);
+static void HandleConfigCommand(const void *msg);
+static int UnpackHeartbeat(void *dst, const uint8_t *src, size_t size);
+static int UnpackBrakeCommand(void *dst, const uint8_t *src, size_t size);
+static int UnpackTraceCommand(void *dst, const uint8_t *src, size_t size);
+static int UnpackConfigCommand(void *dst, const uint8_t *src, size_t size);
+static const Controller_Handler_t *FindHandler(const CAN_Message_t *msg);
+static bool ApplyFilters(void);
 static void UpdateSystemHealth(void);
 static void UpdateStatusLED(void);
+static void SaveCalibration(void);
+static bool IsConfigValid(const Controller_Config_t *cfg);
+static uint8_t FindTask(void (*fn)(void));
+static void ApplyCycleTimes(void);
+static void RestoreConfig(void);
+static void SaveConfig(void);
+#if LOW_POWER_IDLE_ENABLED
+static void UpdatePowerMode(void);
+#endif
+#if CONTROLLER_DIAG_INTERVAL_MS > 0
+static void SendDiagnostics(void);
+#endif
+#if PROFILING_ENABLED
+static void ExportProfile(void);
+#endif
+
+/* Background tasks run by Business_Loop(), see scheduler.h */
+static const Scheduler_Task_t controller_tasks[] = {
+    /* name         fn                      period                   offset                                         deadline */
+    { "can_rx",     ProcessReceivedMessage, 0,                       0,                                             0 },
+    { "telem_evt",  SendTelemetryOnChange,  0,                       0,                                             0 },
+    { "can_tx",     CAN_Driver_Transmit,    CAN_TX_KICK_INTERVAL_MS, CAN_TX_KICK_PHASE_MS,                          5 },
+    { "can_bus",    CAN_Driver_Supervise,   CAN_SUPERVISE_INTERVAL_MS, CAN_SUPERVISE_PHASE_MS,                      5 },
+    { "heartbeat",  SendHeartbeat,          HEARTBEAT_INTERVAL_MS,   HEARTBEAT_INTERVAL_MS,                         5 },
+    { "telemetry",  SendTelemetry,          TELEMETRY_INTERVAL_MS,   TELEMETRY_INTERVAL_MS + TELEMETRY_PHASE_MS,    10 },
+    { "health",     UpdateSystemHealth,     HEALTH_INTERVAL_MS,      HEALTH_PHASE_MS,                               10 },
+    { "led",        UpdateStatusLED,        STATUS_LED_INTERVAL_MS,  STATUS_LED_PHASE_MS,                           25 },
+    { "trace",      Trace_Stream,           TRACE_STREAM_INTERVAL_MS, TRACE_STREAM_PHASE_MS,                        10 },
+    { "calib",      SaveCalibration,        CALIBRATION_SAVE_INTERVAL_MS, CALIBRATION_SAVE_PHASE_MS,                1000 },
+    { "config",     SaveConfig,             CONFIG_SAVE_INTERVAL_MS, CONFIG_SAVE_PHASE_MS,                          1000 },
+#if LOW_POWER_IDLE_ENABLED
+    { "power",      UpdatePowerMode,        POWER_MODE_INTERVAL_MS,  POWER_MODE_PHASE_MS,                           10 },
+#endif
+#if CONTROLLER_DIAG_INTERVAL_MS > 0
+    { "diag",       SendDiagnostics,        CONTROLLER_DIAG_INTERVAL_MS, DIAG_PHASE_MS,                             100 },
+#endif
+#if PROFILING_ENABLED
+    { "profile",    ExportProfile,          PROFILE_EXPORT_INTERVAL_MS, PROFILE_EXPORT_PHASE_MS,                    100 },
+#endif
+};
+
+#define CONTROLLER_TASK_COUNT           ((uint8_t)(sizeof(controller_tasks) / sizeof(controller_tasks[0])))
+
+_Static_assert(sizeof(controller_tasks) / sizeof(controller_tasks[0]) <= SCHEDULER_MAX_TASKS,
+               "Controller task table exceeds SCHEDULER_MAX_TASKS");
 
 /* ============================================================================
  * Private Functions
@@ -71,40 +232,53 @@ static void UpdateStatusLED(void);
  * @brief Send heartbeat message
  * 
  * Transmits periodic MCU heartbeat with:
- * - Node ID: 0xF0 (MCU identifier)
+ * - Node ID: from the runtime configuration (0xF0 by default)
  * - Message counter (incrementing for each heartbeat)
  * - Health status (current MCU state)
  * - Timestamp (MCU system time in milliseconds)
  * 
  * This signals to PC that MCU is active and operational.
+ * Packed directly into the TX ring slot (no intermediate buffer).
  */
 static void SendHeartbeat(void)
 {
     struct automate_heart_beat_msg_t hb_msg;
-    uint8_t tx_data[8];
+    CAN_Message_t *slot;
+    
+    /* PC watchdogs this frame, never queue it behind telemetry */
+    slot = CAN_Driver_TxReserve(CAN_TX_PRIORITY_HIGH);
+    if (slot == NULL) {
+        return;  /* TX queue full - counted in driver statistics */
+    }
     
     /* Initialize message structure to zeros */
     automate_heart_beat_msg_init(&hb_msg);
     
     /* Fill MCU heartbeat data */
-    hb_msg.node_id = NODE_ID_MCU;                        /* 0xF0 - MCU identifier */
+    hb_msg.node_id = config.node_id;                     /* 0xF0 unless reconfigured */
     hb_msg.msg_count = heartbeat_msg_count++;            /* Increment MCU heartbeat counter */
-    hb_msg.health = node_health;                         /* Current MCU health status */
+    hb_msg.health = automate_int_heart_beat_msg_health_encode(node_health); /* Current MCU health status */
     hb_msg.stamp = (uint16_t)(HAL_GetTick() & 0xFFFF);  /* MCU timestamp */
     
-    /* Pack message into byte array */
-    int packed_len = automate_heart_beat_msg_pack(tx_data, &hb_msg, sizeof(tx_data));
+    /* Pack message into ring slot */
+    PROFILE_START(PROFILE_PACK);
+    int packed_len = automate_codec_heart_beat_msg_pack(slot->data, &hb_msg, sizeof(slot->data));
+    PROFILE_STOP(PROFILE_PACK);
     
     /* Send if packing successful */
     if (packed_len > 0) {
-        CAN_Driver_Send(AUTOMATE_HEART_BEAT_MSG_FRAME_ID, tx_data, (uint8_t)packed_len);
+        slot->id = AUTOMATE_HEART_BEAT_MSG_FRAME_ID;
+        slot->len = (uint8_t)packed_len;
+        slot->is_extended = AUTOMATE_HEART_BEAT_MSG_IS_EXTENDED;
+        CAN_Driver_TxCommit(CAN_TX_PRIORITY_HIGH);
     }
 }
 
 /**
- * @brief Send brake telemetry message
+ * @brief Send telemetry message of one brake instance
  * 
- * Transmits current brake actuator state to PC:
+ * Transmits current brake actuator state to PC on the instance's
+ * msg_frame_id (Left_Brake_MSG / Right_Brake_MSG, same layout):
  * - Message ID counter (incrementing for each telemetry message)
  * - MCU timestamp
  * - Current operation state flags:
@@ -113,115 +287,601 @@ static void SendHeartbeat(void)
  *   * Brake_Pushing: MCU is pushing brake
  *   * Brake_Pushed: Brake is fully pushed
  * - Time_to_end_operation: Estimated time until operation completes
+ * - Cmd_MSG_Id: MSG_Id of the last command that started an operation
+ * - Cmd_Latency: its reception -> first motor drive time (0.1 ms, 255 = pending)
  * 
- * PC uses this data to monitor command execution.
+ * PC uses this data to monitor command execution. With Cmd_MSG_Id the
+ * on-change frame reaching PUSHED/RELEASED also marks end-to-end completion.
+ * Sent as high priority while the brake reports an error (fault frame).
+ * Packed directly into the TX ring slot (no intermediate buffer).
  */
-static void SendTelemetry(void)
+static void SendBrakeTelemetry(uint8_t index)
 {
+    const Brake_t *brake = Brake_Get(index);
     struct automate_left_brake_msg_t brake_msg;
-    uint8_t tx_data[8];
+    CAN_TxPriority_t priority = Brake_HasError(brake) ? CAN_TX_PRIORITY_HIGH : CAN_TX_PRIORITY_NORMAL;
+    BrakeState_t state = Brake_GetState(brake); /* One snapshot, control ISR may change it */
+    Brake_CommandTiming_t cmd_timing;
+    CAN_Message_t *slot;
+    
+    last_telemetry_tick[index] = HAL_GetTick();
+    
+    slot = CAN_Driver_TxReserve(priority);
+    if (slot == NULL) {
+        return;  /* TX queue full - counted in driver statistics */
+    }
     
     /* Initialize message structure to zeros */
     automate_left_brake_msg_init(&brake_msg);
     
     /* Fill telemetry data */
-    brake_msg.msg_id = telemetry_msg_id++;               /* Increment telemetry counter */
+    brake_msg.msg_id = telemetry_msg_id[index]++;        /* Increment telemetry counter */
     brake_msg.stamp = (uint16_t)(HAL_GetTick() & 0xFFFF); /* MCU timestamp */
     
     /* Set state flags based on current brake state */
-    brake_msg.brake_releasing = (app_state.state == BRAKE_STATE_RELEASING) ? 1 : 0;
-    brake_msg.brake_released = (app_state.state == BRAKE_STATE_RELEASED) ? 1 : 0;
-    brake_msg.brake_pushing = (app_state.state == BRAKE_STATE_PUSHING) ? 1 : 0;
-    brake_msg.brake_pushed = (app_state.state == BRAKE_STATE_PUSHED) ? 1 : 0;
+    brake_msg.brake_releasing = (state == BRAKE_STATE_RELEASING) ? 1 : 0;
+    brake_msg.brake_released = (state == BRAKE_STATE_RELEASED) ? 1 : 0;
+    brake_msg.brake_pushing = (state == BRAKE_STATE_PUSHING) ? 1 : 0;
+    brake_msg.brake_pushed = (state == BRAKE_STATE_PUSHED) ? 1 : 0;
     
     /* Get estimated time to end of operation from brake module */
-    brake_msg.time_to_end_operation = Brake_GetTimeToEnd();
+    brake_msg.time_to_end_operation = automate_int_left_brake_msg_time_to_end_operation_encode(Brake_GetTimeToEnd(brake));
     
-    /* Pack message into byte array */
-    int packed_len = automate_left_brake_msg_pack(tx_data, &brake_msg, sizeof(tx_data));
+    /* Echo the tracked command and its actuation latency */
+    Brake_GetCommandTiming(brake, &cmd_timing);
+    brake_msg.cmd_msg_id = cmd_timing.msg_id;
+    brake_msg.cmd_latency = cmd_timing.actuated
+                          ? automate_int_left_brake_msg_cmd_latency_encode((int32_t)cmd_timing.actuation_us)
+                          : AUTOMATE_LEFT_BRAKE_MSG_CMD_LATENCY_PENDING_CHOICE;
+    
+    /* Pack message into ring slot */
+    PROFILE_START(PROFILE_PACK);
+    int packed_len = automate_codec_left_brake_msg_pack(slot->data, &brake_msg, sizeof(slot->data));
+    PROFILE_STOP(PROFILE_PACK);
     
     /* Send if packing successful */
     if (packed_len > 0) {
-        CAN_Driver_Send(AUTOMATE_LEFT_BRAKE_MSG_FRAME_ID, tx_data, (uint8_t)packed_len);
+        slot->id = Brake_GetConfig(brake)->msg_frame_id;
+        slot->len = (uint8_t)packed_len;
+        slot->is_extended = AUTOMATE_LEFT_BRAKE_MSG_IS_EXTENDED;
+        CAN_Driver_TxCommit(priority);
+        telemetry_state[index] = state;
+    }
+}
+
+/**
+ * @brief Send telemetry of every brake instance
+ */
+static void SendTelemetry(void)
+{
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        SendBrakeTelemetry(i);
+    }
+}
+
+/**
+ * @brief Send brake telemetry as soon as a brake state changes
+ * 
+ * Polled on every scheduler pass, so a transition set by the control
+ * interrupt is reported within one control tick instead of waiting for
+ * the next periodic frame. Frames of one instance are spaced at least
+ * CONTROLLER_TELEMETRY_MIN_GAP_MS apart; a change inside the gap is sent
+ * when the gap ends, unless a periodic frame has reported it meanwhile.
+ */
+static void SendTelemetryOnChange(void)
+{
+    uint32_t now = HAL_GetTick();
+    
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        if (Brake_GetState(Brake_Get(i)) == telemetry_state[i]) {
+            continue;
+        }
+        
+        if (now - last_telemetry_tick[i] < CONTROLLER_TELEMETRY_MIN_GAP_MS) {
+            continue;
+        }
+        
+        SendBrakeTelemetry(i);
+    }
+}
+
+/**
+ * @brief Combine brake states for the status LED
+ * 
+ * STOPPED if any instance is stopped, else moving if any instance moves,
+ * else PUSHED only when every instance is pushed.
+ * 
+ * @return Aggregated state
+ */
+static BrakeState_t AggregateBrakeState(void)
+{
+    bool moving = false;
+    bool all_pushed = true;
+    
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        BrakeState_t state = Brake_GetState(Brake_Get(i));
+        
+        if (state == BRAKE_STATE_STOPPED) {
+            return BRAKE_STATE_STOPPED;
+        }
+        if (state == BRAKE_STATE_PUSHING || state == BRAKE_STATE_RELEASING) {
+            moving = true;
+        }
+        if (state != BRAKE_STATE_PUSHED) {
+            all_pushed = false;
+        }
+    }
+    
+    if (moving) {
+        return BRAKE_STATE_PUSHING;
+    }
+    
+    return all_pushed ? BRAKE_STATE_PUSHED : BRAKE_STATE_RELEASED;
+}
+
+/**
+ * @brief Check all brake instances for errors
+ * 
+ * @return true if any instance reports an error
+ */
+static bool AnyBrakeError(void)
+{
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        if (Brake_HasError(Brake_Get(i))) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Check whether any brake instance is pushing or releasing
+ */
+static bool AnyBrakeMoving(void)
+{
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        BrakeState_t state = Brake_GetState(Brake_Get(i));
+        
+        if (state == BRAKE_STATE_PUSHING || state == BRAKE_STATE_RELEASING) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Check whether the CAN link is impaired
+ * 
+ * True while the node is error passive, off the bus or rejoining, and for
+ * CAN_REJOIN_WARNING_MS after a rejoin from bus-off, so the heartbeats
+ * right after the disturbance still report it to the PC.
+ * 
+ * @param now HAL_GetTick()
+ */
+static bool CanBusDegraded(uint32_t now)
+{
+    CAN_Driver_BusStatus_t status;
+    
+    if (!CAN_Driver_GetBusStatus(&status)) {
+        return false;
+    }
+    
+    if (status.recoveries != can_recoveries_seen) {
+        can_recoveries_seen = status.recoveries;
+        last_can_rejoin_tick = now;
+    }
+    
+    return status.state >= CAN_BUS_STATE_PASSIVE ||
+           (status.recoveries > 0u && (now - last_can_rejoin_tick) < CAN_REJOIN_WARNING_MS);
+}
+
+#if CONTROLLER_DIAG_INTERVAL_MS > 0
+/**
+ * @brief Send diagnostics message
+ * 
+ * Transmits MCU_Diag_MSG with:
+ * - Rx_Frames / Tx_Frames: CAN driver frame counters (12-bit, wrapping)
+ * - Ring_Drops: software ring and hardware FIFO losses (8-bit, wrapping)
+ * - TEC / REC / Bus_Off: FDCAN error counters and protocol status
+ * - Bus_Off_Count: bus-off entries (4-bit, wrapping)
+ * - Loop_Overruns: scheduler deadline misses and skips (4-bit, wrapping)
+ * - CPU_Load: busy time of the last load window in percent
+ * 
+ * Counters wrap at their field width; the PC takes differences between
+ * consecutive frames. Sent at normal priority - pure diagnostics.
+ */
+static void SendDiagnostics(void)
+{
+    struct automate_mcu_diag_msg_t diag_msg;
+    CAN_Driver_Stats_t can_stats;
+    CAN_Driver_BusStatus_t bus_status;
+    CAN_Message_t *slot;
+    
+    slot = CAN_Driver_TxReserve(CAN_TX_PRIORITY_NORMAL);
+    if (slot == NULL) {
+        return;  /* TX queue full - counted in driver statistics */
+    }
+    
+    automate_mcu_diag_msg_init(&diag_msg);
+    
+    CAN_Driver_GetStats(&can_stats);
+    diag_msg.rx_frames = automate_int_mcu_diag_msg_frames_encode(can_stats.rx_frames);
+    diag_msg.tx_frames = automate_int_mcu_diag_msg_frames_encode(can_stats.tx_frames);
+    diag_msg.ring_drops = automate_int_mcu_diag_msg_ring_drops_encode(
+        can_stats.rx_dropped + can_stats.tx_dropped + can_stats.tx_high_dropped + can_stats.rx_fifo_lost);
+    
+    /* Error fields stay zero if the FDCAN registers cannot be read */
+    if (CAN_Driver_GetBusStatus(&bus_status)) {
+        diag_msg.tec = automate_int_mcu_diag_msg_tec_encode(bus_status.tx_error_count);
+        diag_msg.rec = automate_int_mcu_diag_msg_rec_encode(bus_status.rx_error_count);
+        diag_msg.bus_off = bus_status.bus_off ? 1 : 0;
+        diag_msg.bus_off_count = automate_int_mcu_diag_msg_nibble_counter_encode(bus_status.bus_off_events);
+    }
+    
+    diag_msg.loop_overruns = automate_int_mcu_diag_msg_nibble_counter_encode(Scheduler_GetOverruns());
+    diag_msg.cpu_load = automate_int_mcu_diag_msg_cpu_load_encode(Scheduler_GetCpuLoad());
+    
+    /* Pack message into ring slot */
+    PROFILE_START(PROFILE_PACK);
+    int packed_len = automate_codec_mcu_diag_msg_pack(slot->data, &diag_msg, sizeof(slot->data));
+    PROFILE_STOP(PROFILE_PACK);
+    
+    if (packed_len > 0) {
+        slot->id = AUTOMATE_MCU_DIAG_MSG_FRAME_ID;
+        slot->len = (uint8_t)packed_len;
+        slot->is_extended = AUTOMATE_MCU_DIAG_MSG_IS_EXTENDED;
+        CAN_Driver_TxCommit(CAN_TX_PRIORITY_NORMAL);
+    }
+}
+#endif
+
+/**
+ * @brief Handle PC heartbeat (Heart_Beat_MSG)
+ * 
+ * Both PC and MCU send Heart_Beat_MSG. Distinction is made by Node_id field.
+ * 
+ * @param msg Unpacked struct automate_heart_beat_msg_t
+ */
+static void HandleHeartbeat(const void *msg)
+{
+    const struct automate_heart_beat_msg_t *heartbeat = msg;
+    
+    /* Check if this is PC heartbeat (Node_id = 0x10) */
+    if (heartbeat->node_id == NODE_ID_PC) {
+        /* Update PC heartbeat timestamp for watchdog */
+        last_pc_heartbeat_tick = HAL_GetTick();
+        pc_heartbeat_msg_count = heartbeat->msg_count;
+        pc_heartbeat_received = true;
+        
+        /* Monitor PC health status */
+        if (heartbeat->health >= AUTOMATE_HEART_BEAT_MSG_HEALTH_WARNING_CHOICE) {
+            /* PC reports warning/failure - could take protective action */
+            /* Example: stop brake operation if PC has critical failure */
+        }
+    }
+    /* Ignore heartbeats from other nodes (including our own MCU echoes) */
+}
+
+/**
+ * @brief Handle brake command (Left_Brake_CMD / Right_Brake_CMD)
+ * 
+ * The target instance is the one whose cmd_frame_id matches the frame
+ * being dispatched.
+ * 
+ * @param msg Unpacked struct automate_left_brake_cmd_t
+ */
+static void HandleBrakeCommand(const void *msg)
+{
+    const struct automate_left_brake_cmd_t *brake_cmd = msg;
+    Brake_t *brake = NULL;
+    
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        if (Brake_GetConfig(Brake_Get(i))->cmd_frame_id == dispatch_frame_id) {
+            brake = Brake_Get(i);
+            break;
+        }
+    }
+    
+    /* Validate brake state value (0 or 1) */
+    if (brake != NULL && automate_left_brake_cmd_brake_state_is_in_range(brake_cmd->brake_state)) {
+        /* Forward command to brake control module */
+        /* brake_cmd->brake_state: 0 = release, 1 = push */
+        /* brake_cmd->msg_id: command counter from PC, echoed in the instance's Brake_MSG */
+        /* brake_cmd->stamp: timestamp when PC formed command */
+        Brake_ProcessCommandTimed(brake, brake_cmd->brake_state, brake_cmd->msg_id, dispatch_rx_cycles);
+    }
+}
+
+/**
+ * @brief Handle position trace command (TRACE_CMD_FRAME_ID)
+ * 
+ * @param msg Command byte (Trace_Command_t)
+ */
+static void HandleTraceCommand(const void *msg)
+{
+    /* Unknown commands are ignored */
+    (void)Trace_Command(*(const uint8_t *)msg);
+}
+
+/**
+ * @brief Handle runtime configuration command (MCU_Config_CMD)
+ * 
+ * Only the node whose current Node_id matches Target_Node_id takes the
+ * frame, so nodes sharing the bus are configured one at a time. A zero
+ * Node_id, cycle or timeout field keeps the current value; a request with
+ * any field out of range is ignored whole.
+ * 
+ * @param msg Unpacked struct automate_mcu_config_cmd_t
+ */
+static void HandleConfigCommand(const void *msg)
+{
+    const struct automate_mcu_config_cmd_t *cmd = msg;
+    Controller_Config_t request = config;
+    
+    /* Addressed to another node */
+    if (cmd->target_node_id != config.node_id) {
+        return;
+    }
+    
+    if (cmd->node_id != AUTOMATE_MCU_CONFIG_CMD_NODE_ID_UNCHANGED_CHOICE) {
+        request.node_id = cmd->node_id;
+    }
+    if (cmd->heartbeat_cycle != AUTOMATE_MCU_CONFIG_CMD_HEARTBEAT_CYCLE_UNCHANGED_CHOICE) {
+        request.heartbeat_interval_ms = cmd->heartbeat_cycle;
+    }
+    if (cmd->telemetry_cycle != AUTOMATE_MCU_CONFIG_CMD_TELEMETRY_CYCLE_UNCHANGED_CHOICE) {
+        request.telemetry_interval_ms = cmd->telemetry_cycle;
+    }
+    if (cmd->watchdog_timeout != AUTOMATE_MCU_CONFIG_CMD_WATCHDOG_TIMEOUT_UNCHANGED_CHOICE) {
+        request.watchdog_timeout_ms = cmd->watchdog_timeout;
+    }
+    
+    (void)Controller_SetConfig(&request);
+}
+
+/* Unpack adapters: automate codec signature -> Controller_UnpackFn_t */
+static int UnpackHeartbeat(void *dst, const uint8_t *src, size_t size)
+{
+    return automate_codec_heart_beat_msg_unpack(dst, src, size);
+}
+
+static int UnpackBrakeCommand(void *dst, const uint8_t *src, size_t size)
+{
+    return automate_codec_left_brake_cmd_unpack(dst, src, size);
+}
+
+static int UnpackConfigCommand(void *dst, const uint8_t *src, size_t size)
+{
+    return automate_codec_mcu_config_cmd_unpack(dst, src, size);
+}
+
+/* Trace command is not in the DBC: first payload byte only */
+static int UnpackTraceCommand(void *dst, const uint8_t *src, size_t size)
+{
+    if (size < 1u) {
+        return (-EINVAL);
+    }
+    
+    *(uint8_t *)dst = src[0];
+    
+    return (0);
+}
+
+/**
+ * @brief Find handler for a received frame
+ * 
+ * Uses the hardware filter index (one filter element per handler) for a
+ * direct table lookup. Frames accepted without a filter match fall back
+ * to a linear search by identifier.
+ * 
+ * @param msg Received message
+ * @return Handler entry, or NULL if frame is not handled
+ */
+static const Controller_Handler_t *FindHandler(const CAN_Message_t *msg)
+{
+    uint8_t slot = HANDLER_SLOT_NONE;
+    
+    if (msg->filter_index < CONTROLLER_MAX_HANDLERS) {
+        slot = msg->is_extended ? ext_dispatch[msg->filter_index] : std_dispatch[msg->filter_index];
+    }
+    
+    /* O(1) path: filter element maps straight to its handler */
+    if (slot != HANDLER_SLOT_NONE && handlers[slot].frame_id == msg->id) {
+        return &handlers[slot];
+    }
+    
+    /* Fallback when frame was accepted by the global filter */
+    for (uint8_t i = 0; i < handler_count; i++) {
+        if (handlers[i].frame_id == msg->id && handlers[i].is_extended == msg->is_extended) {
+            return &handlers[i];
+        }
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief Program one hardware filter element per registered handler
+ * 
+ * @return true if filters were programmed
+ */
+static bool ApplyFilters(void)
+{
+    CAN_Filter_t filters[CONTROLLER_MAX_HANDLERS];
+    
+    for (uint8_t i = 0; i < handler_count; i++) {
+        filters[i].id = handlers[i].frame_id;
+        filters[i].is_extended = handlers[i].is_extended;
+        filters[i].mask = handlers[i].is_extended ? CAN_FILTER_MASK_EXACT_EXT : CAN_FILTER_MASK_EXACT_STD;
+        filters[i].high_priority = handlers[i].high_priority;
     }
+    
+    return CAN_Driver_ConfigFilters(filters, handler_count, true);
 }
 
 /**
  * @brief Process received CAN messages
  * 
- * Polls CAN driver for new messages and processes them based on ID:
+ * Polls CAN driver for new messages and dispatches them through the
+ * handler table registered with Controller_RegisterHandler():
  * - Heart_Beat_MSG (0x98FF0D00): Monitor PC heartbeat (Node_id = 0x10)
- * - Left_Brake_CMD (0x98FF0D09): Execute brake commands from PC
+ * - Left_Brake_CMD (0x98FF0D09): Execute left brake commands from PC
+ * - Right_Brake_CMD (0x98FF0D0B): Execute right brake commands from PC
+ * - MCU_Config_CMD (0x98FF0D0F): Runtime configuration of this node
+ * - TRACE_CMD_FRAME_ID (0x1800ADF1): Position trace arm/stream, see trace.h
  * 
- * Both PC and MCU send Heart_Beat_MSG. Distinction is made by Node_id field.
+ * Messages are unpacked in place from the RX ring slot.
  */
 static void ProcessReceivedMessage(void)
 {
-    CAN_Message_t msg;
+    const CAN_Message_t *msg;
+    
+    PROFILE_START(PROFILE_PROCESS_RX);
 
     /* Process all available messages in queue */
-    while (CAN_Driver_Get(&msg)) {
+    while ((msg = CAN_Driver_RxPeek()) != NULL) {
+        const Controller_Handler_t *entry = FindHandler(msg);
         
-        /* Dispatch based on message ID */
-        switch (msg.id)
-        {
-            case AUTOMATE_HEART_BEAT_MSG_FRAME_ID:  /* 0x98FF0D00 */
-            {
-                struct automate_heart_beat_msg_t heartbeat;
-                
-                /* Unpack and validate message */
-                if (automate_heart_beat_msg_unpack(&heartbeat, msg.data, msg.len) == 0) {
-                    
-                    /* Check if this is PC heartbeat (Node_id = 0x10) */
-                    if (heartbeat.node_id == NODE_ID_PC) {
-                        /* Update PC heartbeat timestamp for watchdog */
-                        last_pc_heartbeat_tick = HAL_GetTick();
-                        pc_heartbeat_msg_count = heartbeat.msg_count;
-                        pc_heartbeat_received = true;
-                        
-                        /* Monitor PC health status */
-                        if (heartbeat.health >= AUTOMATE_HEART_BEAT_MSG_HEALTH_WARNING_CHOICE) {
-                            /* PC reports warning/failure - could take protective action */
-                            /* Example: stop brake operation if PC has critical failure */
-                        }
-                    }
-                    /* Ignore heartbeats from other nodes (including our own MCU echoes) */
-                }
-                break;
-            }
+        /* Unpack and validate message, then dispatch (unknown IDs are ignored) */
+        if (entry != NULL) {
+            Controller_MsgBuffer_t unpacked;
             
-            case AUTOMATE_LEFT_BRAKE_CMD_FRAME_ID:  /* 0x98FF0D09 */
-            {
-                struct automate_left_brake_cmd_t brake_cmd;
-                
-                /* Unpack and validate message */
-                if (automate_left_brake_cmd_unpack(&brake_cmd, msg.data, msg.len) == 0) {
-                    /* Validate brake state value (0 or 1) */
-                    if (automate_left_brake_cmd_brake_state_is_in_range(brake_cmd.brake_state)) {
-                        /* Forward command to brake control module */
-                        /* brake_cmd.brake_state: 0 = release, 1 = push */
-                        /* brake_cmd.msg_id: command counter from PC */
-                        /* brake_cmd.stamp: timestamp when PC formed command */
-                        Brake_ProcessCommand(brake_cmd.brake_state);
-                    }
-                }
-                break;
+            if (entry->unpack_fn(&unpacked, msg->data, msg->len) == 0) {
+                dispatch_frame_id = msg->id;
+                dispatch_rx_cycles = msg->rx_cycles;
+                entry->handler_fn(&unpacked);
             }
-            
-            default:
-                /* Unknown message ID - ignore */
-                break;
         }
+        
+        /* Hand slot back to RX interrupt */
+        CAN_Driver_RxRelease();
+    }
+    
+    PROFILE_STOP(PROFILE_PROCESS_RX);
+}
+
+/**
+ * @brief Store changed calibration while the brakes are idle
+ * 
+ * May block for a flash page erase; a skipped save (brake moving) is
+ * retried on the next period.
+ */
+static void SaveCalibration(void)
+{
+    (void)Brake_SaveCalibration();
+}
+
+/**
+ * @brief Check cycle times, watchdog timeout and node ID of a configuration
+ */
+static bool IsConfigValid(const Controller_Config_t *cfg)
+{
+    const uint16_t times[] = {
+        cfg->heartbeat_interval_ms, cfg->telemetry_interval_ms, cfg->watchdog_timeout_ms
+    };
+    
+    for (uint32_t i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+        if (times[i] < CONTROLLER_CYCLE_MIN_MS || times[i] > CONTROLLER_CYCLE_MAX_MS) {
+            return false;
+        }
+    }
+    
+    /* The PC's Node_id would make our heartbeat look like the PC's */
+    return cfg->node_id != NODE_ID_PC;
+}
+
+/**
+ * @brief Find the controller_tasks[] entry of a task body
+ * 
+ * @return Task index, CONTROLLER_TASK_COUNT if not in the table
+ */
+static uint8_t FindTask(void (*fn)(void))
+{
+    uint8_t index = 0;
+    
+    while (index < CONTROLLER_TASK_COUNT && controller_tasks[index].fn != fn) {
+        index++;
+    }
+    
+    return index;
+}
+
+/**
+ * @brief Hand the configured cycle times to the scheduler
+ */
+static void ApplyCycleTimes(void)
+{
+    (void)Scheduler_SetPeriod(FindTask(SendHeartbeat), config.heartbeat_interval_ms);
+    (void)Scheduler_SetPeriod(FindTask(SendTelemetry), config.telemetry_interval_ms);
+}
+
+/**
+ * @brief Load the stored configuration, defaults if none or out of range
+ */
+static void RestoreConfig(void)
+{
+    Controller_Config_t stored;
+    
+    config = config_defaults;
+    config_unsaved = false;
+    
+    if (Storage_Read(STORAGE_KEY_CONFIG, &stored, sizeof(stored)) && IsConfigValid(&stored)) {
+        config = stored;
+    }
+}
+
+/**
+ * @brief Store a changed configuration while the brakes are idle
+ * 
+ * May block for a flash page erase; a skipped or failed save is retried
+ * on the next period.
+ */
+static void SaveConfig(void)
+{
+    if (!config_unsaved || AnyBrakeMoving()) {
+        return;
+    }
+    
+    if (Storage_Write(STORAGE_KEY_CONFIG, &config, sizeof(config))) {
+        config_unsaved = false;
     }
 }
 
+#if LOW_POWER_IDLE_ENABLED
+/**
+ * @brief Allow flash power-down in sleep while every brake is parked
+ * 
+ * A command received while parked starts moving on the next control tick;
+ * the slower wake-up then lasts until this task runs again.
+ */
+static void UpdatePowerMode(void)
+{
+    Scheduler_SetLowPowerIdle(!AnyBrakeMoving());
+}
+#endif
+
+#if PROFILING_ENABLED
+/**
+ * @brief Export hot-path cycle statistics over CAN (Debug builds)
+ */
+static void ExportProfile(void)
+{
+    (void)Profile_ExportCan();
+}
+#endif
+
 /**
  * @brief Update system health status
  * 
  * Monitors system state and updates MCU health accordingly:
- * - INIT: Initial startup state (first second)
+ * - INIT: Initial startup state (first second, 100 ms when the calibration
+ *   was restored from storage)
  * - ON: Normal operation with PC communication
- * - WARNING: PC heartbeat timeout (no messages for 200ms = 4 missed @ 50ms)
+ * - WARNING: PC heartbeat timeout (no messages for the configured
+ *   watchdog timeout, 200ms = 4 missed @ 50ms by default),
+ *   or CAN error passive / bus-off, held CAN_REJOIN_WARNING_MS after rejoin
  * - FAILURE: Critical error detected
  * 
  * PC heartbeat monitoring:
@@ -233,31 +893,37 @@ static void UpdateSystemHealth(void)
 {
     uint32_t current_tick = HAL_GetTick();
     
+    bool link_ok = !CanBusDegraded(current_tick);
+    
     /* Check for PC heartbeat timeout (only if we've received at least one) */
     if (pc_heartbeat_received) {
         uint32_t time_since_last_pc_heartbeat = current_tick - last_pc_heartbeat_tick;
         
-        if (time_since_last_pc_heartbeat > WATCHDOG_TIMEOUT_MS) {
+        if (time_since_last_pc_heartbeat > config.watchdog_timeout_ms) {
             /* PC heartbeat lost - communication timeout */
-            if (node_health == AUTOMATE_HEART_BEAT_MSG_HEALTH_ON_CHOICE) {
-                node_health = AUTOMATE_HEART_BEAT_MSG_HEALTH_WARNING_CHOICE;
-            }
-        } else {
-            /* PC heartbeat OK - restore normal health if in warning */
-            if (node_health == AUTOMATE_HEART_BEAT_MSG_HEALTH_WARNING_CHOICE) {
-                node_health = AUTOMATE_HEART_BEAT_MSG_HEALTH_ON_CHOICE;
-            }
+            link_ok = false;
+        }
+    }
+    
+    if (!link_ok) {
+        if (node_health == AUTOMATE_HEART_BEAT_MSG_HEALTH_ON_CHOICE) {
+            node_health = AUTOMATE_HEART_BEAT_MSG_HEALTH_WARNING_CHOICE;
+        }
+    } else {
+        /* PC heartbeat and bus OK - restore normal health if in warning */
+        if (node_health == AUTOMATE_HEART_BEAT_MSG_HEALTH_WARNING_CHOICE) {
+            node_health = AUTOMATE_HEART_BEAT_MSG_HEALTH_ON_CHOICE;
         }
     }
     
     /* After initialization period, switch to ON state */
     if (node_health == AUTOMATE_HEART_BEAT_MSG_HEALTH_INIT_CHOICE && 
-        current_tick > 1000) {  /* 1 second after boot */
+        current_tick > (Brake_IsCalibrationRestored() ? HEALTH_INIT_RESTORED_MS : HEALTH_INIT_TIME_MS)) {
         node_health = AUTOMATE_HEART_BEAT_MSG_HEALTH_ON_CHOICE;
     }
     
     /* Check for brake system errors */
-    if (Brake_HasError()) {
+    if (AnyBrakeError()) {
         /* Brake system in error state */
         if (node_health < AUTOMATE_HEART_BEAT_MSG_HEALTH_FAILURE_CHOICE) {
             node_health = AUTOMATE_HEART_BEAT_MSG_HEALTH_FAILURE_CHOICE;
@@ -268,6 +934,7 @@ static void UpdateSystemHealth(void)
 /**
  * @brief Update status LED based on system state
  * 
+ * Shows the combined state of all brakes (see AggregateBrakeState()).
  * LED behavior:
  * - RELEASED: OFF
  * - RELEASING: Slow blink (500ms)
@@ -280,7 +947,7 @@ static void UpdateStatusLED(void)
     uint32_t current_tick = HAL_GetTick();
     uint32_t blink_period = STATUS_LED_BLINK_PERIOD_MS;
     
-    switch(app_state.state) {
+    switch(AggregateBrakeState()) {
         case BRAKE_STATE_RELEASED:
             /* Solid OFF */
             HAL_GPIO_WritePin(STATUS_LED_GPIO_Port, STATUS_LED_Pin, GPIO_PIN_RESET);
@@ -330,27 +997,117 @@ static void UpdateStatusLED(void)
  * @brief Initialize controller
  * 
  * Call this once at startup to initialize controller state.
- * Sets MCU Node_id to 0xF0 as per specification.
+ * Restores the stored configuration (Node_id 0xF0 and the DBC cycle
+ * times by default).
+ * Registers the protocol handlers, which programs CAN hardware filters,
+ * so it must run before CAN_Driver_Start().
  */
 void Controller_Init(void)
 {
+    /* Reset dispatch table */
+    handler_count = 0;
+    ext_filter_count = 0;
+    std_filter_count = 0;
+    memset(ext_dispatch, HANDLER_SLOT_NONE, sizeof(ext_dispatch));
+    memset(std_dispatch, HANDLER_SLOT_NONE, sizeof(std_dispatch));
+    
+    /* Accept only protocol frames handled by the dispatch table.
+     * Brake commands use priority RX FIFO 1 so they are drained ahead of heartbeats. */
+    if (!Controller_RegisterHandler(AUTOMATE_HEART_BEAT_MSG_FRAME_ID, AUTOMATE_HEART_BEAT_MSG_IS_EXTENDED,
+                                    UnpackHeartbeat, HandleHeartbeat, false)) {
+        Error_Handler();
+    }
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        if (!Controller_RegisterHandler(Brake_GetConfig(Brake_Get(i))->cmd_frame_id,
+                                        AUTOMATE_LEFT_BRAKE_CMD_IS_EXTENDED,
+                                        UnpackBrakeCommand, HandleBrakeCommand, true)) {
+            Error_Handler();
+        }
+    }
+    if (!Controller_RegisterHandler(AUTOMATE_MCU_CONFIG_CMD_FRAME_ID, AUTOMATE_MCU_CONFIG_CMD_IS_EXTENDED,
+                                    UnpackConfigCommand, HandleConfigCommand, false)) {
+        Error_Handler();
+    }
+    if (!Controller_RegisterHandler(TRACE_CMD_FRAME_ID, true,
+                                    UnpackTraceCommand, HandleTraceCommand, false)) {
+        Error_Handler();
+    }
+    
     /* Initialize state variables */
-    node_id = NODE_ID_MCU;                  /* 0xF0 - MCU identifier */
+    RestoreConfig();                        /* Node_id 0xF0 unless reconfigured */
     heartbeat_msg_count = 0;                /* MCU heartbeat counter starts at 0 */
-    telemetry_msg_id = 0;                   /* Telemetry counter starts at 0 */
     node_health = AUTOMATE_HEART_BEAT_MSG_HEALTH_INIT_CHOICE;
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        telemetry_msg_id[i] = 0;                            /* Telemetry counter starts at 0 */
+        telemetry_state[i] = Brake_GetState(Brake_Get(i));  /* Boot state goes out with the first periodic frame */
+        last_telemetry_tick[i] = HAL_GetTick();
+    }
     
     /* Initialize timing */
-    last_heartbeat_tick = HAL_GetTick();
-    last_telemetry_tick = HAL_GetTick();
     last_pc_heartbeat_tick = 0;             /* No PC heartbeat received yet */
     last_led_toggle_tick = HAL_GetTick();
     
     /* Initialize PC monitoring */
     pc_heartbeat_msg_count = 0;
     pc_heartbeat_received = false;
+    can_recoveries_seen = 0;
+    last_can_rejoin_tick = 0;
     
     led_state = false;
+    
+    /* Start background schedule (phases relative to now) */
+    if (!Scheduler_Init(controller_tasks, CONTROLLER_TASK_COUNT)) {
+        Error_Handler();
+    }
+    ApplyCycleTimes();
+}
+
+/**
+ * @brief Register handler for a received frame
+ * 
+ * Appends the frame to the dispatch table and reprograms the CAN hardware
+ * filters so the new entry gets its own filter element.
+ * 
+ * @param frame_id CAN identifier
+ * @param is_extended true for 29-bit identifier
+ * @param unpack_fn Payload decoder (returns 0 on success)
+ * @param handler_fn Called with the unpacked message
+ * @param high_priority true to route frame into RX FIFO 1
+ * @return true if registered
+ */
+bool Controller_RegisterHandler(uint32_t frame_id, bool is_extended,
+                                Controller_UnpackFn_t unpack_fn, Controller_HandlerFn_t handler_fn,
+                                bool high_priority)
+{
+    Controller_Handler_t *entry;
+    
+    if (unpack_fn == NULL || handler_fn == NULL || handler_count >= CONTROLLER_MAX_HANDLERS) {
+        return false;
+    }
+    
+    entry = &handlers[handler_count];
+    entry->frame_id = frame_id;
+    entry->unpack_fn = unpack_fn;
+    entry->handler_fn = handler_fn;
+    entry->is_extended = is_extended;
+    entry->high_priority = high_priority;
+    handler_count++;
+    
+    /* Filter elements are numbered per identifier type in table order */
+    if (!ApplyFilters()) {
+        /* Out of filter elements or CAN already started - drop the entry again */
+        handler_count--;
+        (void)ApplyFilters();
+        return false;
+    }
+    
+    if (is_extended) {
+        ext_dispatch[ext_filter_count++] = handler_count - 1u;
+    } else {
+        std_dispatch[std_filter_count++] = handler_count - 1u;
+    }
+    
+    return true;
 }
 
 /**
@@ -361,11 +1118,15 @@ void Controller_Init(void)
  * 
  * MCU → PC:
  * - Heart_Beat_MSG (0x98FF0D00): Every 50ms with Node_id=0xF0
- * - Left_Brake_MSG (0x98FF0D0A): Every 100ms with actuator state
+ * - Left_Brake_MSG (0x98FF0D0A) / Right_Brake_MSG (0x98FF0D0C): Every 100ms
+ *   with actuator state, and on every state change (rate limited by
+ *   CONTROLLER_TELEMETRY_MIN_GAP_MS)
+ * - MCU_Diag_MSG (0x98FF0D0E): Every CONTROLLER_DIAG_INTERVAL_MS (optional)
  * 
  * PC → MCU:
  * - Heart_Beat_MSG (0x98FF0D00): Expected every 50ms with Node_id=0x10
- * - Left_Brake_CMD (0x98FF0D09): Brake commands (push/release)
+ * - Left_Brake_CMD (0x98FF0D09) / Right_Brake_CMD (0x98FF0D0B): Brake
+ *   commands (push/release)
  * 
  * Handles:
  * - Message reception and processing (PC commands and heartbeat)
@@ -373,41 +1134,27 @@ void Controller_Init(void)
  * - Periodic telemetry transmission (actuator state to PC)
  * - System health monitoring (communication timeout detection)
  * - Status LED indication
+ * 
+ * Each item is an entry of controller_tasks[] run by the cooperative
+ * scheduler; per-task WCET and deadline misses via Scheduler_GetTaskStats().
  */
 void Business_Loop(void) 
 {
-    uint32_t current_tick = HAL_GetTick();
-
-    /* Process all pending CAN messages (PC heartbeat + commands) */
-    ProcessReceivedMessage();
-
-    /* Send MCU heartbeat at fixed 50ms interval (signals MCU availability to PC) */
-    if (current_tick - last_heartbeat_tick >= HEARTBEAT_INTERVAL_MS) {
-        SendHeartbeat();
-        last_heartbeat_tick = current_tick;
-    }
-    
-    /* Send telemetry at fixed 100ms interval (actuator state to PC) */
-    if (current_tick - last_telemetry_tick >= TELEMETRY_INTERVAL_MS) {
-        SendTelemetry();
-        last_telemetry_tick = current_tick;
-    }
-    
-    /* Update system health status (monitor PC communication) */
-    UpdateSystemHealth();
-    
-    /* Update status LED */
-    UpdateStatusLED();
+    Scheduler_Run();
 }
 
 /**
  * @brief Set node ID
  * 
- * @param id Node identifier (0-255)
+ * @param id Node identifier
+ * @return false if the configuration with this ID is rejected
  */
-void Controller_SetNodeID(uint8_t id)
+bool Controller_SetNodeID(uint8_t id)
 {
-    node_id = id;
+    Controller_Config_t request = config;
+    
+    request.node_id = id;
+    return Controller_SetConfig(&request);
 }
 
 /**
@@ -417,7 +1164,7 @@ void Controller_SetNodeID(uint8_t id)
  */
 uint8_t Controller_GetNodeID(void)
 {
-    return node_id;
+    return config.node_id;
 }
 
 /**
@@ -450,7 +1197,6 @@ uint8_t Controller_GetHealth(void)
 void Controller_SendHeartbeatNow(void)
 {
     SendHeartbeat();
-    last_heartbeat_tick = HAL_GetTick();
 }
 
 /**
@@ -461,5 +1207,36 @@ void Controller_SendHeartbeatNow(void)
 void Controller_SendTelemetryNow(void)
 {
     SendTelemetry();
-    last_telemetry_tick = HAL_GetTick();
+}
+
+/**
+ * @brief Apply a new runtime configuration and keep it in flash
+ * 
+ * @param new_config New configuration
+ * @return false if out of range
+ */
+bool Controller_SetConfig(const Controller_Config_t *new_config)
+{
+    if (new_config == NULL || !IsConfigValid(new_config)) {
+        return false;
+    }
+    
+    config = *new_config;
+    config.reserved = 0;
+    config_unsaved = true;
+    ApplyCycleTimes();
+    
+    return true;
+}
+
+/**
+ * @brief Get the runtime configuration in force
+ * 
+ * @param out Output configuration
+ */
+void Controller_GetConfig(Controller_Config_t *out)
+{
+    if (out != NULL) {
+        *out = config;
+    }
 }
\ No newline at end of file
@@ -1,14 +1,21 @@
 /**
  * @file left_brake.c
- * @brief Left brake actuator control driver
+ * @brief Brake actuator control driver
  * 
- * Controls brake actuator via BTN7971B motor driver with position feedback
- * from potentiometer. Implements state machine for push/release operations.
+ * Controls BRAKE_COUNT brake actuators via BTN7971B motor drivers with
+ * position feedback from potentiometers. Each Brake_t instance runs its own
+ * state machine for push/release operations; all instances share one ADC1
+ * regular scan and one pass over its DMA buffer per control tick.
  */
 
+#include <string.h>
 #include "common.h"
 #include "left_break.h"
+#include "control_loop.h"
+#include "profile.h"
 #include "automate.h"
+#include "automate_codec.h"
+#include "storage.h"
 #include "main.h"
 
 /* ============================================================================
@@ -16,48 +23,218 @@
  * ============================================================================ */
 
 /* Position thresholds (ADC 12-bit: 0-4095) */
-#define POSITION_RELEASED           200     /* Fully released position */
-#define POSITION_PUSHED             3800    /* Fully pushed position */
+#define POSITION_RELEASED           200     /* Default released end stop */
+#define POSITION_PUSHED             3800    /* Default pushed end stop */
 #define POSITION_TOLERANCE          100     /* Position detection tolerance */
+#define END_STOP_MIN_DISTANCE       (4 * POSITION_TOLERANCE)
 
 /* Motor control */
 #define MOTOR_DUTY_PUSH             80      /* 80% duty cycle for pushing */
 #define MOTOR_DUTY_RELEASE          80      /* 80% duty cycle for releasing */
 
+/* Profiled position control (units in Brake_ControlParams_t) */
+#ifndef BRAKE_CONTROL_MODE_DEFAULT
+#define BRAKE_CONTROL_MODE_DEFAULT  BRAKE_CONTROL_FIXED_DUTY
+#endif
+#define CTRL_KP_DEFAULT             512     /* 2 % per count */
+#define CTRL_KI_DEFAULT             4       /* ~0.016 % per count*tick */
+#define CTRL_KD_DEFAULT             0
+#define CTRL_KFF_DEFAULT            11378   /* 100% duty at default cruise velocity */
+#define PROFILE_VELOCITY_DEFAULT    147456  /* 2.25 counts/ms: stroke in ~1.7 s */
+#define PROFILE_ACCEL_DEFAULT       1475    /* 0 -> cruise in ~100 ms */
+#define CTRL_DUTY_MAX_Q8            (100 << 8)
+#define CTRL_INTEGRAL_LIMIT         (1 << 22)   /* Accumulated error clamp (Q8) */
+#define CTRL_MAX_CATCHUP_TICKS      10          /* Trajectory steps per missed call */
+
 /* Timing */
 #define ESTIMATED_PUSH_TIME_MS      2000    /* Estimated time to push (2 sec) */
 #define ESTIMATED_RELEASE_TIME_MS   2000    /* Estimated time to release (2 sec) */
 #define POSITION_TIMEOUT_MS         5000    /* Max time for operation (5 sec) */
 
+/* Stroke-time model: mean stroke velocity per direction, Q16 counts/ms.
+ * Seeded from the estimated stroke times, then an exponential average of
+ * completed strokes (new stroke weighs 1 / 2^STROKE_MODEL_EMA_SHIFT). */
+#define STROKE_DISTANCE             (POSITION_PUSHED - POSITION_RELEASED)
+#define STROKE_VELOCITY_PUSH_DEFAULT    (((uint32_t)STROKE_DISTANCE << 16) / ESTIMATED_PUSH_TIME_MS)
+#define STROKE_VELOCITY_RELEASE_DEFAULT (((uint32_t)STROKE_DISTANCE << 16) / ESTIMATED_RELEASE_TIME_MS)
+#define STROKE_VELOCITY_MIN         (1u << 12)  /* 1/16 count/ms: full stroke in ~58 s */
+#define STROKE_VELOCITY_MAX         (64u << 16) /* 64 counts/ms: full stroke in ~56 ms */
+#define STROKE_MODEL_EMA_SHIFT      2
+#define STROKE_MODEL_MIN_DISTANCE   (STROKE_DISTANCE / 4)   /* Shorter strokes are not learned */
+
 /* Safety */
 #define MIN_VALID_POSITION          50      /* Minimum valid ADC reading */
 #define MAX_VALID_POSITION          4000    /* Maximum valid ADC reading */
 
+/* ADC sampling: TIM1 TRGO2 (OC4REF rising at CNT = 1000, ~5.9 us after the
+ * PWM on-edge, clear of both switching edges for duty 0% and >= 32%)
+ * triggers one conversion per PWM period. ADC clock = 170 MHz / 16, 105
+ * cycles per conversion (~9.9 us). The oversampler accumulates 8 triggers
+ * of a channel -> one 14-bit sample (sum of 8 >> 1), then moves to the next
+ * rank of the regular sequence, one instance per rank. A full scan takes
+ * 8 * BRAKE_COUNT PWM periods (2.5 kS/s / BRAKE_COUNT per channel), short
+ * enough that every control tick reads at least one new scan; DMA writes
+ * the scans interleaved by rank into one circular buffer. */
+#define ADC_DMA_BUFFER_SIZE         32      /* Samples per channel in circular buffer (~12.8 ms * BRAKE_COUNT) */
+#define ADC_DMA_SLOTS               (ADC_DMA_BUFFER_SIZE * BRAKE_COUNT) /* Whole scans only */
+#define ADC_DMA_FILL_TIME_MS        (15 * BRAKE_COUNT)  /* Time to fill the whole buffer once */
+#define ADC_OVERSAMPLING_EXTRA_BITS 2       /* 14-bit oversampled -> 12-bit position */
+#define ADC_PWM_CYCLES_PER_SAMPLE   8       /* Oversampling ratio, one trigger per PWM cycle */
+#define ADC_PWM_CYCLES_PER_SCAN     (ADC_PWM_CYCLES_PER_SAMPLE * BRAKE_COUNT)
+
+_Static_assert(ADC_PWM_CYCLES_PER_SCAN <= PWM_CYCLES_PER_CONTROL_TICK,
+               "Each control tick must see a new ADC scan");
+
+/* Streaming position filter: median-of-3 spike rejection + moving average */
+#define POSITION_FILTER_WINDOW      16      /* Moving average length (power of 2, ~6.4 ms * BRAKE_COUNT) */
+
+/* Error tracking */
+#define MAX_POSITION_ERRORS         10
+
+/* Persisted calibration */
+#define ADC_CALIBRATION_FACTOR_MAX  0x7Fu   /* 7-bit CALFACT_S */
+#define CALIBRATION_VELOCITY_SHIFT  4       /* Store velocity drift above 1/16 */
+
+/* ============================================================================
+ * Private Types
+ * ============================================================================ */
+
+/**
+ * @brief Brake actuator instance state
+ */
+struct Brake_s {
+    const Brake_Config_t *config;
+    BrakeState_t state;
+    
+    /* Current position from ADC */
+    uint16_t current_position;
+    
+    /* Position filter state (14-bit samples) */
+    uint16_t filter_window[POSITION_FILTER_WINDOW];
+    uint32_t filter_sum;
+    uint32_t filter_index;
+    uint16_t filter_history[2];             /* Two previous raw samples for median */
+    
+    /* Operation timing */
+    uint32_t operation_start_tick;
+    uint32_t time_to_end_ms;                /* Remaining stroke time at the last control tick */
+    uint16_t stroke_start_position;
+    Brake_StrokeModel_t stroke_model;       /* Learned velocity per direction, kept across strokes */
+    Brake_EndStops_t end_stops;
+    
+    /* Error tracking */
+    uint8_t position_error_count;
+    
+    /* Position control */
+    Brake_ControlMode_t control_mode;
+    Brake_ControlParams_t control_params;
+    
+    /* Trajectory reference (Q16 counts) and PID state (Q8 counts) */
+    int32_t profile_target;
+    int32_t profile_position;
+    int32_t profile_velocity;               /* Magnitude, counts/tick */
+    int32_t ctrl_integral;
+    int32_t ctrl_prev_error;
+    uint32_t ctrl_last_tick;
+    
+    /* Command latency tracking (written by control ISR after ApplyCommand) */
+    Brake_CommandTiming_t cmd_timing;
+    uint32_t cmd_rx_cycles;
+};
+
+/**
+ * @brief Calibration record (STORAGE_KEY_CALIBRATION)
+ */
+typedef struct {
+    uint32_t adc_calibration;               /* Single-ended CALFACT of ADC1 */
+    struct {
+        Brake_EndStops_t end_stops;
+        Brake_StrokeModel_t stroke_model;
+    } brake[BRAKE_COUNT];
+} Brake_Calibration_t;
+
+_Static_assert(sizeof(Brake_Calibration_t) <= STORAGE_DATA_MAX,
+               "Brake_Calibration_t does not fit one storage record");
+
 /* ============================================================================
  * Private Variables
  * ============================================================================ */
 
-/* Current position from ADC */
-static uint16_t current_position = 0;
+/* Instance mapping: TIM1 channel, INH pin, ADC1 rank, CAN frames */
+static const Brake_Config_t brake_configs[] = {
+    [BRAKE_LEFT] = {
+        .name = "left",
+        .pwm_channel = TIM_CHANNEL_1,           /* PA8 */
+        .inh_port = MOTOR_INH_GPIO_Port,
+        .inh_pin = MOTOR_INH_Pin,
+        .adc_rank = 0,                          /* ADC1_IN2, PA1 */
+        .cmd_frame_id = AUTOMATE_LEFT_BRAKE_CMD_FRAME_ID,
+        .msg_frame_id = AUTOMATE_LEFT_BRAKE_MSG_FRAME_ID,
+    },
+#if BRAKE_COUNT > 1
+    [BRAKE_RIGHT] = {
+        .name = "right",
+        .pwm_channel = TIM_CHANNEL_3,           /* PA10 */
+        .inh_port = RIGHT_MOTOR_INH_GPIO_Port,
+        .inh_pin = RIGHT_MOTOR_INH_Pin,
+        .adc_rank = 1,                          /* ADC1_IN1, PA0 */
+        .cmd_frame_id = AUTOMATE_RIGHT_BRAKE_CMD_FRAME_ID,
+        .msg_frame_id = AUTOMATE_RIGHT_BRAKE_MSG_FRAME_ID,
+    },
+#endif
+};
 
-/* Operation timing */
-static uint32_t operation_start_tick = 0;
-static uint32_t estimated_operation_time_ms = ESTIMATED_PUSH_TIME_MS;
+_Static_assert(sizeof(brake_configs) / sizeof(brake_configs[0]) == BRAKE_COUNT,
+               "brake_configs[] needs one entry per BRAKE_COUNT instance");
 
-/* Error tracking */
-static uint8_t position_error_count = 0;
-#define MAX_POSITION_ERRORS 10
+static Brake_t brakes[BRAKE_COUNT];
+
+/* ADC scans written by DMA in circular mode, rank-interleaved */
+static volatile uint16_t adc_dma_buffer[ADC_DMA_SLOTS];
+static bool adc_sampling = false;
+static uint32_t adc_read_index = 0;         /* Next DMA slot to feed into filters (scan aligned) */
+static uint32_t adc_seed_cycle = 0;         /* PWM cycle of the filter seed scan */
+static uint32_t adc_scan_count = 0;         /* Scans consumed since seed */
+static uint32_t adc_calibration = 0;        /* CALFACT in use */
+
+/* Last calibration written to or restored from storage */
+static Brake_Calibration_t calibration_stored;
+static bool calibration_is_stored = false;
+static bool calibration_restored = false;
 
 /* ============================================================================
  * Private Function Prototypes
  * ============================================================================ */
 
-static void Motor_SetDirection(bool push);
-static void Motor_SetPWM(uint8_t duty_percent);
-static void Motor_Stop(void);
-static uint16_t ADC_ReadPosition(void);
+static void Motor_SetDirection(const Brake_t *brake, bool push);
+static void Motor_SetPWM(Brake_t *brake, uint8_t duty_percent);
+static void Motor_Stop(Brake_t *brake);
+static void Motor_Drive(Brake_t *brake, int32_t duty_q8);
+static bool ADC_StartSampling(bool restore_calibration);
+static void ADC_DrainSamples(void);
+static uint32_t ADC_GetWriteIndex(void);
+static void PositionFilter_Reset(Brake_t *brake, uint16_t sample);
+static void PositionFilter_Push(Brake_t *brake, uint16_t sample);
+static uint16_t PositionFilter_Output(const Brake_t *brake);
+static void UpdatePosition(Brake_t *brake);
 static bool IsPositionValid(uint16_t position);
-static void UpdateOperationEstimate(void);
+static void StateFromPosition(Brake_t *brake);
+static void UpdateOperationEstimate(Brake_t *brake);
+static bool IsStrokeModelValid(const Brake_StrokeModel_t *model);
+static bool AreEndStopsValid(const Brake_EndStops_t *end_stops);
+static bool Calibration_Restore(void);
+static bool Calibration_VelocityDrifted(uint32_t stored, uint32_t live);
+static bool Calibration_HasChanged(const Brake_Calibration_t *current);
+static void StrokeModel_Learn(Brake_t *brake);
+static void Profile_Start(Brake_t *brake, uint16_t target);
+static void Profile_Step(Brake_t *brake);
+static int32_t Control_Step(Brake_t *brake);
+static bool ProfiledControl_Update(Brake_t *brake);
+static bool ApplyCommand(Brake_t *brake, uint8_t brake_state);
+static void CommandTiming_Actuated(Brake_t *brake);
+static void CommandTiming_Update(Brake_t *brake);
+static void UpdateStateMachine(Brake_t *brake);
+static bool RecoverState(Brake_t *brake);
 
 /* ============================================================================
  * Motor Control Functions (Private)
@@ -70,47 +247,81 @@ static void UpdateOperationEstimate(void);
  * - Push (forward): INH=HIGH, PWM on IN pin
  * - Release (backward): INH=LOW, PWM on IN pin (inverted logic)
  * 
+ * @param brake Instance
  * @param push true for push direction, false for release
  */
-static void Motor_SetDirection(bool push)
+static void Motor_SetDirection(const Brake_t *brake, bool push)
 {
     if (push) {
-        HAL_GPIO_WritePin(MOTOR_INH_GPIO_Port, MOTOR_INH_Pin, GPIO_PIN_SET);
+        HAL_GPIO_WritePin(brake->config->inh_port, brake->config->inh_pin, GPIO_PIN_SET);
     } else {
-        HAL_GPIO_WritePin(MOTOR_INH_GPIO_Port, MOTOR_INH_Pin, GPIO_PIN_RESET);
+        HAL_GPIO_WritePin(brake->config->inh_port, brake->config->inh_pin, GPIO_PIN_RESET);
     }
 }
 
 /**
  * @brief Set motor PWM duty cycle
  * 
+ * @param brake Instance
  * @param duty_percent Duty cycle percentage (0-100)
  */
-static void Motor_SetPWM(uint8_t duty_percent)
+static void Motor_SetPWM(Brake_t *brake, uint8_t duty_percent)
 {
     /* Clamp to valid range */
     if (duty_percent > 100) {
         duty_percent = 100;
     }
     
+    if (duty_percent != 0) {
+        CommandTiming_Actuated(brake);
+    }
+    
     /* Calculate compare value based on timer auto-reload */
     uint32_t arr = __HAL_TIM_GET_AUTORELOAD(&htim1);
     uint32_t ccr = (arr * duty_percent) / 100;
     
     /* Set PWM duty cycle */
-    __HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, ccr);
+    __HAL_TIM_SET_COMPARE(&htim1, brake->config->pwm_channel, ccr);
 }
 
 /**
  * @brief Stop motor immediately
+ * 
+ * @param brake Instance
  */
-static void Motor_Stop(void)
+static void Motor_Stop(Brake_t *brake)
 {
     /* Set PWM to 0% */
-    Motor_SetPWM(0);
+    Motor_SetPWM(brake, 0);
     
     /* Disable motor driver */
-    HAL_GPIO_WritePin(MOTOR_INH_GPIO_Port, MOTOR_INH_Pin, GPIO_PIN_RESET);
+    HAL_GPIO_WritePin(brake->config->inh_port, brake->config->inh_pin, GPIO_PIN_RESET);
+}
+
+/**
+ * @brief Drive motor with signed duty cycle
+ * 
+ * @param brake Instance
+ * @param duty_q8 Duty in percent, Q8 (-25600..25600), positive pushes
+ */
+static void Motor_Drive(Brake_t *brake, int32_t duty_q8)
+{
+    bool push = (duty_q8 >= 0);
+    uint32_t magnitude = (uint32_t)(push ? duty_q8 : -duty_q8);
+    
+    if (magnitude > CTRL_DUTY_MAX_Q8) {
+        magnitude = CTRL_DUTY_MAX_Q8;
+    }
+    
+    if (magnitude != 0) {
+        CommandTiming_Actuated(brake);
+    }
+    
+    Motor_SetDirection(brake, push);
+    
+    /* Same scaling as Motor_SetPWM() with 1/256 % resolution */
+    uint32_t arr = __HAL_TIM_GET_AUTORELOAD(&htim1);
+    __HAL_TIM_SET_COMPARE(&htim1, brake->config->pwm_channel, (arr * magnitude) / CTRL_DUTY_MAX_Q8);
 }
 
 /* ============================================================================
@@ -118,25 +329,178 @@ static void Motor_Stop(void)
  * ============================================================================ */
 
 /**
- * @brief Read current position from ADC
+ * @brief Calibrate ADC and start the regular scan into circular DMA
  * 
+ * @param restore_calibration Load adc_calibration instead of running a calibration
+ * @return true if sampling started
+ */
+static bool ADC_StartSampling(bool restore_calibration)
+{
+    /* One regular rank per instance, demultiplexed by Brake_Config_t.adc_rank */
+    if (hadc1.Init.NbrOfConversion != BRAKE_COUNT) {
+        return false;
+    }
+    
+    if (restore_calibration) {
+        /* Factor can only be written while the ADC is enabled and idle */
+        if (ADC_Enable(&hadc1) != HAL_OK ||
+            HAL_ADCEx_Calibration_SetValue(&hadc1, ADC_SINGLE_ENDED, adc_calibration) != HAL_OK) {
+            return false;
+        }
+    } else {
+        /* Calibration requires the ADC to be disabled */
+        if (HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED) != HAL_OK) {
+            return false;
+        }
+        adc_calibration = HAL_ADCEx_Calibration_GetValue(&hadc1, ADC_SINGLE_ENDED);
+    }
+    
+    if (HAL_ADC_Start_DMA(&hadc1, (uint32_t *)adc_dma_buffer, ADC_DMA_SLOTS) != HAL_OK) {
+        return false;
+    }
+    
+    /* Buffer is read on demand - no half/full transfer interrupts needed */
+    __HAL_DMA_DISABLE_IT(&hdma_adc1, DMA_IT_HT | DMA_IT_TC);
+    
+    return true;
+}
+
+/**
+ * @brief Get index of the DMA slot that will be written next
+ * 
+ * ADC_DMA_SLOTS need not be a power of 2, so wrap by compare.
+ * 
+ * @return Slot index (0 to ADC_DMA_SLOTS-1)
+ */
+static uint32_t ADC_GetWriteIndex(void)
+{
+    uint32_t index = ADC_DMA_SLOTS - __HAL_DMA_GET_COUNTER(&hdma_adc1);
+    
+    return (index >= ADC_DMA_SLOTS) ? 0u : index;
+}
+
+/**
+ * @brief Fill position filter with one value
+ * 
+ * @param brake Instance
+ * @param sample 14-bit oversampled ADC value
+ */
+static void PositionFilter_Reset(Brake_t *brake, uint16_t sample)
+{
+    for (uint32_t i = 0; i < POSITION_FILTER_WINDOW; i++) {
+        brake->filter_window[i] = sample;
+    }
+    brake->filter_sum = (uint32_t)sample * POSITION_FILTER_WINDOW;
+    brake->filter_index = 0;
+    brake->filter_history[0] = sample;
+    brake->filter_history[1] = sample;
+}
+
+/**
+ * @brief Feed one sample into position filter - O(1)
+ * 
+ * Median of the last three samples removes single-sample spikes, then a
+ * running-sum moving average smooths the result.
+ * 
+ * @param brake Instance
+ * @param sample 14-bit oversampled ADC value
+ */
+static void PositionFilter_Push(Brake_t *brake, uint16_t sample)
+{
+    uint16_t a = sample;
+    uint16_t b = brake->filter_history[0];
+    uint16_t c = brake->filter_history[1];
+    uint16_t median;
+    
+    /* Median of three */
+    if ((a >= b) == (a <= c)) {
+        median = a;
+    } else if ((b >= a) == (b <= c)) {
+        median = b;
+    } else {
+        median = c;
+    }
+    brake->filter_history[1] = b;
+    brake->filter_history[0] = a;
+    
+    /* Replace oldest window entry in running sum */
+    brake->filter_sum = brake->filter_sum - brake->filter_window[brake->filter_index] + median;
+    brake->filter_window[brake->filter_index] = median;
+    brake->filter_index = (brake->filter_index + 1u) & (POSITION_FILTER_WINDOW - 1u);
+}
+
+/**
+ * @brief Get filtered position
+ * 
+ * @param brake Instance
  * @return ADC value (0-4095)
  */
-static uint16_t ADC_ReadPosition(void)
+static uint16_t PositionFilter_Output(const Brake_t *brake)
+{
+    return (uint16_t)((brake->filter_sum / POSITION_FILTER_WINDOW) >> ADC_OVERSAMPLING_EXTRA_BITS);
+}
+
+/**
+ * @brief Feed new DMA scans into the position filters of all instances
+ * 
+ * Walks the buffer once for every instance together and stops at the last
+ * complete scan, so each filter always sees whole scans. Never waits for a
+ * conversion.
+ */
+static void ADC_DrainSamples(void)
 {
-    /* Start conversion */
-    HAL_ADC_Start(&hadc1);
+    uint32_t write_index;
     
-    /* Wait for conversion with timeout */
-    if (HAL_ADC_PollForConversion(&hadc1, 10) == HAL_OK) {
-        uint16_t value = (uint16_t)HAL_ADC_GetValue(&hadc1);
-        HAL_ADC_Stop(&hadc1);
-        return value;
+    /* Sampling not running - filters keep their last output */
+    if (!adc_sampling) {
+        return;
     }
     
-    /* Conversion timeout - return last known position */
-    HAL_ADC_Stop(&hadc1);
-    return current_position;
+    PROFILE_START(PROFILE_ADC_READ);
+    
+    write_index = ADC_GetWriteIndex();
+    write_index -= write_index % BRAKE_COUNT;
+    while (adc_read_index != write_index) {
+        const volatile uint16_t *scan = &adc_dma_buffer[adc_read_index];
+        
+        for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+            PositionFilter_Push(&brakes[i], scan[brakes[i].config->adc_rank]);
+        }
+        
+        adc_read_index += BRAKE_COUNT;
+        if (adc_read_index >= ADC_DMA_SLOTS) {
+            adc_read_index = 0;
+        }
+        adc_scan_count++;
+    }
+    
+    PROFILE_STOP(PROFILE_ADC_READ);
+}
+
+/**
+ * @brief Validate filtered position of one instance and track errors
+ * 
+ * @param brake Instance
+ */
+static void UpdatePosition(Brake_t *brake)
+{
+    /* Sampling not running - re-validate last known position */
+    uint16_t new_position = adc_sampling ? PositionFilter_Output(brake) : brake->current_position;
+    
+    /* Validate reading */
+    if (IsPositionValid(new_position)) {
+        brake->current_position = new_position;
+        brake->position_error_count = 0;
+    } else {
+        /* Invalid reading - increment error counter */
+        brake->position_error_count++;
+        
+        /* If too many errors, enter error state */
+        if (brake->position_error_count >= MAX_POSITION_ERRORS) {
+            brake->state = BRAKE_STATE_STOPPED;
+            Motor_Stop(brake);
+        }
+    }
 }
 
 /**
@@ -150,52 +514,350 @@ static bool IsPositionValid(uint16_t position)
     return (position >= MIN_VALID_POSITION && position <= MAX_VALID_POSITION);
 }
 
+/**
+ * @brief Derive resting state from current position
+ * 
+ * @param brake Instance
+ */
+static void StateFromPosition(Brake_t *brake)
+{
+    if (brake->current_position >= (brake->end_stops.pushed - POSITION_TOLERANCE)) {
+        brake->state = BRAKE_STATE_PUSHED;
+    } else {
+        /* Released, or in between - assume released */
+        brake->state = BRAKE_STATE_RELEASED;
+    }
+}
+
 /**
  * @brief Update estimated operation time based on position
  * 
- * Dynamically adjusts time estimate based on current progress
+ * Remaining distance to the end threshold divided by the learned velocity
+ * of the current direction, so the estimate is valid from the first tick
+ * and from any start position. One division per tick.
+ * 
+ * @param brake Instance
+ */
+static void UpdateOperationEstimate(Brake_t *brake)
+{
+    int32_t distance_remaining;
+    uint32_t velocity;
+    
+    /* Stroke ends within POSITION_TOLERANCE of the target */
+    if (brake->state == BRAKE_STATE_PUSHING) {
+        distance_remaining = (brake->end_stops.pushed - POSITION_TOLERANCE) - (int32_t)brake->current_position;
+        velocity = brake->stroke_model.push_velocity;
+    } else if (brake->state == BRAKE_STATE_RELEASING) {
+        distance_remaining = (int32_t)brake->current_position - (brake->end_stops.released + POSITION_TOLERANCE);
+        velocity = brake->stroke_model.release_velocity;
+    } else {
+        brake->time_to_end_ms = 0;
+        return;
+    }
+    
+    if (distance_remaining <= 0) {
+        brake->time_to_end_ms = 0;
+        return;
+    }
+    
+    /* Q16 counts / Q16 counts-per-ms, rounded up; velocity >= STROKE_VELOCITY_MIN */
+    brake->time_to_end_ms = (((uint32_t)distance_remaining << 16) + velocity - 1u) / velocity;
+}
+
+/**
+ * @brief Check learned velocities against the model limits
+ * 
+ * @param model Model to check
+ * @return true if both directions are within limits
+ */
+static bool IsStrokeModelValid(const Brake_StrokeModel_t *model)
+{
+    return (model->push_velocity >= STROKE_VELOCITY_MIN) && (model->push_velocity <= STROKE_VELOCITY_MAX) &&
+           (model->release_velocity >= STROKE_VELOCITY_MIN) && (model->release_velocity <= STROKE_VELOCITY_MAX);
+}
+
+/**
+ * @brief Check end stops against the valid ADC range
+ * 
+ * @param end_stops End stops to check
+ * @return true if both are valid and far enough apart for the thresholds
+ */
+static bool AreEndStopsValid(const Brake_EndStops_t *end_stops)
+{
+    return IsPositionValid(end_stops->released) && IsPositionValid(end_stops->pushed) &&
+           (end_stops->pushed >= end_stops->released + END_STOP_MIN_DISTANCE);
+}
+
+/**
+ * @brief Fold a completed stroke into the velocity model
+ * 
+ * Call while the state still names the direction of the stroke. Strokes
+ * shorter than STROKE_MODEL_MIN_DISTANCE are skipped, their mean velocity
+ * is dominated by acceleration.
+ * 
+ * @param brake Instance
  */
-static void UpdateOperationEstimate(void)
+static void StrokeModel_Learn(Brake_t *brake)
 {
-    uint32_t elapsed = HAL_GetTick() - operation_start_tick;
-    uint16_t start_pos, target_pos;
-    int32_t distance_total, distance_remaining;
+    uint32_t elapsed = HAL_GetTick() - brake->operation_start_tick;
+    int32_t distance = (int32_t)brake->current_position - (int32_t)brake->stroke_start_position;
+    uint32_t *velocity;
+    uint32_t measured;
     
-    /* Determine start and target based on state */
-    if (app_state.state == BRAKE_STATE_PUSHING) {
-        start_pos = POSITION_RELEASED;
-        target_pos = POSITION_PUSHED;
-    } else if (app_state.state == BRAKE_STATE_RELEASING) {
-        start_pos = POSITION_PUSHED;
-        target_pos = POSITION_RELEASED;
+    if (brake->state == BRAKE_STATE_PUSHING) {
+        velocity = &brake->stroke_model.push_velocity;
+    } else if (brake->state == BRAKE_STATE_RELEASING) {
+        velocity = &brake->stroke_model.release_velocity;
+        distance = -distance;
     } else {
-        estimated_operation_time_ms = 0;
         return;
     }
     
-    /* Calculate distances */
-    distance_total = (int32_t)target_pos - (int32_t)start_pos;
-    distance_remaining = (int32_t)target_pos - (int32_t)current_position;
+    if (distance < STROKE_MODEL_MIN_DISTANCE || elapsed == 0) {
+        return;
+    }
+    
+    measured = ((uint32_t)distance << 16) / elapsed;
+    if (measured < STROKE_VELOCITY_MIN) {
+        measured = STROKE_VELOCITY_MIN;
+    } else if (measured > STROKE_VELOCITY_MAX) {
+        measured = STROKE_VELOCITY_MAX;
+    }
+    
+    /* Exponential average, stays inside [MIN, MAX] because both ends are */
+    *velocity = (uint32_t)((int32_t)*velocity + (((int32_t)measured - (int32_t)*velocity) >> STROKE_MODEL_EMA_SHIFT));
+}
+
+/* ============================================================================
+ * Persisted Calibration (Private)
+ * ============================================================================ */
+
+/**
+ * @brief Load calibration of all instances from storage
+ * 
+ * The record is applied only if every field is in range, otherwise the
+ * defaults stay and the ADC is calibrated at boot.
+ * 
+ * @return true if the stored calibration was applied
+ */
+static bool Calibration_Restore(void)
+{
+    Brake_Calibration_t stored;
+    
+    if (!Storage_Read(STORAGE_KEY_CALIBRATION, &stored, sizeof(stored))) {
+        return false;
+    }
+    
+    /* Remember the record even if rejected, so a fixed one replaces it */
+    calibration_stored = stored;
+    calibration_is_stored = true;
+    
+    if (stored.adc_calibration > ADC_CALIBRATION_FACTOR_MAX) {
+        return false;
+    }
+    for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+        if (!AreEndStopsValid(&stored.brake[i].end_stops) ||
+            !IsStrokeModelValid(&stored.brake[i].stroke_model)) {
+            return false;
+        }
+    }
+    
+    adc_calibration = stored.adc_calibration;
+    for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+        brakes[i].end_stops = stored.brake[i].end_stops;
+        brakes[i].stroke_model = stored.brake[i].stroke_model;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Check a learned velocity against its stored value
+ * 
+ * @param stored Stored velocity
+ * @param live Current velocity
+ * @return true if they differ by more than 1/2^CALIBRATION_VELOCITY_SHIFT of stored
+ */
+static bool Calibration_VelocityDrifted(uint32_t stored, uint32_t live)
+{
+    uint32_t drift = (live > stored) ? (live - stored) : (stored - live);
+    
+    return drift > (stored >> CALIBRATION_VELOCITY_SHIFT);
+}
+
+/**
+ * @brief Compare live calibration with the stored copy
+ * 
+ * Learned velocities move a little with every stroke; they only count as
+ * changed beyond 1/2^CALIBRATION_VELOCITY_SHIFT of the stored value, so
+ * the flash is not written after every stroke.
+ * 
+ * @param current Live calibration
+ * @return true if it should be written
+ */
+static bool Calibration_HasChanged(const Brake_Calibration_t *current)
+{
+    if (!calibration_is_stored || current->adc_calibration != calibration_stored.adc_calibration) {
+        return true;
+    }
+    
+    for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+        const Brake_StrokeModel_t *live = &current->brake[i].stroke_model;
+        const Brake_StrokeModel_t *saved = &calibration_stored.brake[i].stroke_model;
+    
+        if (current->brake[i].end_stops.released != calibration_stored.brake[i].end_stops.released ||
+            current->brake[i].end_stops.pushed != calibration_stored.brake[i].end_stops.pushed) {
+            return true;
+        }
+        if (Calibration_VelocityDrifted(saved->push_velocity, live->push_velocity) ||
+            Calibration_VelocityDrifted(saved->release_velocity, live->release_velocity)) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/* ============================================================================
+ * Profiled Position Control (Private)
+ * ============================================================================ */
+
+/**
+ * @brief Start trapezoidal trajectory from current position
+ * 
+ * @param brake Instance
+ * @param target Target position (ADC counts)
+ */
+static void Profile_Start(Brake_t *brake, uint16_t target)
+{
+    brake->profile_target = (int32_t)target << 16;
+    brake->profile_position = (int32_t)brake->current_position << 16;
+    brake->profile_velocity = 0;
+    brake->ctrl_integral = 0;
+    brake->ctrl_prev_error = 0;
+    brake->ctrl_last_tick = GetControlTick();
+}
+
+/**
+ * @brief Advance trajectory reference by one control tick
+ * 
+ * Accelerates up to max_velocity and starts decelerating once the stopping
+ * distance v^2 / (2a) reaches the remaining distance.
+ * 
+ * @param brake Instance
+ */
+static void Profile_Step(Brake_t *brake)
+{
+    int32_t remaining = brake->profile_target - brake->profile_position;
+    int32_t distance = (remaining >= 0) ? remaining : -remaining;
+    int32_t accel = brake->control_params.acceleration;
+    int32_t max_velocity = brake->control_params.max_velocity;
+    int32_t v = brake->profile_velocity;
     
-    /* Avoid division by zero */
-    if (distance_total == 0) {
-        estimated_operation_time_ms = 0;
+    if (distance == 0) {
+        brake->profile_velocity = 0;
         return;
     }
     
-    /* Calculate remaining time based on progress */
-    if (elapsed > 0) {
-        int32_t distance_traveled = distance_total - distance_remaining;
-        if (distance_traveled > 0) {
-            /* Extrapolate based on current speed */
-            uint32_t time_per_unit = elapsed / distance_traveled;
-            estimated_operation_time_ms = time_per_unit * distance_remaining;
-        } else {
-            /* No progress yet - use default estimate */
-            estimated_operation_time_ms = (app_state.state == BRAKE_STATE_PUSHING) ?
-                                         ESTIMATED_PUSH_TIME_MS : ESTIMATED_RELEASE_TIME_MS;
+    if ((int64_t)v * v >= 2 * (int64_t)accel * distance) {
+        /* Decelerate, keep creeping so the target is always reached */
+        v = (v - accel > accel) ? (v - accel) : accel;
+    } else if (v < max_velocity) {
+        v = (v + accel < max_velocity) ? (v + accel) : max_velocity;
+    }
+    
+    if (v >= distance) {
+        brake->profile_position = brake->profile_target;
+        v = 0;
+    } else {
+        brake->profile_position += (remaining > 0) ? v : -v;
+    }
+    
+    brake->profile_velocity = v;
+}
+
+/**
+ * @brief Run one PID step on trajectory error
+ * 
+ * u = kff * v_ref + kp * e + ki * sum(e) + kd * de, all Q8. The integral
+ * only accumulates while the output is not saturated in the same direction.
+ * 
+ * @param brake Instance
+ * @return Motor duty in percent, Q8, saturated to +/-100%
+ */
+static int32_t Control_Step(Brake_t *brake)
+{
+    const Brake_ControlParams_t *params = &brake->control_params;
+    int32_t error = (brake->profile_position >> 8) - ((int32_t)brake->current_position << 8);
+    int32_t velocity = brake->profile_velocity >> 8;
+    int64_t acc;
+    int32_t duty;
+    
+    if (brake->profile_target < brake->profile_position) {
+        velocity = -velocity;
+    }
+    
+    acc = (int64_t)params->kff * velocity +
+          (int64_t)params->kp * error +
+          (int64_t)params->ki * brake->ctrl_integral +
+          (int64_t)params->kd * (error - brake->ctrl_prev_error);
+    brake->ctrl_prev_error = error;
+    
+    acc >>= 8;
+    if (acc > CTRL_DUTY_MAX_Q8) {
+        duty = CTRL_DUTY_MAX_Q8;
+    } else if (acc < -CTRL_DUTY_MAX_Q8) {
+        duty = -CTRL_DUTY_MAX_Q8;
+    } else {
+        duty = (int32_t)acc;
+    }
+    
+    /* Anti-windup: conditional integration */
+    if ((duty < CTRL_DUTY_MAX_Q8 || error < 0) && (duty > -CTRL_DUTY_MAX_Q8 || error > 0)) {
+        brake->ctrl_integral += error;
+        if (brake->ctrl_integral > CTRL_INTEGRAL_LIMIT) {
+            brake->ctrl_integral = CTRL_INTEGRAL_LIMIT;
+        } else if (brake->ctrl_integral < -CTRL_INTEGRAL_LIMIT) {
+            brake->ctrl_integral = -CTRL_INTEGRAL_LIMIT;
         }
     }
+    
+    return duty;
+}
+
+/**
+ * @brief Run profiled controller for elapsed control ticks
+ * 
+ * @param brake Instance
+ * @return true when trajectory is finished and position is within tolerance
+ */
+static bool ProfiledControl_Update(Brake_t *brake)
+{
+    uint32_t now = GetControlTick();
+    uint32_t ticks = now - brake->ctrl_last_tick;
+    int32_t position_error;
+    
+    /* Fixed rate: one step per control tick */
+    if (ticks == 0) {
+        return false;
+    }
+    brake->ctrl_last_tick = now;
+    
+    if (ticks > CTRL_MAX_CATCHUP_TICKS) {
+        ticks = CTRL_MAX_CATCHUP_TICKS;
+    }
+    while (ticks-- > 0) {
+        Profile_Step(brake);
+    }
+    
+    position_error = (brake->profile_target >> 16) - (int32_t)brake->current_position;
+    if (brake->profile_position == brake->profile_target &&
+        position_error <= POSITION_TOLERANCE && position_error >= -POSITION_TOLERANCE) {
+        return true;
+    }
+    
+    Motor_Drive(brake, Control_Step(brake));
+    return false;
 }
 
 /* ============================================================================
@@ -209,131 +871,278 @@ static void UpdateOperationEstimate(void)
  */
 void Brake_Init(void)
 {
-    /* Initialize variables */
-    current_position = 0;
-    operation_start_tick = 0;
-    estimated_operation_time_ms = ESTIMATED_PUSH_TIME_MS;
-    position_error_count = 0;
+    uint32_t last_scan;
     
-    /* Ensure motor is stopped */
-    Motor_Stop();
+    /* Initialize instances and ensure every motor is stopped before its PWM starts */
+    for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+        Brake_t *brake = &brakes[i];
+        
+        brake->config = &brake_configs[i];
+        brake->state = BRAKE_STATE_RELEASED;
+        brake->current_position = 0;
+        brake->operation_start_tick = 0;
+        brake->time_to_end_ms = 0;
+        brake->stroke_start_position = 0;
+        brake->stroke_model.push_velocity = STROKE_VELOCITY_PUSH_DEFAULT;
+        brake->stroke_model.release_velocity = STROKE_VELOCITY_RELEASE_DEFAULT;
+        brake->end_stops.released = POSITION_RELEASED;
+        brake->end_stops.pushed = POSITION_PUSHED;
+        brake->position_error_count = 0;
+        brake->control_mode = BRAKE_CONTROL_MODE_DEFAULT;
+        brake->control_params.kp = CTRL_KP_DEFAULT;
+        brake->control_params.ki = CTRL_KI_DEFAULT;
+        brake->control_params.kd = CTRL_KD_DEFAULT;
+        brake->control_params.kff = CTRL_KFF_DEFAULT;
+        brake->control_params.max_velocity = PROFILE_VELOCITY_DEFAULT;
+        brake->control_params.acceleration = PROFILE_ACCEL_DEFAULT;
+        brake->cmd_timing.valid = false;
+        
+        Motor_Stop(brake);
+        if (HAL_TIM_PWM_Start(&htim1, brake->config->pwm_channel) != HAL_OK) {
+            Error_Handler();
+        }
+    }
     
-    /* Perform initial ADC calibration */
-    HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED);
+    /* Stored calibration replaces the defaults and the ADC calibration run */
+    calibration_restored = Calibration_Restore();
     
-    /* Read initial position */
-    current_position = ADC_ReadPosition();
+    /* Start background sampling, wait for a full buffer */
+    adc_sampling = ADC_StartSampling(calibration_restored);
+    HAL_Delay(ADC_DMA_FILL_TIME_MS);
     
-    /* Determine initial state based on position */
-    if (current_position <= (POSITION_RELEASED + POSITION_TOLERANCE)) {
-        app_state.state = BRAKE_STATE_RELEASED;
-        app_state.target_position = POSITION_RELEASED;
-    } else if (current_position >= (POSITION_PUSHED - POSITION_TOLERANCE)) {
-        app_state.state = BRAKE_STATE_PUSHED;
-        app_state.target_position = POSITION_PUSHED;
-    } else {
-        /* In between - assume released */
-        app_state.state = BRAKE_STATE_RELEASED;
-        app_state.target_position = POSITION_RELEASED;
+    /* Seed filters with the newest complete scan so they start settled */
+    adc_read_index = ADC_GetWriteIndex();
+    adc_read_index -= adc_read_index % BRAKE_COUNT;
+    last_scan = ((adc_read_index == 0) ? ADC_DMA_SLOTS : adc_read_index) - BRAKE_COUNT;
+    for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+        PositionFilter_Reset(&brakes[i], adc_dma_buffer[last_scan + brakes[i].config->adc_rank]);
+    }
+    adc_seed_cycle = GetPwmCycle();
+    adc_scan_count = 0;
+    
+    /* Read initial positions and determine initial states */
+    ADC_DrainSamples();
+    for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+        brakes[i].current_position = PositionFilter_Output(&brakes[i]);
+        StateFromPosition(&brakes[i]);
     }
 }
 
 /**
- * @brief Update current position reading
+ * @brief Get brake instance
  * 
- * Call this periodically (e.g., every 10ms) from main loop
+ * @param index Instance index
+ * @return Instance, or NULL if out of range
+ */
+Brake_t *Brake_Get(uint8_t index)
+{
+    return (index < BRAKE_COUNT) ? &brakes[index] : NULL;
+}
+
+/**
+ * @brief Get instance configuration
+ * 
+ * @param brake Instance
+ * @return Constant configuration
+ */
+const Brake_Config_t *Brake_GetConfig(const Brake_t *brake)
+{
+    return brake->config;
+}
+
+/**
+ * @brief Update current position readings
+ * 
+ * Runs from the TIM1 update interrupt as CONTROL_TASK_POSITION, once per
+ * control tick (CONTROL_TICK_HZ, 1 kHz).
  */
 void Brake_UpdatePosition(void)
 {
-    uint16_t new_position = ADC_ReadPosition();
+    ADC_DrainSamples();
     
-    /* Validate reading */
-    if (IsPositionValid(new_position)) {
-        current_position = new_position;
-        app_state.current_position = new_position;
-        position_error_count = 0;
-    } else {
-        /* Invalid reading - increment error counter */
-        position_error_count++;
-        
-        /* If too many errors, enter error state */
-        if (position_error_count >= MAX_POSITION_ERRORS) {
-            app_state.state = BRAKE_STATE_STOPPED;
-            Motor_Stop();
-        }
+    for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+        UpdatePosition(&brakes[i]);
     }
 }
 
 /**
  * @brief Process brake command from CAN
  * 
+ * Runs in main context; the control interrupt is masked while state changes.
+ * 
+ * @param brake Instance
  * @param brake_state Command state (PUSH or RELEASE)
  */
-void Brake_ProcessCommand(uint8_t brake_state)
+void Brake_ProcessCommand(Brake_t *brake, uint8_t brake_state)
 {
-    /* Ignore commands if in error state */
-    if (app_state.state == BRAKE_STATE_STOPPED && position_error_count >= MAX_POSITION_ERRORS) {
+    ControlLoop_Lock();
+    if (ApplyCommand(brake, brake_state)) {
+        /* New operation without reception time - stop tracking the old one */
+        brake->cmd_timing.valid = false;
+    }
+    ControlLoop_Unlock();
+}
+
+/**
+ * @brief Process brake command and track its latency
+ * 
+ * @param brake Instance
+ * @param brake_state Command state (PUSH or RELEASE)
+ * @param msg_id Brake command MSG_Id
+ * @param rx_cycles GetCycles() time of frame reception
+ */
+void Brake_ProcessCommandTimed(Brake_t *brake, uint8_t brake_state, uint8_t msg_id, uint32_t rx_cycles)
+{
+    ControlLoop_Lock();
+    if (ApplyCommand(brake, brake_state)) {
+        brake->cmd_rx_cycles = rx_cycles;
+        brake->cmd_timing.msg_id = msg_id;
+        brake->cmd_timing.valid = true;
+        brake->cmd_timing.actuated = false;
+        brake->cmd_timing.completed = false;
+        brake->cmd_timing.actuation_us = 0;
+        brake->cmd_timing.completion_ms = 0;
+    }
+    ControlLoop_Unlock();
+}
+
+/**
+ * @brief Get timing of the last command that started an operation
+ * 
+ * @param brake Instance
+ * @param timing Output (snapshot)
+ */
+void Brake_GetCommandTiming(const Brake_t *brake, Brake_CommandTiming_t *timing)
+{
+    if (timing == NULL) {
         return;
     }
     
+    ControlLoop_Lock();
+    *timing = brake->cmd_timing;
+    ControlLoop_Unlock();
+}
+
+/**
+ * @brief Record first motor drive of the tracked command (control ISR)
+ * 
+ * @param brake Instance
+ */
+static void CommandTiming_Actuated(Brake_t *brake)
+{
+    if (!brake->cmd_timing.valid || brake->cmd_timing.actuated) {
+        return;
+    }
+    
+    brake->cmd_timing.actuation_us = (GetCycles() - brake->cmd_rx_cycles) / (SystemCoreClock / 1000000u);
+    brake->cmd_timing.actuated = true;
+}
+
+/**
+ * @brief Record completion of the tracked command (control ISR)
+ * 
+ * @param brake Instance
+ */
+static void CommandTiming_Update(Brake_t *brake)
+{
+    if (!brake->cmd_timing.valid || brake->cmd_timing.completed || !brake->cmd_timing.actuated) {
+        return;
+    }
+    
+    if (brake->state == BRAKE_STATE_PUSHED || brake->state == BRAKE_STATE_RELEASED) {
+        brake->cmd_timing.completion_ms = (GetCycles() - brake->cmd_rx_cycles) / (SystemCoreClock / 1000u);
+        brake->cmd_timing.completed = true;
+    }
+}
+
+/**
+ * @brief Start push/release operation for a command
+ * 
+ * @param brake Instance
+ * @param brake_state Command state (PUSH or RELEASE)
+ * @return true if a new operation was started
+ */
+static bool ApplyCommand(Brake_t *brake, uint8_t brake_state)
+{
+    /* Ignore commands if in error state */
+    if (brake->state == BRAKE_STATE_STOPPED && brake->position_error_count >= MAX_POSITION_ERRORS) {
+        return false;
+    }
+    
     if (brake_state == AUTOMATE_LEFT_BRAKE_CMD_BRAKE_STATE_PUSH_CHOICE) {
         /* Command to push brake */
-        if (app_state.state != BRAKE_STATE_PUSHING && 
-            app_state.state != BRAKE_STATE_PUSHED) {
+        if (brake->state != BRAKE_STATE_PUSHING && 
+            brake->state != BRAKE_STATE_PUSHED) {
             
-            app_state.state = BRAKE_STATE_PUSHING;
-            app_state.target_position = POSITION_PUSHED;
-            operation_start_tick = HAL_GetTick();
-            estimated_operation_time_ms = ESTIMATED_PUSH_TIME_MS;
+            brake->state = BRAKE_STATE_PUSHING;
+            brake->operation_start_tick = HAL_GetTick();
+            brake->stroke_start_position = brake->current_position;
+            UpdateOperationEstimate(brake);
+            Profile_Start(brake, brake->end_stops.pushed);
+            return true;
         }
     }
     else if (brake_state == AUTOMATE_LEFT_BRAKE_CMD_BRAKE_STATE_RELEASE_CHOICE) {
         /* Command to release brake */
-        if (app_state.state != BRAKE_STATE_RELEASING && 
-            app_state.state != BRAKE_STATE_RELEASED) {
+        if (brake->state != BRAKE_STATE_RELEASING && 
+            brake->state != BRAKE_STATE_RELEASED) {
             
-            app_state.state = BRAKE_STATE_RELEASING;
-            app_state.target_position = POSITION_RELEASED;
-            operation_start_tick = HAL_GetTick();
-            estimated_operation_time_ms = ESTIMATED_RELEASE_TIME_MS;
+            brake->state = BRAKE_STATE_RELEASING;
+            brake->operation_start_tick = HAL_GetTick();
+            brake->stroke_start_position = brake->current_position;
+            UpdateOperationEstimate(brake);
+            Profile_Start(brake, brake->end_stops.released);
+            return true;
         }
     }
+    
+    return false;
 }
 
 /**
- * @brief Update brake state machine
+ * @brief Run state machine of one instance
  * 
- * Call this periodically from main loop to execute state transitions
+ * @param brake Instance
  */
-void Brake_Update(void)
+static void UpdateStateMachine(Brake_t *brake)
 {
-    uint16_t pos = current_position;
+    uint16_t pos = brake->current_position;
     uint32_t current_tick = HAL_GetTick();
     
     /* Check for operation timeout */
-    if ((app_state.state == BRAKE_STATE_PUSHING || app_state.state == BRAKE_STATE_RELEASING) &&
-        (current_tick - operation_start_tick) > POSITION_TIMEOUT_MS) {
+    if ((brake->state == BRAKE_STATE_PUSHING || brake->state == BRAKE_STATE_RELEASING) &&
+        (current_tick - brake->operation_start_tick) > POSITION_TIMEOUT_MS) {
         /* Operation timed out - stop motor and enter error state */
-        app_state.state = BRAKE_STATE_STOPPED;
-        Motor_Stop();
+        brake->state = BRAKE_STATE_STOPPED;
+        Motor_Stop(brake);
         return;
     }
     
-    switch (app_state.state)
+    switch (brake->state)
     {
         case BRAKE_STATE_PUSHING:
         {
             /* Update time estimate */
-            UpdateOperationEstimate();
+            UpdateOperationEstimate(brake);
+            
+            if (brake->control_mode == BRAKE_CONTROL_PROFILED) {
+                if (ProfiledControl_Update(brake)) {
+                    StrokeModel_Learn(brake);
+                    brake->state = BRAKE_STATE_PUSHED;
+                    Motor_Stop(brake);
+                }
+                break;
+            }
             
             /* Check if reached target */
-            if (pos >= (POSITION_PUSHED - POSITION_TOLERANCE)) {
-                app_state.state = BRAKE_STATE_PUSHED;
-                Motor_Stop();
+            if (pos >= (brake->end_stops.pushed - POSITION_TOLERANCE)) {
+                StrokeModel_Learn(brake);
+                brake->state = BRAKE_STATE_PUSHED;
+                Motor_Stop(brake);
             } else {
                 /* Continue pushing */
-                Motor_SetDirection(true);
-                Motor_SetPWM(MOTOR_DUTY_PUSH);
+                Motor_SetDirection(brake, true);
+                Motor_SetPWM(brake, MOTOR_DUTY_PUSH);
             }
             break;
         }
@@ -341,16 +1150,26 @@ void Brake_Update(void)
         case BRAKE_STATE_RELEASING:
         {
             /* Update time estimate */
-            UpdateOperationEstimate();
+            UpdateOperationEstimate(brake);
+            
+            if (brake->control_mode == BRAKE_CONTROL_PROFILED) {
+                if (ProfiledControl_Update(brake)) {
+                    StrokeModel_Learn(brake);
+                    brake->state = BRAKE_STATE_RELEASED;
+                    Motor_Stop(brake);
+                }
+                break;
+            }
             
             /* Check if reached target */
-            if (pos <= (POSITION_RELEASED + POSITION_TOLERANCE)) {
-                app_state.state = BRAKE_STATE_RELEASED;
-                Motor_Stop();
+            if (pos <= (brake->end_stops.released + POSITION_TOLERANCE)) {
+                StrokeModel_Learn(brake);
+                brake->state = BRAKE_STATE_RELEASED;
+                Motor_Stop(brake);
             } else {
                 /* Continue releasing */
-                Motor_SetDirection(false);
-                Motor_SetPWM(MOTOR_DUTY_RELEASE);
+                Motor_SetDirection(brake, false);
+                Motor_SetPWM(brake, MOTOR_DUTY_RELEASE);
             }
             break;
         }
@@ -358,58 +1177,282 @@ void Brake_Update(void)
         case BRAKE_STATE_PUSHED:
         case BRAKE_STATE_RELEASED:
             /* Target reached - ensure motor is stopped */
-            Motor_Stop();
-            estimated_operation_time_ms = 0;
+            Motor_Stop(brake);
+            brake->time_to_end_ms = 0;
             break;
             
         case BRAKE_STATE_STOPPED:
         default:
             /* Error or unknown state - stop motor */
-            Motor_Stop();
-            estimated_operation_time_ms = 0;
+            Motor_Stop(brake);
+            brake->time_to_end_ms = 0;
             break;
     }
+    
+    CommandTiming_Update(brake);
+}
+
+/**
+ * @brief Update brake state machines
+ * 
+ * Runs from the TIM1 update interrupt as CONTROL_TASK_STATE_MACHINE, once
+ * per control tick (CONTROL_TICK_HZ, 1 kHz), right after the position task.
+ */
+void Brake_Update(void)
+{
+    for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+        UpdateStateMachine(&brakes[i]);
+    }
+}
+
+/**
+ * @brief Get brake state
+ * 
+ * @param brake Instance
+ * @return Current state
+ */
+BrakeState_t Brake_GetState(const Brake_t *brake)
+{
+    return brake->state;
+}
+
+/**
+ * @brief Select motor control mode
+ * 
+ * @param brake Instance
+ * @param mode New control mode
+ * @return false if an operation is in progress
+ */
+bool Brake_SetControlMode(Brake_t *brake, Brake_ControlMode_t mode)
+{
+    bool changed = false;
+    
+    if (mode != BRAKE_CONTROL_FIXED_DUTY && mode != BRAKE_CONTROL_PROFILED) {
+        return false;
+    }
+    
+    ControlLoop_Lock();
+    if (brake->state != BRAKE_STATE_PUSHING && brake->state != BRAKE_STATE_RELEASING) {
+        brake->control_mode = mode;
+        changed = true;
+    }
+    ControlLoop_Unlock();
+    
+    return changed;
+}
+
+/**
+ * @brief Get active motor control mode
+ * 
+ * @param brake Instance
+ * @return Current control mode
+ */
+Brake_ControlMode_t Brake_GetControlMode(const Brake_t *brake)
+{
+    return brake->control_mode;
+}
+
+/**
+ * @brief Set profiled controller tuning
+ * 
+ * @param brake Instance
+ * @param params New tuning
+ * @return false if parameters are invalid
+ */
+bool Brake_SetControlParams(Brake_t *brake, const Brake_ControlParams_t *params)
+{
+    if (params == NULL || params->max_velocity <= 0 || params->acceleration <= 0) {
+        return false;
+    }
+    
+    ControlLoop_Lock();
+    brake->control_params = *params;
+    ControlLoop_Unlock();
+    
+    return true;
+}
+
+/**
+ * @brief Get profiled controller tuning
+ * 
+ * @param brake Instance
+ * @param params Output tuning
+ */
+void Brake_GetControlParams(const Brake_t *brake, Brake_ControlParams_t *params)
+{
+    if (params != NULL) {
+        ControlLoop_Lock();
+        *params = brake->control_params;
+        ControlLoop_Unlock();
+    }
 }
 
 /**
  * @brief Get estimated time to end of operation
  * 
+ * @param brake Instance
  * @return Estimated remaining time in milliseconds
  */
-uint16_t Brake_GetTimeToEnd(void)
+uint16_t Brake_GetTimeToEnd(const Brake_t *brake)
 {
-    if (app_state.state == BRAKE_STATE_PUSHING || 
-        app_state.state == BRAKE_STATE_RELEASING) {
-        
-        uint32_t elapsed = HAL_GetTick() - operation_start_tick;
-        
-        if (elapsed < estimated_operation_time_ms) {
-            return (uint16_t)(estimated_operation_time_ms - elapsed);
-        }
+    uint32_t time_to_end = brake->time_to_end_ms;
+    
+    if (brake->state != BRAKE_STATE_PUSHING && brake->state != BRAKE_STATE_RELEASING) {
+        return 0;
+    }
+    
+    return (time_to_end > 0xFFFFu) ? 0xFFFFu : (uint16_t)time_to_end;
+}
+
+/**
+ * @brief Set learned stroke velocities
+ * 
+ * @param brake Instance
+ * @param model Velocities to continue learning from
+ * @return false if a velocity is outside the model limits
+ */
+bool Brake_SetStrokeModel(Brake_t *brake, const Brake_StrokeModel_t *model)
+{
+    if (model == NULL || !IsStrokeModelValid(model)) {
+        return false;
+    }
+    
+    ControlLoop_Lock();
+    brake->stroke_model = *model;
+    ControlLoop_Unlock();
+    
+    return true;
+}
+
+/**
+ * @brief Get learned stroke velocities
+ * 
+ * @param brake Instance
+ * @param model Output velocities
+ */
+void Brake_GetStrokeModel(const Brake_t *brake, Brake_StrokeModel_t *model)
+{
+    if (model != NULL) {
+        ControlLoop_Lock();
+        *model = brake->stroke_model;
+        ControlLoop_Unlock();
+    }
+}
+
+/**
+ * @brief Set end stop positions
+ * 
+ * @param brake Instance
+ * @param end_stops New end stops
+ * @return false if invalid or the instance is moving
+ */
+bool Brake_SetEndStops(Brake_t *brake, const Brake_EndStops_t *end_stops)
+{
+    bool changed = false;
+    
+    if (end_stops == NULL || !AreEndStopsValid(end_stops)) {
+        return false;
     }
     
-    return 0;
+    ControlLoop_Lock();
+    if (brake->state != BRAKE_STATE_PUSHING && brake->state != BRAKE_STATE_RELEASING) {
+        brake->end_stops = *end_stops;
+        changed = true;
+    }
+    ControlLoop_Unlock();
+    
+    return changed;
+}
+
+/**
+ * @brief Get end stop positions
+ * 
+ * @param brake Instance
+ * @param end_stops Output end stops
+ */
+void Brake_GetEndStops(const Brake_t *brake, Brake_EndStops_t *end_stops)
+{
+    if (end_stops != NULL) {
+        ControlLoop_Lock();
+        *end_stops = brake->end_stops;
+        ControlLoop_Unlock();
+    }
+}
+
+/**
+ * @brief Check whether Brake_Init() restored a stored calibration
+ * 
+ * @return true if restored
+ */
+bool Brake_IsCalibrationRestored(void)
+{
+    return calibration_restored;
+}
+
+/**
+ * @brief Store calibration of all instances if it changed
+ * 
+ * @return true if the stored copy is up to date
+ */
+bool Brake_SaveCalibration(void)
+{
+    Brake_Calibration_t current;
+    bool moving = false;
+    
+    memset(&current, 0, sizeof(current));
+    current.adc_calibration = adc_calibration;
+    
+    ControlLoop_Lock();
+    for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+        moving = moving || brakes[i].state == BRAKE_STATE_PUSHING || brakes[i].state == BRAKE_STATE_RELEASING;
+        current.brake[i].end_stops = brakes[i].end_stops;
+        current.brake[i].stroke_model = brakes[i].stroke_model;
+    }
+    ControlLoop_Unlock();
+    
+    /* Uncalibrated ADC (sampling failed to start) is not worth keeping */
+    if (moving || !adc_sampling) {
+        return false;
+    }
+    
+    if (!Calibration_HasChanged(&current)) {
+        return true;
+    }
+    
+    if (!Storage_Write(STORAGE_KEY_CALIBRATION, &current, sizeof(current))) {
+        return false;
+    }
+    
+    calibration_stored = current;
+    calibration_is_stored = true;
+    
+    return true;
 }
 
 /**
  * @brief Get current position
  * 
+ * @param brake Instance
  * @return Current ADC position value (0-4095)
  */
-uint16_t Brake_GetPosition(void)
+uint16_t Brake_GetPosition(const Brake_t *brake)
 {
-    return current_position;
+    return brake->current_position;
 }
 
 /**
  * @brief Emergency stop - immediately halt motor
  * 
  * Call this in case of emergency or system shutdown
+ * 
+ * @param brake Instance
  */
-void Brake_EmergencyStop(void)
+void Brake_EmergencyStop(Brake_t *brake)
 {
-    Motor_Stop();
-    app_state.state = BRAKE_STATE_STOPPED;
+    ControlLoop_Lock();
+    Motor_Stop(brake);
+    brake->state = BRAKE_STATE_STOPPED;
+    ControlLoop_Unlock();
 }
 
 /**
@@ -417,27 +1460,37 @@ void Brake_EmergencyStop(void)
  * 
  * Attempts to recover from error state
  * 
+ * @param brake Instance
  * @return true if reset successful, false if still in error
  */
-bool Brake_ClearError(void)
+bool Brake_ClearError(Brake_t *brake)
 {
-    position_error_count = 0;
+    bool recovered;
+    
+    ControlLoop_Lock();
+    recovered = RecoverState(brake);
+    ControlLoop_Unlock();
+    
+    return recovered;
+}
+
+/**
+ * @brief Reset error counter and re-derive state from position
+ * 
+ * @param brake Instance
+ * @return true if position is valid
+ */
+static bool RecoverState(Brake_t *brake)
+{
+    brake->position_error_count = 0;
     
     /* Read current position */
-    Brake_UpdatePosition();
+    ADC_DrainSamples();
+    UpdatePosition(brake);
     
     /* Determine state based on position */
-    if (IsPositionValid(current_position)) {
-        if (current_position <= (POSITION_RELEASED + POSITION_TOLERANCE)) {
-            app_state.state = BRAKE_STATE_RELEASED;
-            app_state.target_position = POSITION_RELEASED;
-        } else if (current_position >= (POSITION_PUSHED - POSITION_TOLERANCE)) {
-            app_state.state = BRAKE_STATE_PUSHED;
-            app_state.target_position = POSITION_PUSHED;
-        } else {
-            app_state.state = BRAKE_STATE_RELEASED;
-            app_state.target_position = POSITION_RELEASED;
-        }
+    if (IsPositionValid(brake->current_position)) {
+        StateFromPosition(brake);
         return true;
     }
     
@@ -447,30 +1500,64 @@ bool Brake_ClearError(void)
 /**
  * @brief Check if brake is in error state
  * 
+ * @param brake Instance
  * @return true if error detected
  */
-bool Brake_HasError(void)
+bool Brake_HasError(const Brake_t *brake)
 {
-    return (position_error_count >= MAX_POSITION_ERRORS);
+    return (brake->position_error_count >= MAX_POSITION_ERRORS);
+}
+
+/**
+ * @brief Get filtered position at oversampled resolution
+ * 
+ * @param brake Instance
+ * @return 14-bit position value (0-16383)
+ */
+uint16_t Brake_GetPositionHighRes(const Brake_t *brake)
+{
+    return (uint16_t)(brake->filter_sum / POSITION_FILTER_WINDOW);
+}
+
+/**
+ * @brief Get PWM cycle at which the newest filtered sample completed
+ * 
+ * Scans are exactly ADC_PWM_CYCLES_PER_SCAN cycles apart and ranks of one
+ * scan ADC_PWM_CYCLES_PER_SAMPLE apart; the absolute value is accurate to
+ * one control tick.
+ * 
+ * @param brake Instance
+ * @return PWM cycle count since TIM1 start
+ */
+uint32_t Brake_GetPositionCycle(const Brake_t *brake)
+{
+    uint32_t rank_lag = (BRAKE_COUNT - 1u - brake->config->adc_rank) * ADC_PWM_CYCLES_PER_SAMPLE;
+    
+    return adc_seed_cycle + (adc_scan_count * ADC_PWM_CYCLES_PER_SCAN) - rank_lag;
 }
 
 /**
  * @brief Get position in percentage (0-100%)
  * 
+ * @param brake Instance
  * @return Position as percentage where 0% = released, 100% = pushed
  */
-uint8_t Brake_GetPositionPercent(void)
+uint8_t Brake_GetPositionPercent(const Brake_t *brake)
 {
-    if (current_position <= POSITION_RELEASED) {
+    uint16_t position = brake->current_position;
+    uint16_t released = brake->end_stops.released;
+    uint16_t pushed = brake->end_stops.pushed;
+    
+    if (position <= released) {
         return 0;
     }
-    if (current_position >= POSITION_PUSHED) {
+    if (position >= pushed) {
         return 100;
     }
     
     /* Calculate percentage between released and pushed */
-    uint32_t range = POSITION_PUSHED - POSITION_RELEASED;
-    uint32_t offset = current_position - POSITION_RELEASED;
+    uint32_t range = pushed - released;
+    uint32_t offset = position - released;
     
     return (uint8_t)((offset * 100) / range);
 }
\ No newline at end of file
@@ -27,6 +27,11 @@
 #include "left_break.h"
 #include "can.h"
 #include "controller.h"
+#include "control_loop.h"
+#include "profile.h"
+#include "scheduler.h"
+#include "trace.h"
+#include "storage.h"
 
 /* USER CODE END Includes */
 
@@ -47,19 +52,20 @@
 
 /* Private variables ---------------------------------------------------------*/
 ADC_HandleTypeDef hadc1;
+DMA_HandleTypeDef hdma_adc1;
 
 FDCAN_HandleTypeDef hfdcan1;
 
 TIM_HandleTypeDef htim1;
 
 /* USER CODE BEGIN PV */
-AppState_t app_state = {0};
 
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_FDCAN1_Init(void);
 static void MX_ADC1_Init(void);
 static void MX_TIM1_Init(void);
@@ -101,20 +107,29 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_FDCAN1_Init();
   MX_ADC1_Init();
   MX_TIM1_Init();
   /* USER CODE BEGIN 2 */
   
   // Ініціалізація після MX_Init
-  HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
-  HAL_ADC_Start(&hadc1);
-  HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED);
+  HAL_TIM_Base_Start_IT(&htim1);  // Такт керування 1 кГц (update кожні 20 періодів ШІМ)
+  // ШІМ каналів приводів (CH1 лівий, CH3 правий) і АЦП (TIM1 TRGO2, скан IN2/IN1 з DMA) стартують у Brake_Init()
   
   // Ініціалізація складових пристрою
+  Profile_Init();  // DWT профілювання гарячих ділянок (лише з PROFILING_ENABLED)
   CAN_Driver_Init();  // Ініціалізація CAN зʼєднання
-  Brake_Init(); // Ініціалізація привода тормозу
-  Controller_Init();  // Ініціалізація бізнеслогики
+  Storage_Init();  // Пошук останніх записів у flash (калібрування, конфігурація)
+  Brake_Init(); // Ініціалізація приводів тормозу (BRAKE_COUNT)
+  Trace_Init();  // Запис позиції 1 кГц для налаштування механіки (вимкнено до команди)
+  Controller_Init();  // Ініціалізація бізнеслогики (включно з CAN фільтрами)
+  
+  if (!CAN_Driver_Start()) {  // Запуск FDCAN після налаштування фільтрів
+    Error_Handler();
+  }
+  
+  ControlLoop_Start();  // Позиція та state machine - у перериванні TIM1 (1 кГц)
 
   /* USER CODE END 2 */
 
@@ -126,25 +141,15 @@ int main(void)
 
     /* USER CODE BEGIN 3 */
 
-      // Оновлення позиції (10 мс)
-      Brake_UpdatePosition();
+      // Оновлення позиції та state machine виконуються в ControlLoop (TIM1, 1 мс)
       
-      // State machine (20 мс)
-      Brake_Update();
+      // CAN передача виконується з CAN_Driver_Send() та TX-complete переривання
       
-      // CAN передача
-      CAN_Driver_Transmit();
-      
-      // Бізнес-логіка (heartbeat 50ms, telemetry 100ms)
+      // Бізнес-логіка: таблиця задач (CAN RX/TX, heartbeat 50ms, telemetry 100ms,
+      // контроль зв'язку з PC та health 10ms, LED 25ms, діагностика 500ms)
       Business_Loop();
-      
-      // Перевірка зв'язку з PC
-//      if (!Controller_IsPCAlive()) {
-          // PC не відповідає > 200 мс
-          // Можлива захисна дія
-//      }
     
-    HAL_Delay(1); /* Small delay to prevent busy loop */
+    Scheduler_Idle(); /* Sleep until next interrupt (TIM1, SysTick, FDCAN), counts idle time */
   }
   /* USER CODE END 3 */
 }
@@ -216,21 +221,25 @@ static void MX_ADC1_Init(void)
   /** Common config
   */
   hadc1.Instance = ADC1;
-  hadc1.Init.ClockPrescaler = ADC_CLOCK_ASYNC_DIV4;
+  hadc1.Init.ClockPrescaler = ADC_CLOCK_ASYNC_DIV16;
   hadc1.Init.Resolution = ADC_RESOLUTION_12B;
   hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
   hadc1.Init.GainCompensation = 0;
-  hadc1.Init.ScanConvMode = ADC_SCAN_DISABLE;
+  hadc1.Init.ScanConvMode = ADC_SCAN_ENABLE;
   hadc1.Init.EOCSelection = ADC_EOC_SINGLE_CONV;
   hadc1.Init.LowPowerAutoWait = DISABLE;
   hadc1.Init.ContinuousConvMode = DISABLE;
-  hadc1.Init.NbrOfConversion = 1;
+  hadc1.Init.NbrOfConversion = 2;
   hadc1.Init.DiscontinuousConvMode = DISABLE;
-  hadc1.Init.ExternalTrigConv = ADC_SOFTWARE_START;
-  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_NONE;
-  hadc1.Init.DMAContinuousRequests = DISABLE;
-  hadc1.Init.Overrun = ADC_OVR_DATA_PRESERVED;
-  hadc1.Init.OversamplingMode = DISABLE;
+  hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIG_T1_TRGO2;
+  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+  hadc1.Init.DMAContinuousRequests = ENABLE;
+  hadc1.Init.Overrun = ADC_OVR_DATA_OVERWRITTEN;
+  hadc1.Init.OversamplingMode = ENABLE;
+  hadc1.Init.Oversampling.Ratio = ADC_OVERSAMPLING_RATIO_8;
+  hadc1.Init.Oversampling.RightBitShift = ADC_RIGHTBITSHIFT_1;
+  hadc1.Init.Oversampling.TriggeredMode = ADC_TRIGGEREDMODE_MULTI_TRIGGER;
+  hadc1.Init.Oversampling.OversamplingStopReset = ADC_REGOVERSAMPLING_CONTINUED_MODE;
   if (HAL_ADC_Init(&hadc1) != HAL_OK)
   {
     Error_Handler();
@@ -248,7 +257,7 @@ static void MX_ADC1_Init(void)
   */
   sConfig.Channel = ADC_CHANNEL_2;
   sConfig.Rank = ADC_REGULAR_RANK_1;
-  sConfig.SamplingTime = ADC_SAMPLETIME_247CYCLES_5;
+  sConfig.SamplingTime = ADC_SAMPLETIME_92CYCLES_5;
   sConfig.SingleDiff = ADC_SINGLE_ENDED;
   sConfig.OffsetNumber = ADC_OFFSET_NONE;
   sConfig.Offset = 0;
@@ -256,12 +265,38 @@ static void MX_ADC1_Init(void)
   {
     Error_Handler();
   }
+
+  /** Configure Regular Channel
+  */
+  sConfig.Channel = ADC_CHANNEL_1;
+  sConfig.Rank = ADC_REGULAR_RANK_2;
+  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
   /* USER CODE BEGIN ADC1_Init 2 */
 
   /* USER CODE END ADC1_Init 2 */
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMAMUX1_CLK_ENABLE();
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Channel1_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, 6, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+
+}
+
 /**
   * @brief FDCAN1 Initialization Function
   * @param None
@@ -293,13 +328,26 @@ static void MX_FDCAN1_Init(void)
   hfdcan1.Init.DataTimeSeg1 = 1;
   hfdcan1.Init.DataTimeSeg2 = 1;
   hfdcan1.Init.StdFiltersNbr = 0;
-  hfdcan1.Init.ExtFiltersNbr = 0;
+  hfdcan1.Init.ExtFiltersNbr = 5;
   hfdcan1.Init.TxFifoQueueMode = FDCAN_TX_FIFO_OPERATION;
   if (HAL_FDCAN_Init(&hfdcan1) != HAL_OK)
   {
     Error_Handler();
   }
   /* USER CODE BEGIN FDCAN1_Init 2 */
+#if CAN_FD_ENABLED
+  // CAN FD з перемиканням швидкості: арбітраж лишається 500 кбіт/с,
+  // фаза даних 2 Мбіт/с (170 МГц / 5 = 34 МГц, 1 + 13 + 3 = 17 tq, точка вибірки 82%)
+  hfdcan1.Init.FrameFormat = FDCAN_FRAME_FD_BRS;
+  hfdcan1.Init.DataPrescaler = 5;
+  hfdcan1.Init.DataSyncJumpWidth = 3;
+  hfdcan1.Init.DataTimeSeg1 = 13;
+  hfdcan1.Init.DataTimeSeg2 = 3;
+  if (HAL_FDCAN_Init(&hfdcan1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+#endif
 
   /* USER CODE END FDCAN1_Init 2 */
 
@@ -330,7 +378,7 @@ static void MX_TIM1_Init(void)
   htim1.Init.CounterMode = TIM_COUNTERMODE_UP;
   htim1.Init.Period = 8499;
   htim1.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
-  htim1.Init.RepetitionCounter = 0;
+  htim1.Init.RepetitionCounter = 19;
   htim1.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
   if (HAL_TIM_Base_Init(&htim1) != HAL_OK)
   {
@@ -346,7 +394,7 @@ static void MX_TIM1_Init(void)
     Error_Handler();
   }
   sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
-  sMasterConfig.MasterOutputTrigger2 = TIM_TRGO2_RESET;
+  sMasterConfig.MasterOutputTrigger2 = TIM_TRGO2_OC4REF;
   sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
   if (HAL_TIMEx_MasterConfigSynchronization(&htim1, &sMasterConfig) != HAL_OK)
   {
@@ -363,6 +411,16 @@ static void MX_TIM1_Init(void)
   {
     Error_Handler();
   }
+  if (HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_3) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sConfigOC.OCMode = TIM_OCMODE_PWM2;
+  sConfigOC.Pulse = 1000;
+  if (HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_4) != HAL_OK)
+  {
+    Error_Handler();
+  }
   sBreakDeadTimeConfig.OffStateRunMode = TIM_OSSR_DISABLE;
   sBreakDeadTimeConfig.OffStateIDLEMode = TIM_OSSI_DISABLE;
   sBreakDeadTimeConfig.LockLevel = TIM_LOCKLEVEL_OFF;
@@ -408,7 +466,7 @@ static void MX_GPIO_Init(void)
   HAL_GPIO_WritePin(MOTOR_INH_GPIO_Port, MOTOR_INH_Pin, GPIO_PIN_RESET);
 
   /*Configure GPIO pin Output Level */
-  HAL_GPIO_WritePin(STATUS_LED_GPIO_Port, STATUS_LED_Pin, GPIO_PIN_RESET);
+  HAL_GPIO_WritePin(GPIOB, STATUS_LED_Pin|RIGHT_MOTOR_INH_Pin, GPIO_PIN_RESET);
 
   /*Configure GPIO pin : MOTOR_INH_Pin */
   GPIO_InitStruct.Pin = MOTOR_INH_Pin;
@@ -417,12 +475,12 @@ static void MX_GPIO_Init(void)
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
   HAL_GPIO_Init(MOTOR_INH_GPIO_Port, &GPIO_InitStruct);
 
-  /*Configure GPIO pin : STATUS_LED_Pin */
-  GPIO_InitStruct.Pin = STATUS_LED_Pin;
+  /*Configure GPIO pins : STATUS_LED_Pin RIGHT_MOTOR_INH_Pin */
+  GPIO_InitStruct.Pin = STATUS_LED_Pin|RIGHT_MOTOR_INH_Pin;
   GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
   GPIO_InitStruct.Pull = GPIO_NOPULL;
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-  HAL_GPIO_Init(STATUS_LED_GPIO_Port, &GPIO_InitStruct);
+  HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
   /* USER CODE BEGIN MX_GPIO_Init_2 */
 
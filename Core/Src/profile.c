@@ -0,0 +1,129 @@
+/**
+ * @file profile.c
+ * @brief Cycle-accurate hot-path profiling with the DWT cycle counter
+ */
+
+#include "profile.h"
+
+#if PROFILING_ENABLED
+
+#include "can.h"
+
+/* ============================================================================
+ * Private Constants
+ * ============================================================================ */
+
+/* Name table, indexed by Profile_SectionId_t */
+static const char *const section_names[PROFILE_SECTION_COUNT] = {
+    [PROFILE_FDCAN_RX_ISR] = "fdcan_rx_isr",
+    [PROFILE_PROCESS_RX] = "process_rx",
+    [PROFILE_PACK] = "pack",
+    [PROFILE_ADC_READ] = "adc_read",
+    [PROFILE_TICK_WAKE] = "tick_wake",
+    [PROFILE_TICK_ACTIVE] = "tick_active",
+};
+
+/* ============================================================================
+ * Public Variables
+ * ============================================================================ */
+
+Profile_Section_t profile_sections[PROFILE_SECTION_COUNT];
+
+/* ============================================================================
+ * Private Functions
+ * ============================================================================ */
+
+/**
+ * @brief Saturate cycle count to 16 bits for CAN export
+ */
+static uint16_t Profile_Saturate16(uint32_t value)
+{
+    return (value > 0xFFFFu) ? 0xFFFFu : (uint16_t)value;
+}
+
+/* ============================================================================
+ * Public Functions
+ * ============================================================================ */
+
+/**
+ * @brief Enable cycle counter and clear all sections
+ */
+void Profile_Init(void)
+{
+    EnableCycleCounter();
+    
+    for (uint32_t i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        profile_sections[i].name = section_names[i];
+        profile_sections[i].count = 0;
+        profile_sections[i].min = UINT32_MAX;
+        profile_sections[i].max = 0;
+        profile_sections[i].total = 0;
+    }
+}
+
+/**
+ * @brief Add one measurement to a section
+ */
+void Profile_Record(Profile_SectionId_t id, uint32_t cycles)
+{
+    Profile_Section_t *s;
+    
+    if (id >= PROFILE_SECTION_COUNT) {
+        return;
+    }
+    
+    s = &profile_sections[id];
+    if (cycles < s->min) {
+        s->min = cycles;
+    }
+    if (cycles > s->max) {
+        s->max = cycles;
+    }
+    s->total += cycles;
+    s->count++;
+}
+
+/**
+ * @brief Get average cycles of a section
+ */
+uint32_t Profile_GetAverage(Profile_SectionId_t id)
+{
+    if (id >= PROFILE_SECTION_COUNT || profile_sections[id].count == 0) {
+        return 0;
+    }
+    
+    return (uint32_t)(profile_sections[id].total / profile_sections[id].count);
+}
+
+/**
+ * @brief Queue one PROFILE_CAN_FRAME_ID frame per section
+ */
+bool Profile_ExportCan(void)
+{
+    bool ok = true;
+    
+    for (uint32_t i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        const Profile_Section_t *s = &profile_sections[i];
+        uint16_t min = (s->count > 0) ? Profile_Saturate16(s->min) : 0u;
+        uint16_t max = Profile_Saturate16(s->max);
+        uint16_t avg = Profile_Saturate16(Profile_GetAverage((Profile_SectionId_t)i));
+        uint8_t data[8];
+        
+        data[0] = (uint8_t)i;
+        data[1] = (uint8_t)s->count;
+        data[2] = (uint8_t)min;
+        data[3] = (uint8_t)(min >> 8);
+        data[4] = (uint8_t)max;
+        data[5] = (uint8_t)(max >> 8);
+        data[6] = (uint8_t)avg;
+        data[7] = (uint8_t)(avg >> 8);
+        
+        if (!CAN_Driver_Send(PROFILE_CAN_FRAME_ID, data, sizeof(data))) {
+            ok = false;
+        }
+    }
+    
+    return ok;
+}
+
+#endif /* PROFILING_ENABLED */
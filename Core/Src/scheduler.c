@@ -0,0 +1,282 @@
+/**
+ * @file scheduler.c
+ * @brief Cooperative background task scheduler with deadline tracking
+ */
+
+#include <string.h>
+#include "common.h"
+#include "scheduler.h"
+
+/* ============================================================================
+ * Private Variables
+ * ============================================================================ */
+
+static const Scheduler_Task_t *task_table = NULL;
+static uint8_t task_count = 0;
+
+/* Absolute release time of the next run, and period in force, per task */
+static uint32_t next_release[SCHEDULER_MAX_TASKS];
+static uint16_t task_period[SCHEDULER_MAX_TASKS];
+static Scheduler_TaskStats_t task_stats[SCHEDULER_MAX_TASKS];
+
+/* CPU load window: idle cycles are summed by Scheduler_Idle() */
+static uint32_t load_window_tick = 0;
+static uint32_t load_window_cycles = 0;
+static uint32_t idle_cycles = 0;
+static uint8_t cpu_load = 0;
+
+/* Wake window: set from wake-up until Scheduler_Idle() returns */
+static volatile bool idle_waking = false;
+static volatile uint32_t idle_wake_cycle = 0;
+#if LOW_POWER_IDLE_ENABLED
+static bool idle_low_power = false;
+#endif
+
+/* ============================================================================
+ * Private Functions
+ * ============================================================================ */
+
+/**
+ * @brief Close the CPU load window once it has elapsed
+ */
+static void UpdateCpuLoad(uint32_t now)
+{
+    uint32_t total, idle;
+    
+    if (now - load_window_tick < SCHEDULER_LOAD_WINDOW_MS) {
+        return;
+    }
+    
+    total = GetCycles() - load_window_cycles;
+    idle = idle_cycles;
+    
+    /* Divide total first: idle * 100 would overflow for long windows */
+    total /= 100u;
+    if (total != 0u) {
+        idle /= total;
+        cpu_load = (uint8_t)((idle < 100u) ? (100u - idle) : 0u);
+    }
+    
+    load_window_tick = now;
+    load_window_cycles = GetCycles();
+    idle_cycles = 0;
+}
+
+/* ============================================================================
+ * Public Functions
+ * ============================================================================ */
+
+/**
+ * @brief Install task table and start schedule at current time
+ */
+bool Scheduler_Init(const Scheduler_Task_t *tasks, uint8_t count)
+{
+    uint32_t now = GetTick();
+    
+    if (tasks == NULL || count > SCHEDULER_MAX_TASKS) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (tasks[i].fn == NULL) {
+            return false;
+        }
+    }
+    
+    /* WCET is measured with the DWT cycle counter */
+    EnableCycleCounter();
+    
+    task_table = tasks;
+    task_count = count;
+    for (uint8_t i = 0; i < count; i++) {
+        next_release[i] = now + tasks[i].offset_ms;
+        task_period[i] = tasks[i].period_ms;
+    }
+    Scheduler_ResetStats();
+    
+    load_window_tick = now;
+    load_window_cycles = GetCycles();
+    idle_cycles = 0;
+    cpu_load = 0;
+    
+    return true;
+}
+
+/**
+ * @brief Run all tasks that are due
+ */
+void Scheduler_Run(void)
+{
+    UpdateCpuLoad(GetTick());
+    
+    for (uint8_t i = 0; i < task_count; i++) {
+        const Scheduler_Task_t *task = &task_table[i];
+        Scheduler_TaskStats_t *stats = &task_stats[i];
+        uint32_t now = GetTick();
+        uint32_t start, exec;
+        
+        if (task_period[i] != 0) {
+            uint32_t lateness = now - next_release[i];
+            
+            /* Not released yet (wrap-safe signed compare) */
+            if ((int32_t)lateness < 0) {
+                continue;
+            }
+            
+            if (lateness > stats->max_lateness_ms) {
+                stats->max_lateness_ms = lateness;
+            }
+            if (lateness > task->deadline_ms) {
+                stats->deadline_misses++;
+            }
+            
+            /* Keep the phase: skip releases that are already in the past */
+            next_release[i] += task_period[i];
+            while ((int32_t)(now - next_release[i]) >= 0) {
+                next_release[i] += task_period[i];
+                stats->skipped++;
+            }
+        }
+        
+        start = GetCycles();
+        task->fn();
+        exec = GetCycles() - start;
+        
+        if (exec > stats->max_exec_cycles) {
+            stats->max_exec_cycles = exec;
+        }
+        stats->runs++;
+    }
+}
+
+/**
+ * @brief Change the release period of a periodic task
+ * 
+ * The next release moves to the previous release plus the new period, or
+ * to now if that has already passed, so a shorter period takes effect at
+ * once and no release is reported late or skipped.
+ */
+bool Scheduler_SetPeriod(uint8_t index, uint16_t period_ms)
+{
+    uint32_t now = GetTick();
+    uint32_t release;
+    
+    if (index >= task_count || period_ms == 0u || task_period[index] == 0u) {
+        return false;
+    }
+    
+    release = next_release[index] - task_period[index] + period_ms;
+    next_release[index] = ((int32_t)(now - release) > 0) ? now : release;
+    task_period[index] = period_ms;
+    
+    return true;
+}
+
+/**
+ * @brief Get the release period in force for a task
+ */
+uint16_t Scheduler_GetPeriod(uint8_t index)
+{
+    return (index < task_count) ? task_period[index] : 0u;
+}
+
+/**
+ * @brief Get statistics of a task
+ */
+bool Scheduler_GetTaskStats(uint8_t index, Scheduler_TaskStats_t *stats)
+{
+    if (index >= task_count || stats == NULL) {
+        return false;
+    }
+    
+    *stats = task_stats[index];
+    return true;
+}
+
+/**
+ * @brief Clear statistics of all tasks
+ */
+void Scheduler_ResetStats(void)
+{
+    memset(task_stats, 0, sizeof(task_stats));
+}
+
+/**
+ * @brief Total overruns of all tasks
+ */
+uint32_t Scheduler_GetOverruns(void)
+{
+    uint32_t overruns = 0;
+    
+    for (uint8_t i = 0; i < task_count; i++) {
+        overruns += task_stats[i].deadline_misses + task_stats[i].skipped;
+    }
+    
+    return overruns;
+}
+
+/**
+ * @brief Sleep until the next interrupt and account the idle time
+ * 
+ * Interrupts are masked around WFI: a pending interrupt still wakes the
+ * core, but its handler only runs after the wake timestamp is taken, so
+ * handler time counts as load rather than idle.
+ */
+void Scheduler_Idle(void)
+{
+    uint32_t start;
+    uint32_t wake;
+    
+    __disable_irq();
+    start = GetCycles();
+    __WFI();
+    wake = GetCycles();
+    idle_cycles += wake - start;
+    idle_wake_cycle = wake;
+    idle_waking = true;
+    __enable_irq();
+    
+    /* Handlers of the interrupts that woke the core have run */
+    idle_waking = false;
+}
+
+/**
+ * @brief Get the wake-up time while interrupts woken by it are running
+ */
+bool Scheduler_GetWakeCycle(uint32_t *cycle)
+{
+    if (!idle_waking) {
+        return false;
+    }
+    
+    *cycle = idle_wake_cycle;
+    return true;
+}
+
+/**
+ * @brief Select flash power-down during sleep
+ */
+void Scheduler_SetLowPowerIdle(bool enable)
+{
+#if LOW_POWER_IDLE_ENABLED
+    if (enable == idle_low_power) {
+        return;
+    }
+    
+    if (enable) {
+        __HAL_FLASH_SLEEP_POWERDOWN_ENABLE();
+    } else {
+        __HAL_FLASH_SLEEP_POWERDOWN_DISABLE();
+    }
+    idle_low_power = enable;
+#else
+    (void)enable;
+#endif
+}
+
+/**
+ * @brief CPU load of the last completed window
+ */
+uint8_t Scheduler_GetCpuLoad(void)
+{
+    return cpu_load;
+}
@@ -0,0 +1,419 @@
+/**
+ * @file storage.c
+ * @brief Wear-levelled persistent records in the STORAGE flash region
+ * 
+ * Record slots are written once per page erase, whole double words at a
+ * time. A slot is free only if every byte still reads as erased (0xFF), so
+ * a slot left half programmed by a reset is skipped rather than reused.
+ * 
+ * Such a slot can also hold a double word whose ECC code was not written
+ * completely. Reading it raises the flash ECC double error NMI; the scan
+ * reads each slot once through Storage_IsReadable() so that
+ * Storage_HandleEccError() can return from the NMI and the slot is marked
+ * used without being interpreted.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "common.h"
+#include "storage.h"
+#include "main.h"
+
+/* ============================================================================
+ * Private Constants
+ * ============================================================================ */
+
+#define STORAGE_MAGIC               0x42524B31u     /* "BRK1", bump on layout change */
+#define STORAGE_ERASED_WORD         0xFFFFFFFFu
+#define STORAGE_CRC_POLY            0xEDB88320u     /* CRC-32 (IEEE 802.3), reflected */
+#define STORAGE_ECC_NONE            0xFFFFFFFFu
+
+/* ============================================================================
+ * Private Types
+ * ============================================================================ */
+
+/**
+ * @brief One slot of the log
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t sequence;                      /* Increments per write, newest wins */
+    uint16_t key;
+    uint16_t length;
+    uint8_t data[STORAGE_DATA_MAX];
+    uint32_t crc;                           /* Over all preceding bytes */
+} Storage_Record_t;
+
+/**
+ * @brief Record image programmed a double word at a time
+ */
+typedef union {
+    Storage_Record_t record;
+    uint64_t dwords[sizeof(Storage_Record_t) / sizeof(uint64_t)];
+} Storage_Image_t;
+
+_Static_assert((sizeof(Storage_Record_t) % sizeof(uint64_t)) == 0u,
+               "Storage records are programmed in whole double words");
+_Static_assert((FLASH_PAGE_SIZE % sizeof(Storage_Record_t)) == 0u,
+               "Storage records must tile a flash page");
+
+#define STORAGE_SLOTS_PER_PAGE      (FLASH_PAGE_SIZE / sizeof(Storage_Record_t))
+
+_Static_assert(STORAGE_KEY_COUNT < STORAGE_SLOTS_PER_PAGE,
+               "A rotated page needs a free slot after one copy per key");
+
+/* ============================================================================
+ * Private Variables
+ * ============================================================================ */
+
+/* STORAGE region bounds, from STM32G431XX_FLASH.ld */
+extern const uint8_t _storage_start[];
+extern const uint8_t _storage_end[];
+
+static bool storage_ready = false;
+static uint32_t storage_page = 0;           /* Page being appended to */
+static uint32_t storage_next_slot = 0;      /* First free slot of that page */
+static uint32_t storage_sequence = 0;       /* Sequence of the next record */
+
+/* Region offset of the last ECC double error, set from the NMI */
+static volatile uint32_t storage_ecc_offset = STORAGE_ECC_NONE;
+
+/* Newest valid record per key, NULL if none */
+static const Storage_Record_t *storage_latest[STORAGE_KEY_COUNT];
+
+/* ============================================================================
+ * Private Functions
+ * ============================================================================ */
+
+/**
+ * @brief Get a record slot in flash
+ * 
+ * @param page Page of the STORAGE region
+ * @param slot Slot of the page
+ */
+static const Storage_Record_t *Storage_GetSlot(uint32_t page, uint32_t slot)
+{
+    return (const Storage_Record_t *)(_storage_start + (page * FLASH_PAGE_SIZE) +
+                                      (slot * sizeof(Storage_Record_t)));
+}
+
+/**
+ * @brief CRC-32 of a byte range, bitwise (records are short and written rarely)
+ */
+static uint32_t Storage_Crc32(const uint8_t *data, uint32_t length)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    
+    for (uint32_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint32_t bit = 0; bit < 8u; bit++) {
+            crc = (crc >> 1) ^ (STORAGE_CRC_POLY & (0u - (crc & 1u)));
+        }
+    }
+    
+    return ~crc;
+}
+
+/**
+ * @brief Read every double word of a slot, catching ECC double errors
+ * 
+ * @return false if a double word of the slot failed ECC and must not be used
+ */
+static bool Storage_IsReadable(const Storage_Record_t *slot)
+{
+    const volatile uint32_t *words = (const volatile uint32_t *)slot;
+    uint32_t offset = (uint32_t)((const uint8_t *)slot - _storage_start);
+    
+    storage_ecc_offset = STORAGE_ECC_NONE;
+    for (uint32_t i = 0; i < sizeof(Storage_Record_t) / sizeof(uint32_t); i++) {
+        (void)words[i];
+    }
+    __DSB();                                /* NMI of the last read taken before the check */
+    
+    return (storage_ecc_offset - offset) >= sizeof(Storage_Record_t);
+}
+
+/**
+ * @brief Check that a slot was never programmed since the last erase
+ */
+static bool Storage_IsErased(const Storage_Record_t *slot)
+{
+    const uint32_t *words = (const uint32_t *)slot;
+    
+    for (uint32_t i = 0; i < sizeof(Storage_Record_t) / sizeof(uint32_t); i++) {
+        if (words[i] != STORAGE_ERASED_WORD) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Check magic, key, length and CRC of a slot
+ */
+static bool Storage_IsValid(const Storage_Record_t *slot)
+{
+    return (slot->magic == STORAGE_MAGIC) &&
+           (slot->key < STORAGE_KEY_COUNT) &&
+           (slot->length <= STORAGE_DATA_MAX) &&
+           (slot->crc == Storage_Crc32((const uint8_t *)slot, offsetof(Storage_Record_t, crc)));
+}
+
+/**
+ * @brief Check whether sequence a was written after sequence b (wrap safe)
+ */
+static bool Storage_IsNewer(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) > 0;
+}
+
+/**
+ * @brief Erase one page of the STORAGE region
+ * 
+ * @return true if erased
+ */
+static bool Storage_ErasePage(uint32_t page)
+{
+    FLASH_EraseInitTypeDef erase;
+    uint32_t page_error = 0;
+    HAL_StatusTypeDef status;
+    
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.Banks = FLASH_BANK_1;
+    erase.Page = (((uint32_t)(uintptr_t)_storage_start - FLASH_BASE) / FLASH_PAGE_SIZE) + page;
+    erase.NbPages = 1;
+    
+    HAL_FLASH_Unlock();
+    status = HAL_FLASHEx_Erase(&erase, &page_error);
+    HAL_FLASH_Lock();
+    
+    return status == HAL_OK;
+}
+
+/**
+ * @brief Program a record image into the next free slot of the active page
+ * 
+ * The slot is consumed even if programming fails, it is no longer erased.
+ * 
+ * @return Programmed record, NULL on failure
+ */
+static const Storage_Record_t *Storage_Program(const Storage_Image_t *image)
+{
+    const Storage_Record_t *slot = Storage_GetSlot(storage_page, storage_next_slot);
+    HAL_StatusTypeDef status = HAL_OK;
+    
+    storage_next_slot++;
+    
+    HAL_FLASH_Unlock();
+    for (uint32_t i = 0; i < sizeof(image->dwords) / sizeof(image->dwords[0]) && status == HAL_OK; i++) {
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, (uint32_t)(uintptr_t)slot + (i * sizeof(uint64_t)),
+                                   image->dwords[i]);
+    }
+    HAL_FLASH_Lock();
+    
+    if (status != HAL_OK || memcmp(slot, &image->record, sizeof(Storage_Record_t)) != 0) {
+        return NULL;
+    }
+    
+    return slot;
+}
+
+/**
+ * @brief Move to the other page, carrying the newest record of each key
+ * 
+ * Copies keep their sequence numbers, so until a new record is written
+ * after them the old page still holds the newest record and is picked
+ * again at boot. On failure the old page stays active and full, and the
+ * next write retries the rotation.
+ * 
+ * @return true if the new page is ready for writing
+ */
+static bool Storage_Rotate(void)
+{
+    const Storage_Record_t *copies[STORAGE_KEY_COUNT];
+    uint32_t old_page = storage_page;
+    Storage_Image_t image;
+    
+    storage_page = (storage_page + 1u) % STORAGE_PAGE_COUNT;
+    storage_next_slot = 0;
+    
+    if (!Storage_ErasePage(storage_page)) {
+        storage_page = old_page;
+        storage_next_slot = STORAGE_SLOTS_PER_PAGE;
+        return false;
+    }
+    
+    for (uint32_t key = 0; key < STORAGE_KEY_COUNT; key++) {
+        copies[key] = NULL;
+        if (storage_latest[key] == NULL) {
+            continue;
+        }
+    
+        memcpy(&image.record, storage_latest[key], sizeof(Storage_Record_t));
+        copies[key] = Storage_Program(&image);
+        if (copies[key] == NULL) {
+            storage_page = old_page;
+            storage_next_slot = STORAGE_SLOTS_PER_PAGE;
+            return false;
+        }
+    }
+    
+    for (uint32_t key = 0; key < STORAGE_KEY_COUNT; key++) {
+        if (copies[key] != NULL) {
+            storage_latest[key] = copies[key];
+        }
+    }
+    
+    return true;
+}
+
+/* ============================================================================
+ * Public Functions
+ * ============================================================================ */
+
+/**
+ * @brief Scan the STORAGE region for the newest record of each key
+ */
+void Storage_Init(void)
+{
+    uint32_t used[STORAGE_PAGE_COUNT] = { 0 };
+    const Storage_Record_t *newest = NULL;
+    
+    storage_ready = false;
+    storage_page = 0;
+    storage_sequence = 0;
+    for (uint32_t key = 0; key < STORAGE_KEY_COUNT; key++) {
+        storage_latest[key] = NULL;
+    }
+    
+    /* Region too small for the configured pages - keep storage disabled */
+    if ((uint32_t)(_storage_end - _storage_start) < (STORAGE_PAGE_COUNT * FLASH_PAGE_SIZE)) {
+        return;
+    }
+    
+    for (uint32_t page = 0; page < STORAGE_PAGE_COUNT; page++) {
+        for (uint32_t slot = 0; slot < STORAGE_SLOTS_PER_PAGE; slot++) {
+            const Storage_Record_t *record = Storage_GetSlot(page, slot);
+    
+            /* Torn by a reset during programming - unusable, but not free */
+            if (!Storage_IsReadable(record)) {
+                used[page] = slot + 1u;
+                continue;
+            }
+    
+            if (Storage_IsErased(record)) {
+                continue;
+            }
+            used[page] = slot + 1u;
+    
+            if (!Storage_IsValid(record)) {
+                continue;
+            }
+    
+            if (storage_latest[record->key] == NULL ||
+                Storage_IsNewer(record->sequence, storage_latest[record->key]->sequence)) {
+                storage_latest[record->key] = record;
+            }
+            if (newest == NULL || Storage_IsNewer(record->sequence, newest->sequence)) {
+                newest = record;
+                storage_page = page;
+            }
+        }
+    }
+    
+    /* Append after the last programmed slot of the page with the newest record */
+    storage_next_slot = used[storage_page];
+    if (newest != NULL) {
+        storage_sequence = newest->sequence + 1u;
+    }
+    
+    storage_ready = true;
+}
+
+/**
+ * @brief Acknowledge a flash ECC double error inside the STORAGE region
+ */
+bool Storage_HandleEccError(void)
+{
+    uint32_t region = (uint32_t)(uintptr_t)_storage_start - FLASH_BASE;
+    uint32_t eccr = FLASH->ECCR;
+    uint32_t offset;
+    
+    if (!__HAL_FLASH_GET_FLAG(FLASH_FLAG_ECCD) || (eccr & FLASH_ECCR_SYSF_ECC) != 0u) {
+        return false;
+    }
+    
+    /* ADDR_ECC is the offset from the start of the bank */
+    offset = ((eccr & FLASH_ECCR_ADDR_ECC) - region) & FLASH_ECCR_ADDR_ECC;
+    if (offset >= (uint32_t)(_storage_end - _storage_start)) {
+        return false;
+    }
+    
+    storage_ecc_offset = offset;
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ECCD);
+    return true;
+}
+
+/**
+ * @brief Copy the newest valid record of a key
+ */
+bool Storage_Read(Storage_Key_t key, void *data, uint16_t size)
+{
+    const Storage_Record_t *record;
+    
+    if (!storage_ready || key >= STORAGE_KEY_COUNT || data == NULL) {
+        return false;
+    }
+    
+    record = storage_latest[key];
+    if (record == NULL || record->length != size) {
+        return false;
+    }
+    
+    memcpy(data, record->data, size);
+    return true;
+}
+
+/**
+ * @brief Append a new record for a key
+ */
+bool Storage_Write(Storage_Key_t key, const void *data, uint16_t size)
+{
+    const Storage_Record_t *latest;
+    const Storage_Record_t *written;
+    Storage_Image_t image;
+    
+    if (!storage_ready || key >= STORAGE_KEY_COUNT || data == NULL || size > STORAGE_DATA_MAX) {
+        return false;
+    }
+    
+    /* Unchanged value - spare the flash */
+    latest = storage_latest[key];
+    if (latest != NULL && latest->length == size && memcmp(latest->data, data, size) == 0) {
+        return true;
+    }
+    
+    memset(&image, 0xFF, sizeof(image));
+    image.record.magic = STORAGE_MAGIC;
+    image.record.sequence = storage_sequence;
+    image.record.key = (uint16_t)key;
+    image.record.length = size;
+    memcpy(image.record.data, data, size);
+    image.record.crc = Storage_Crc32((const uint8_t *)&image.record, offsetof(Storage_Record_t, crc));
+    
+    /* Page full - continue on the other one */
+    if (storage_next_slot >= STORAGE_SLOTS_PER_PAGE && !Storage_Rotate()) {
+        return false;
+    }
+    
+    written = Storage_Program(&image);
+    if (written == NULL) {
+        return false;
+    }
+    
+    storage_latest[key] = written;
+    storage_sequence++;
+    
+    return true;
+}
@@ -0,0 +1,322 @@
+/**
+ * @file trace.c
+ * @brief High-rate brake position trace streamed as delta-encoded CAN frames
+ * 
+ * Concurrency model:
+ * - The control interrupt owns the ring while CAPTURING and may start a
+ *   new capture from IDLE or READY.
+ * - The main loop owns the ring while STREAMING; it enters and leaves
+ *   that state with the control interrupt masked (ControlLoop_Lock()).
+ */
+
+#include <string.h>
+#include "common.h"
+#include "trace.h"
+#include "left_break.h"
+#include "control_loop.h"
+
+/* ============================================================================
+ * Private Constants
+ * ============================================================================ */
+
+#define TRACE_BUFFER_MASK           (TRACE_BUFFER_SIZE - 1u)
+#define TRACE_BASE_MASK             0x0FFFu
+#define TRACE_DELTA_MIN             (-8)
+#define TRACE_DELTA_MAX             7
+
+_Static_assert(((TRACE_BUFFER_SIZE & TRACE_BUFFER_MASK) == 0u) && (TRACE_BUFFER_SIZE <= 0x8000u),
+               "TRACE_BUFFER_SIZE must be a power of 2 up to 32768");
+_Static_assert(CONTROL_TICK_HZ == 1000u, "Trace timestamps assume one sample per millisecond");
+
+/* ============================================================================
+ * Private Variables
+ * ============================================================================ */
+
+/* Capture ring, indexed by free-running sample count */
+static uint16_t trace_samples[TRACE_BUFFER_SIZE];
+
+static volatile Trace_State_t trace_state = TRACE_STATE_IDLE;
+static volatile bool trace_armed = false;
+
+/* Capture description (written by the control interrupt while CAPTURING) */
+static uint32_t trace_count = 0;            /* Samples recorded, may exceed ring size */
+static uint32_t trace_start_tick = 0;       /* HAL_GetTick() of sample 0 */
+static uint8_t trace_brake = 0;             /* Instance being recorded */
+static BrakeState_t trace_end_state = BRAKE_STATE_RELEASED;
+
+/* Previous state per instance, to catch the start of a push/release */
+static BrakeState_t trace_last_state[BRAKE_COUNT];
+
+/* Stream cursor (main loop only) */
+static volatile bool stream_requested = false;
+static Trace_State_t stream_resume_state = TRACE_STATE_IDLE;
+static uint32_t stream_first = 0;           /* Sample count of the oldest retained sample */
+static uint32_t stream_total = 0;           /* Retained samples */
+static uint32_t stream_sent = 0;            /* Samples already sent */
+static uint8_t stream_seq = 0;
+static bool stream_info_sent = false;
+
+/* ============================================================================
+ * Private Functions
+ * ============================================================================ */
+
+/**
+ * @brief Check for a moving brake state
+ */
+static bool Trace_IsMoving(BrakeState_t state)
+{
+    return (state == BRAKE_STATE_PUSHING) || (state == BRAKE_STATE_RELEASING);
+}
+
+/**
+ * @brief Position of a retained sample
+ * 
+ * @param index Free-running sample index
+ */
+static uint16_t Trace_GetSample(uint32_t index)
+{
+    return trace_samples[index & TRACE_BUFFER_MASK];
+}
+
+/**
+ * @brief Queue the TRACE_INFO_FRAME_ID frame of the current stream
+ * 
+ * @return true if queued
+ */
+static bool Trace_SendInfo(void)
+{
+    uint32_t first_tick = trace_start_tick + stream_first;
+    uint8_t data[8];
+    
+    data[0] = trace_brake;
+    data[1] = (uint8_t)trace_end_state;
+    if (stream_first != 0u) {
+        data[1] |= TRACE_INFO_FLAG_WRAPPED;
+    }
+    data[2] = (uint8_t)stream_total;
+    data[3] = (uint8_t)(stream_total >> 8);
+    data[4] = (uint8_t)first_tick;
+    data[5] = (uint8_t)(first_tick >> 8);
+    data[6] = (uint8_t)(first_tick >> 16);
+    data[7] = (uint8_t)(first_tick >> 24);
+    
+    return CAN_Driver_Send(TRACE_INFO_FRAME_ID, data, sizeof(data));
+}
+
+/**
+ * @brief Delta-encode up to TRACE_SAMPLES_PER_FRAME samples into one frame
+ * 
+ * @param data Frame payload (TRACE_FRAME_LEN bytes)
+ * @param first Free-running index of the frame's first sample
+ * @param count Samples to encode (1-TRACE_SAMPLES_PER_FRAME)
+ */
+static void Trace_PackFrame(uint8_t *data, uint32_t first, uint32_t count)
+{
+    uint16_t base = Trace_GetSample(first) & TRACE_BASE_MASK;
+    int32_t reconstructed = base;
+    uint32_t bit = TRACE_DELTA_FIRST_BIT;
+    
+    memset(data, 0, TRACE_FRAME_LEN);
+    data[0] = stream_seq;
+    data[1] = (uint8_t)base;
+    data[2] = (uint8_t)(base >> 8);
+    
+    /* Deltas are nibble aligned, so each one lands inside a single byte */
+    for (uint32_t i = 1; i < count; i++) {
+        int32_t delta = (int32_t)Trace_GetSample(first + i) - reconstructed;
+    
+        if (delta < TRACE_DELTA_MIN) {
+            delta = TRACE_DELTA_MIN;
+        } else if (delta > TRACE_DELTA_MAX) {
+            delta = TRACE_DELTA_MAX;
+        }
+    
+        /* Track what the receiver rebuilds, so clipping does not accumulate */
+        reconstructed += delta;
+        data[bit >> 3] |= (uint8_t)(((uint32_t)delta & 0x0Fu) << (bit & 7u));
+        bit += TRACE_DELTA_BITS;
+    }
+}
+
+/**
+ * @brief Start streaming the last capture
+ * 
+ * A request without any capture streams an info frame with zero samples.
+ * 
+ * @return true if the stream was started (request consumed)
+ */
+static bool Trace_BeginStream(void)
+{
+    bool started = false;
+    
+    ControlLoop_Lock();
+    if (trace_state == TRACE_STATE_READY || trace_state == TRACE_STATE_IDLE) {
+        stream_resume_state = trace_state;
+        stream_total = (trace_state == TRACE_STATE_IDLE) ? 0u
+                     : ((trace_count > TRACE_BUFFER_SIZE) ? TRACE_BUFFER_SIZE : trace_count);
+        stream_first = (trace_state == TRACE_STATE_IDLE) ? 0u : (trace_count - stream_total);
+        trace_state = TRACE_STATE_STREAMING;
+        started = true;
+    }
+    ControlLoop_Unlock();
+    
+    if (started) {
+        stream_sent = 0;
+        stream_seq = 0;
+        stream_info_sent = false;
+    }
+    
+    return started;
+}
+
+/* ============================================================================
+ * Public Functions
+ * ============================================================================ */
+
+/**
+ * @brief Clear capture and disarm
+ */
+void Trace_Init(void)
+{
+    trace_state = TRACE_STATE_IDLE;
+    trace_armed = false;
+    trace_count = 0;
+    trace_start_tick = 0;
+    trace_brake = 0;
+    trace_end_state = BRAKE_STATE_RELEASED;
+    stream_requested = false;
+    
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        trace_last_state[i] = Brake_GetState(Brake_Get(i));
+    }
+}
+
+/**
+ * @brief Record one sample (control task)
+ */
+void Trace_Sample(void)
+{
+    Trace_State_t state = trace_state;
+    const Brake_t *brake;
+    BrakeState_t brake_state;
+    
+    /* Start on the first control tick of a push or release */
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        bool started;
+    
+        brake_state = Brake_GetState(Brake_Get(i));
+        started = Trace_IsMoving(brake_state) && (brake_state != trace_last_state[i]);
+        trace_last_state[i] = brake_state;
+    
+        if (started && trace_armed && (state == TRACE_STATE_IDLE || state == TRACE_STATE_READY)) {
+            trace_brake = i;
+            trace_count = 0;
+            trace_start_tick = HAL_GetTick();
+            state = TRACE_STATE_CAPTURING;
+        }
+    }
+    
+    if (state != TRACE_STATE_CAPTURING) {
+        return;
+    }
+    
+    brake = Brake_Get(trace_brake);
+    brake_state = Brake_GetState(brake);
+    
+    trace_samples[trace_count & TRACE_BUFFER_MASK] = Brake_GetPosition(brake);
+    trace_count++;
+    
+    /* Final sample is the first one after the brake stopped moving */
+    if (!Trace_IsMoving(brake_state)) {
+        trace_end_state = brake_state;
+        state = TRACE_STATE_READY;
+    }
+    
+    trace_state = state;
+}
+
+/**
+ * @brief Apply a TRACE_CMD_FRAME_ID command
+ */
+bool Trace_Command(uint8_t command)
+{
+    switch (command) {
+        case TRACE_CMD_DISARM:
+            ControlLoop_Lock();
+            trace_armed = false;
+            stream_requested = false;
+            if (trace_state == TRACE_STATE_CAPTURING) {
+                /* Keep what was recorded so far */
+                trace_end_state = Brake_GetState(Brake_Get(trace_brake));
+                trace_state = TRACE_STATE_READY;
+            } else if (trace_state == TRACE_STATE_STREAMING) {
+                trace_state = stream_resume_state;
+            }
+            ControlLoop_Unlock();
+            return true;
+    
+        case TRACE_CMD_ARM:
+            trace_armed = true;
+            return true;
+    
+        case TRACE_CMD_STREAM:
+            stream_requested = true;
+            return true;
+    
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Queue the next stream frame (background task)
+ */
+void Trace_Stream(void)
+{
+    uint8_t data[TRACE_FRAME_LEN];
+    uint32_t count;
+    
+    /* A request during a capture is served once the brake stops */
+    if (stream_requested && Trace_BeginStream()) {
+        stream_requested = false;
+    }
+    
+    if (trace_state != TRACE_STATE_STREAMING) {
+        return;
+    }
+    
+    /* Low priority: leave the TX queue to control frames */
+    if (CAN_Driver_GetTxCount() >= TRACE_TX_QUEUE_LIMIT) {
+        return;
+    }
+    
+    if (!stream_info_sent) {
+        stream_info_sent = Trace_SendInfo();
+        return;
+    }
+    
+    if (stream_sent >= stream_total) {
+        /* Control interrupt does not touch the state while STREAMING */
+        trace_state = stream_resume_state;
+        return;
+    }
+    
+    count = stream_total - stream_sent;
+    if (count > TRACE_SAMPLES_PER_FRAME) {
+        count = TRACE_SAMPLES_PER_FRAME;
+    }
+    
+    Trace_PackFrame(data, stream_first + stream_sent, count);
+    if (CAN_Driver_Send(TRACE_DATA_FRAME_ID, data, sizeof(data))) {
+        stream_sent += count;
+        stream_seq++;
+    }
+}
+
+/**
+ * @brief Get capture state
+ */
+Trace_State_t Trace_GetState(void)
+{
+    return trace_state;
+}
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Collect PERF metrics of performance_tests.robot into a comparable report.
+
+Reads the Robot Framework output.xml, picks every logged "PERF <name>=<value>"
+line and writes them as JSON together with the git commit and the test
+verdicts. With --baseline the metrics are compared against an earlier
+report; all metrics are lower-is-better.
+
+    python3 perf_report.py test_results/perf/output.xml -o perf_results/HEAD.json
+    python3 perf_report.py test_results/perf/output.xml --baseline perf_results/main.json
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+import xml.etree.ElementTree as ET
+
+PREFIX = "PERF "
+
+
+def git_commit():
+    try:
+        return subprocess.check_output(["git", "rev-parse", "--short", "HEAD"],
+                                       stderr=subprocess.DEVNULL, text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def parse_output(path):
+    root = ET.parse(path).getroot()
+    metrics = {}
+    tests = {}
+
+    for test in root.iter("test"):
+        status = test.find("status")
+        tests[test.get("name")] = status.get("status") if status is not None else "UNKNOWN"
+        for msg in test.iter("msg"):
+            text = (msg.text or "").strip()
+            if not text.startswith(PREFIX):
+                continue
+            name, _, value = text[len(PREFIX):].partition("=")
+            try:
+                metrics[name.strip()] = float(value)
+            except ValueError:
+                pass
+
+    return metrics, tests
+
+
+def compare(metrics, baseline, tolerance):
+    """Print a delta table, return the names of metrics that got worse."""
+    regressions = []
+
+    print(f"{'metric':<28} {'baseline':>10} {'current':>10} {'delta':>10}")
+    for name in sorted(set(metrics) | set(baseline)):
+        old = baseline.get(name)
+        new = metrics.get(name)
+        if old is None or new is None:
+            print(f"{name:<28} {str(old):>10} {str(new):>10} {'-':>10}")
+            continue
+        delta = new - old
+        # Relative tolerance, but at least one unit so 0 -> 1 on a counter is caught
+        worse = delta >= max(abs(old) * tolerance, 1.0)
+        flag = "  REGRESSION" if worse else ""
+        print(f"{name:<28} {old:>10g} {new:>10g} {delta:>+10g}{flag}")
+        if worse:
+            regressions.append(name)
+
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("output_xml", help="Robot Framework output.xml of the perf run")
+    parser.add_argument("-o", "--output", help="Write the report as JSON")
+    parser.add_argument("--baseline", help="Earlier JSON report to compare against")
+    parser.add_argument("--tolerance", type=float, default=0.10,
+                        help="Relative increase accepted before flagging (default 0.10)")
+    args = parser.parse_args()
+
+    metrics, tests = parse_output(args.output_xml)
+    report = {"commit": git_commit(), "metrics": metrics, "tests": tests}
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+            f.write("\n")
+    else:
+        print(json.dumps(report, indent=2, sort_keys=True))
+
+    failed = [name for name, status in tests.items() if status != "PASS"]
+    for name in failed:
+        print(f"FAILED: {name}")
+
+    regressions = []
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        print(f"Comparing {report['commit']} against {baseline.get('commit', '?')}")
+        regressions = compare(metrics, baseline.get("metrics", {}), args.tolerance)
+
+    return 1 if failed or regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,177 @@
+/**
+ * @file bench_main.c
+ * @brief Host micro-benchmarks of the CAN rings, codecs and dispatch path
+ * 
+ * Numbers are host nanoseconds per operation. They are only comparable
+ * with each other and across commits on one machine, not with target
+ * cycles (use PROFILING_ENABLED builds on the board for those).
+ * 
+ * Usage: benchmarks [--quick]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "mock_hal.h"
+#include "mock_board.h"
+#include "can.h"
+#include "controller.h"
+#include "automate.h"
+#include "automate_codec.h"
+
+/* ============================================================================
+ * Private Variables
+ * ============================================================================ */
+
+static uint32_t iterations = 1000000u;
+
+/* Results land here so the optimizer keeps the measured work */
+static volatile uint32_t sink;
+
+/* ============================================================================
+ * Private Functions
+ * ============================================================================ */
+
+static uint64_t NowNs(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+static void Report(const char *name, uint64_t start_ns, uint32_t ops)
+{
+    double ns = (double)(NowNs() - start_ns) / (double)ops;
+    
+    printf("%-28s %10.1f ns/op  (%u ops)\n", name, ns, ops);
+}
+
+static void BenchCanTx(void)
+{
+    const uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint64_t start;
+    
+    Mock_Boot();
+    Mock_CanSetAutoComplete(false);
+    
+    start = NowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        sink += CAN_Driver_Send(0x100u + (i & 0xFFu), data, sizeof(data));
+        Mock_CanCompleteTx(1);
+    }
+    Report("can_send+tx_complete", start, iterations);
+}
+
+static void BenchCanRx(void)
+{
+    uint8_t data[AUTOMATE_HEART_BEAT_MSG_LENGTH] = { 0x10, 0, 0, 0, 0, 0, 0, 0 };
+    CAN_Message_t msg;
+    uint64_t start;
+    
+    Mock_Boot();
+    
+    start = NowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        data[1] = (uint8_t)i;
+        Mock_CanReceive(AUTOMATE_HEART_BEAT_MSG_FRAME_ID, true, data, sizeof(data));
+        if (CAN_Driver_Get(&msg)) {
+            sink += msg.data[1];
+        }
+    }
+    Report("can_rx_isr+get", start, iterations);
+}
+
+static void BenchCodec(void)
+{
+    struct automate_left_brake_msg_t msg;
+    uint8_t buf[AUTOMATE_LEFT_BRAKE_MSG_LENGTH];
+    uint64_t start;
+    
+    automate_left_brake_msg_init(&msg);
+    msg.time_to_end_operation = 120;
+    
+    start = NowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        msg.msg_id = (uint8_t)i;
+        msg.stamp = (uint16_t)i;
+        sink += (uint32_t)automate_left_brake_msg_pack(buf, &msg, sizeof(buf));
+        sink += buf[0];
+    }
+    Report("generated_pack", start, iterations);
+    
+    start = NowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        msg.msg_id = (uint8_t)i;
+        msg.stamp = (uint16_t)i;
+        sink += (uint32_t)automate_codec_left_brake_msg_pack(buf, &msg, sizeof(buf));
+        sink += buf[0];
+    }
+    Report("codec_pack", start, iterations);
+    
+    start = NowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        buf[0] = (uint8_t)i;
+        sink += (uint32_t)automate_left_brake_msg_unpack(&msg, buf, sizeof(buf));
+        sink += msg.msg_id;
+    }
+    Report("generated_unpack", start, iterations);
+    
+    start = NowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        buf[0] = (uint8_t)i;
+        sink += (uint32_t)automate_codec_left_brake_msg_unpack(&msg, buf, sizeof(buf));
+        sink += msg.msg_id;
+    }
+    Report("codec_unpack", start, iterations);
+}
+
+static void BenchDispatch(void)
+{
+    struct automate_left_brake_cmd_t cmd;
+    uint8_t data[AUTOMATE_LEFT_BRAKE_CMD_LENGTH];
+    uint32_t ops = iterations / 10u;
+    uint64_t start;
+    
+    Mock_Boot();
+    
+    automate_left_brake_cmd_init(&cmd);
+    cmd.brake_state = AUTOMATE_LEFT_BRAKE_CMD_BRAKE_STATE_RELEASE_CHOICE;
+    
+    start = NowNs();
+    for (uint32_t i = 0; i < ops; i++) {
+        cmd.msg_id = (uint8_t)i;
+        automate_codec_left_brake_cmd_pack(data, &cmd, sizeof(data));
+        Mock_CanReceive(AUTOMATE_LEFT_BRAKE_CMD_FRAME_ID, true, data, sizeof(data));
+        Business_Loop();
+        Mock_CanCompleteTx(MOCK_CAN_FRAMES_PER_MS);
+    }
+    Report("rx_dispatch_loop", start, ops);
+    
+    start = NowNs();
+    for (uint32_t i = 0; i < ops; i++) {
+        Mock_Tick(1);
+        Business_Loop();
+    }
+    Report("control_tick+loop", start, ops);
+}
+
+/* ============================================================================
+ * Main
+ * ============================================================================ */
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0) {
+        iterations = 10000u;
+    }
+    
+    Mock_FlashErase();
+    
+    BenchCanTx();
+    BenchCanRx();
+    BenchCodec();
+    BenchDispatch();
+    
+    return Mock_GetErrorCount() == 0u ? 0 : 1;
+}
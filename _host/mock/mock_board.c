@@ -0,0 +1,69 @@
+/**
+ * @file mock_board.c
+ * @brief main() of the target on the simulated peripherals
+ * 
+ * Mirrors the USER CODE sections of Core/Src/main.c; keep the order in
+ * sync when the start-up sequence changes.
+ */
+
+#include "mock_board.h"
+#include "mock_hal.h"
+#include "main.h"
+#include "can.h"
+#include "controller.h"
+#include "control_loop.h"
+#include "left_break.h"
+#include "profile.h"
+#include "scheduler.h"
+#include "storage.h"
+#include "trace.h"
+
+/**
+ * @brief Reset the peripherals and run the start-up sequence of main()
+ */
+void Mock_Boot(void)
+{
+    Mock_Reset();
+    
+    HAL_TIM_Base_Start_IT(&htim1);
+    
+    Profile_Init();
+    CAN_Driver_Init();
+    Storage_Init();
+    Brake_Init();
+    Trace_Init();
+    Controller_Init();
+    
+    if (!CAN_Driver_Start()) {
+        Error_Handler();
+    }
+    
+    ControlLoop_Start();
+}
+
+/**
+ * @brief NMI_Handler() of Core/Src/stm32g4xx_it.c
+ * 
+ * The target spins on an unhandled NMI; count it as an error instead.
+ */
+void NMI_Handler(void)
+{
+    if (Storage_HandleEccError()) {
+        return;
+    }
+    
+    Error_Handler();
+}
+
+/**
+ * @brief Run the main loop for a time
+ */
+void Mock_Run(uint32_t ms)
+{
+    uint32_t start = HAL_GetTick();
+    
+    while ((HAL_GetTick() - start) < ms) {
+        Business_Loop();
+        Scheduler_Idle();
+    }
+}
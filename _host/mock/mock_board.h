@@ -0,0 +1,42 @@
+/**
+ * @file mock_board.h
+ * @brief main() of the target on the simulated peripherals
+ */
+
+#ifndef MOCK_BOARD_H
+#define MOCK_BOARD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief Reset the peripherals and run the start-up sequence of main()
+ * 
+ * Flash keeps its content, so a second boot restores what the first
+ * one stored. Check Mock_GetErrorCount() afterwards.
+ */
+void Mock_Boot(void);
+
+/**
+ * @brief Run the main loop for a time
+ * 
+ * Business_Loop() and Scheduler_Idle() as in main(); each idle call
+ * sleeps until the next 1 ms tick.
+ * 
+ * @param ms Milliseconds
+ */
+void Mock_Run(uint32_t ms);
+
+/**
+ * @brief NMI_Handler() of the target, raised by the simulated flash
+ */
+void NMI_Handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MOCK_BOARD_H */
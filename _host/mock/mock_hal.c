@@ -0,0 +1,1167 @@
+/**
+ * @file mock_hal.c
+ * @brief Simulated STM32G431 peripherals behind the host HAL replacement
+ * 
+ * Implements the HAL calls made by Core/ with the behaviour the driver
+ * depends on: FDCAN filter elements, 3-element RX/TX FIFOs and start/stop
+ * state, ADC regular scans written by circular DMA, TIM1 compare
+ * registers, GPIO outputs and the two STORAGE flash pages (program erased
+ * double words only, page erase, ECC double errors raising the NMI).
+ */
+
+#include <string.h>
+#include "mock_hal.h"
+#include "mock_board.h"
+#include "main.h"
+#include "left_break.h"
+
+/* ============================================================================
+ * Private Constants
+ * ============================================================================ */
+
+#define MOCK_CAN_HW_FIFO_SIZE       3u      /* FDCAN RX FIFO 0/1 and TX FIFO elements */
+#define MOCK_CAN_STD_FILTERS        28u
+#define MOCK_CAN_EXT_FILTERS        8u
+#define MOCK_CAN_BITS_PER_MS        500u    /* Timestamp counter rate at 500 kbit/s */
+#define MOCK_ADC_RANKS              4u
+#define MOCK_ADC_CALFACT            0x40u   /* Factor returned by a calibration run */
+#define MOCK_PWM_CYCLES_PER_MS      20u     /* TIM1 PWM periods per control tick */
+#define MOCK_PWM_CYCLES_PER_SAMPLE  8u      /* Oversampling ratio, one trigger per PWM period */
+#define MOCK_STORAGE_SIZE           (2u * FLASH_PAGE_SIZE)
+
+/* ============================================================================
+ * Private Types
+ * ============================================================================ */
+
+typedef struct {
+    bool used;
+    FDCAN_FilterTypeDef config;
+} Mock_CanFilter_t;
+
+typedef struct {
+    Mock_CanFrame_t frames[MOCK_CAN_HW_FIFO_SIZE];
+    uint32_t count;
+} Mock_CanFifo_t;
+
+/**
+ * @brief Actuator wired to one TIM1 channel, INH pin and ADC rank
+ */
+typedef struct {
+    uint32_t channel;
+    GPIO_TypeDef *inh_port;
+    uint16_t inh_pin;
+    uint8_t adc_rank;
+} Mock_Plant_t;
+
+/* ============================================================================
+ * Peripheral Instances
+ * ============================================================================ */
+
+static FDCAN_GlobalTypeDef fdcan1_regs;
+static ADC_TypeDef adc1_regs;
+static DMA_Channel_TypeDef dma1_channel1_regs;
+static TIM_TypeDef tim1_regs;
+static TIM_TypeDef tim6_regs;
+static CoreDebug_Type core_debug_regs;
+static DWT_Type dwt_regs;
+static SCB_Type scb_regs;
+static FLASH_TypeDef flash_regs;
+
+FDCAN_GlobalTypeDef *FDCAN1 = &fdcan1_regs;
+ADC_TypeDef *ADC1 = &adc1_regs;
+DMA_Channel_TypeDef *DMA1_Channel1 = &dma1_channel1_regs;
+TIM_TypeDef *TIM1 = &tim1_regs;
+TIM_TypeDef *TIM6 = &tim6_regs;
+CoreDebug_Type *CoreDebug = &core_debug_regs;
+DWT_Type *DWT = &dwt_regs;
+SCB_Type *SCB = &scb_regs;
+FLASH_TypeDef *FLASH = &flash_regs;
+
+GPIO_TypeDef mock_gpioa;
+GPIO_TypeDef mock_gpiob;
+GPIO_TypeDef mock_gpiof;
+
+uint32_t SystemCoreClock = 170000000u;
+bool mock_flash_sleep_pd = false;
+
+/* Handles owned by main.c on the target */
+ADC_HandleTypeDef hadc1;
+DMA_HandleTypeDef hdma_adc1;
+FDCAN_HandleTypeDef hfdcan1;
+TIM_HandleTypeDef htim1;
+
+/* STORAGE region of STM32G431XX_FLASH.ld; _storage_end is set by the linker */
+__attribute__((aligned(2048))) uint8_t _storage_start[MOCK_STORAGE_SIZE];
+
+/* ============================================================================
+ * Private Variables
+ * ============================================================================ */
+
+static uint32_t mock_tick = 0;
+static uint32_t mock_error_count = 0;
+static uint32_t mock_primask = 0;
+
+/* NVIC: TIM1 update interrupt mask and pending flag */
+static bool tim1_irq_enabled = false;
+static bool tim1_irq_pending = false;
+static bool tim1_running = false;
+
+/* Analog inputs, outside the MCU so kept across Mock_Reset() */
+static uint16_t adc_input[MOCK_ADC_RANKS] = { 200, 200, 200, 200 };
+
+/* ADC scan into circular DMA */
+static uint16_t *adc_dma_buffer = NULL;
+static uint32_t adc_dma_length = 0;
+static uint32_t adc_dma_index = 0;
+static uint32_t adc_rank = 0;
+static uint32_t adc_pwm_cycles = 0;
+static uint32_t adc_calfact = 0;
+
+/* Actuator plant, fractional position in 1/256 counts */
+static const Mock_Plant_t plants[BRAKE_COUNT] = {
+    { TIM_CHANNEL_1, MOTOR_INH_GPIO_Port, MOTOR_INH_Pin, 0 },
+#if BRAKE_COUNT > 1
+    { TIM_CHANNEL_3, RIGHT_MOTOR_INH_GPIO_Port, RIGHT_MOTOR_INH_Pin, 1 },
+#endif
+};
+static bool plant_enabled = false;
+static int32_t plant_position[BRAKE_COUNT] = {
+    200 << 8,
+#if BRAKE_COUNT > 1
+    200 << 8,
+#endif
+};
+
+/* FDCAN */
+static bool can_started = false;
+static Mock_CanFilter_t can_std_filters[MOCK_CAN_STD_FILTERS];
+static Mock_CanFilter_t can_ext_filters[MOCK_CAN_EXT_FILTERS];
+static uint32_t can_non_matching_std = FDCAN_ACCEPT_IN_RX_FIFO0;
+static uint32_t can_non_matching_ext = FDCAN_ACCEPT_IN_RX_FIFO0;
+static Mock_CanFifo_t can_rx_fifo[2];
+static Mock_CanFifo_t can_tx_fifo;
+static bool can_auto_complete = true;
+static bool can_tx_irq_pending = false;
+static uint32_t can_bit_time = 0;
+static bool can_bus_off = false;            /* PSR.BO, the core also sets CCCR.INIT */
+static uint32_t can_recovery_left = 0;      /* ms until a restarted core rejoins, 0 = not recovering */
+static uint8_t can_tec = 0;
+static uint8_t can_rec = 0;
+static bool can_error_irq_pending = false;
+
+/* NVIC: FDCAN lines (RX on 0, TX complete on 1), pending RX flags per FIFO */
+static bool can_irq_line_enabled[2] = { true, true };
+static uint32_t can_rx_irq_flags[2];
+static bool can_irq_active = false;         /* Both lines share one priority, no nesting */
+static void (*can_tx_load_hook)(void) = NULL;
+static void (*can_tx_abort_hook)(void) = NULL;
+
+static Mock_CanFrame_t can_sent[MOCK_CAN_SENT_LOG_SIZE];
+static uint32_t can_sent_head = 0;
+static uint32_t can_sent_count = 0;
+
+/* Flash */
+static int32_t flash_fail_after = -1;
+static uint32_t flash_erase_count = 0;
+static uint32_t flash_ecc_offset = MOCK_STORAGE_SIZE;    /* Torn double word, none if outside */
+
+/* ============================================================================
+ * Private Functions
+ * ============================================================================ */
+
+/**
+ * @brief Started and taking part in bus traffic (not bus-off or recovering)
+ */
+static bool Can_OnBus(void)
+{
+    return can_started && !can_bus_off;
+}
+
+static void Fifo_Push(Mock_CanFifo_t *fifo, const Mock_CanFrame_t *frame)
+{
+    fifo->frames[fifo->count++] = *frame;
+}
+
+static void Fifo_Pop(Mock_CanFifo_t *fifo, Mock_CanFrame_t *frame)
+{
+    *frame = fifo->frames[0];
+    fifo->count--;
+    memmove(&fifo->frames[0], &fifo->frames[1], fifo->count * sizeof(fifo->frames[0]));
+}
+
+static uint8_t DlcToLen(uint32_t dlc)
+{
+    static const uint8_t fd_len[] = { 12, 16, 20, 24, 32, 48, 64 };
+    
+    dlc &= 0x0Fu;
+    return (dlc <= 8u) ? (uint8_t)dlc : fd_len[dlc - 9u];
+}
+
+static uint32_t LenToDlc(uint8_t len)
+{
+    static const uint8_t fd_len[] = { 12, 16, 20, 24, 32, 48, 64 };
+    uint32_t dlc = 9;
+    
+    if (len <= 8u) {
+        return len;
+    }
+    for (uint32_t i = 0; i < sizeof(fd_len) && fd_len[i] < len; i++) {
+        dlc++;
+    }
+    return dlc;
+}
+
+/**
+ * @brief Find the RX FIFO a frame is routed to
+ * 
+ * @param filter_index Output: matching element, 0xFF for the global filter
+ * @return 0 or 1 for RX FIFO 0/1, -1 if rejected
+ */
+static int32_t Can_Match(uint32_t id, bool is_extended, uint32_t *filter_index)
+{
+    const Mock_CanFilter_t *filters = is_extended ? can_ext_filters : can_std_filters;
+    uint32_t count = is_extended ? hfdcan1.Init.ExtFiltersNbr : hfdcan1.Init.StdFiltersNbr;
+    uint32_t non_matching = is_extended ? can_non_matching_ext : can_non_matching_std;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        const FDCAN_FilterTypeDef *f = &filters[i].config;
+        bool match;
+    
+        if (!filters[i].used || f->FilterType != FDCAN_FILTER_MASK) {
+            continue;
+        }
+    
+        match = (id & f->FilterID2) == (f->FilterID1 & f->FilterID2);
+        if (!match) {
+            continue;
+        }
+    
+        *filter_index = i;
+        switch (f->FilterConfig) {
+            case FDCAN_FILTER_TO_RXFIFO0:
+            case FDCAN_FILTER_TO_RXFIFO0_HP:
+                return 0;
+            case FDCAN_FILTER_TO_RXFIFO1:
+            case FDCAN_FILTER_TO_RXFIFO1_HP:
+                return 1;
+            default:
+                return -1;
+        }
+    }
+    
+    *filter_index = 0xFFu;
+    if (non_matching == FDCAN_ACCEPT_IN_RX_FIFO0) {
+        return 0;
+    }
+    if (non_matching == FDCAN_ACCEPT_IN_RX_FIFO1) {
+        return 1;
+    }
+    return -1;
+}
+
+/**
+ * @brief Deliver a TIM1 update interrupt, or leave it pending while masked
+ */
+static void Tim1_Update(void)
+{
+    if (!tim1_running) {
+        return;
+    }
+    
+    tim1_irq_pending = true;
+    if (tim1_irq_enabled && mock_primask == 0u) {
+        tim1_irq_pending = false;
+        TIM1->CNT = 0;
+        HAL_TIM_PeriodElapsedCallback(&htim1);
+    }
+}
+
+/**
+ * @brief Move every simulated actuator by one millisecond
+ */
+static void Plant_Step(void)
+{
+    uint32_t arr = TIM1->ARR;
+    
+    if (!plant_enabled || arr == 0u) {
+        return;
+    }
+    
+    for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+        uint32_t ccr = (&TIM1->CCR1)[plants[i].channel >> 2];
+        int32_t step = (int32_t)(((uint64_t)ccr * MOCK_PLANT_COUNTS_PER_MS * 256u) / arr);
+    
+        if (Mock_GpioRead(plants[i].inh_port, plants[i].inh_pin) == GPIO_PIN_RESET) {
+            step = -step;
+        }
+    
+        plant_position[i] += step;
+        if (plant_position[i] < 0) {
+            plant_position[i] = 0;
+        } else if (plant_position[i] > (4095 << 8)) {
+            plant_position[i] = 4095 << 8;
+        }
+        adc_input[plants[i].adc_rank] = (uint16_t)(plant_position[i] >> 8);
+    }
+}
+
+/**
+ * @brief Run the ADC scan for one millisecond of PWM periods
+ */
+static void Adc_Step(void)
+{
+    if (adc_dma_buffer == NULL || adc_dma_length == 0u) {
+        return;
+    }
+    
+    adc_pwm_cycles += MOCK_PWM_CYCLES_PER_MS;
+    while (adc_pwm_cycles >= MOCK_PWM_CYCLES_PER_SAMPLE) {
+        adc_pwm_cycles -= MOCK_PWM_CYCLES_PER_SAMPLE;
+    
+        /* 8x oversampling, sum >> 1 -> 14-bit sample */
+        adc_dma_buffer[adc_dma_index] = (uint16_t)(adc_input[adc_rank] << 2);
+        adc_rank = (adc_rank + 1u) % hadc1.Init.NbrOfConversion;
+        adc_dma_index = (adc_dma_index + 1u) % adc_dma_length;
+        DMA1_Channel1->CNDTR = adc_dma_length - adc_dma_index;
+    }
+}
+
+/**
+ * @brief Run HAL_FDCAN_IRQHandler() if a pending flag has its line unmasked
+ * 
+ * Like the HAL, one handler run services every pending flag whichever
+ * line fired, so an RX interrupt also runs a pending TX complete callback.
+ */
+static void Can_ServiceIrq(void)
+{
+    bool line0 = (can_rx_irq_flags[0] | can_rx_irq_flags[1]) != 0u;
+    bool line1 = can_tx_irq_pending;
+    
+    if (mock_primask != 0u || can_irq_active ||
+        !((line0 && can_irq_line_enabled[0]) || (line1 && can_irq_line_enabled[1]))) {
+        return;
+    }
+    
+    can_irq_active = true;
+    for (uint32_t fifo = 0; fifo < 2u; fifo++) {
+        uint32_t its = can_rx_irq_flags[fifo];
+    
+        if (its == 0u) {
+            continue;
+        }
+        can_rx_irq_flags[fifo] = 0;
+        if (fifo == 0u) {
+            HAL_FDCAN_RxFifo0Callback(&hfdcan1, its);
+        } else {
+            HAL_FDCAN_RxFifo1Callback(&hfdcan1, its);
+        }
+    }
+    if (can_tx_irq_pending) {
+        can_tx_irq_pending = false;
+        HAL_FDCAN_TxBufferCompleteCallback(&hfdcan1, FDCAN_TX_BUFFER0);
+    }
+    can_irq_active = false;
+}
+
+/**
+ * @brief Translate a target flash address into the emulated region
+ * 
+ * Offsets use 32-bit arithmetic, as the driver passes addresses as uint32_t.
+ * 
+ * @return Offset into _storage_start, or MOCK_STORAGE_SIZE if outside
+ */
+static uint32_t Flash_Offset(uint32_t address)
+{
+    uint32_t offset = address - (uint32_t)(uintptr_t)_storage_start;
+    
+    return (offset < MOCK_STORAGE_SIZE) ? offset : MOCK_STORAGE_SIZE;
+}
+
+/* ============================================================================
+ * Test Interface
+ * ============================================================================ */
+
+/**
+ * @brief Put every peripheral and handle into its state after MX_*_Init()
+ */
+void Mock_Reset(void)
+{
+    memset(&fdcan1_regs, 0, sizeof(fdcan1_regs));
+    memset(&adc1_regs, 0, sizeof(adc1_regs));
+    memset(&dma1_channel1_regs, 0, sizeof(dma1_channel1_regs));
+    memset(&tim1_regs, 0, sizeof(tim1_regs));
+    memset(&tim6_regs, 0, sizeof(tim6_regs));
+    memset(&core_debug_regs, 0, sizeof(core_debug_regs));
+    memset(&dwt_regs, 0, sizeof(dwt_regs));
+    memset(&scb_regs, 0, sizeof(scb_regs));
+    memset(&mock_gpioa, 0, sizeof(mock_gpioa));
+    memset(&mock_gpiob, 0, sizeof(mock_gpiob));
+    memset(&mock_gpiof, 0, sizeof(mock_gpiof));
+    
+    /* MX_ADC1_Init(): one regular rank per brake, DMA circular */
+    memset(&hadc1, 0, sizeof(hadc1));
+    memset(&hdma_adc1, 0, sizeof(hdma_adc1));
+    hadc1.Instance = ADC1;
+    hadc1.Init.NbrOfConversion = BRAKE_COUNT;
+    hdma_adc1.Instance = DMA1_Channel1;
+    hdma_adc1.Init.Mode = DMA_CIRCULAR;
+    hadc1.DMA_Handle = &hdma_adc1;
+    hdma_adc1.Parent = &hadc1;
+    
+    /* MX_FDCAN1_Init(): 500 kbit/s from 170 MHz, 4 extended filter elements */
+    memset(&hfdcan1, 0, sizeof(hfdcan1));
+    hfdcan1.Instance = FDCAN1;
+    hfdcan1.Init.ClockDivider = FDCAN_CLOCK_DIV1;
+#if CAN_FD_ENABLED
+    hfdcan1.Init.FrameFormat = FDCAN_FRAME_FD_BRS;
+    hfdcan1.Init.DataPrescaler = 5;
+    hfdcan1.Init.DataSyncJumpWidth = 4;
+    hfdcan1.Init.DataTimeSeg1 = 12;
+    hfdcan1.Init.DataTimeSeg2 = 4;
+#else
+    hfdcan1.Init.FrameFormat = FDCAN_FRAME_CLASSIC;
+#endif
+    hfdcan1.Init.Mode = FDCAN_MODE_NORMAL;
+    hfdcan1.Init.AutoRetransmission = ENABLE;
+    hfdcan1.Init.NominalPrescaler = 20;
+    hfdcan1.Init.NominalSyncJumpWidth = 1;
+    hfdcan1.Init.NominalTimeSeg1 = 13;
+    hfdcan1.Init.NominalTimeSeg2 = 3;
+    hfdcan1.Init.StdFiltersNbr = 0;
+    hfdcan1.Init.ExtFiltersNbr = 5;
+    hfdcan1.Init.TxFifoQueueMode = FDCAN_TX_FIFO_OPERATION;
+    
+    /* MX_TIM1_Init(): 20 kHz PWM, update every 20 periods */
+    memset(&htim1, 0, sizeof(htim1));
+    htim1.Instance = TIM1;
+    htim1.Init.Prescaler = 0;
+    htim1.Init.Period = 8499;
+    htim1.Init.RepetitionCounter = 19;
+    TIM1->ARR = htim1.Init.Period;
+    TIM1->RCR = htim1.Init.RepetitionCounter;
+    
+    mock_tick = 0;
+    mock_error_count = 0;
+    mock_primask = 0;
+    mock_flash_sleep_pd = false;
+    
+    /* Masked until the control loop is started, see ControlLoop_Start() */
+    tim1_irq_enabled = false;
+    tim1_irq_pending = false;
+    tim1_running = false;
+    
+    adc_dma_buffer = NULL;
+    adc_dma_length = 0;
+    adc_dma_index = 0;
+    adc_rank = 0;
+    adc_pwm_cycles = 0;
+    adc_calfact = 0;
+    
+    can_started = false;
+    memset(can_std_filters, 0, sizeof(can_std_filters));
+    memset(can_ext_filters, 0, sizeof(can_ext_filters));
+    can_non_matching_std = FDCAN_ACCEPT_IN_RX_FIFO0;
+    can_non_matching_ext = FDCAN_ACCEPT_IN_RX_FIFO0;
+    memset(can_rx_fifo, 0, sizeof(can_rx_fifo));
+    memset(&can_tx_fifo, 0, sizeof(can_tx_fifo));
+    can_auto_complete = true;
+    can_tx_irq_pending = false;
+    can_bit_time = 0;
+    can_bus_off = false;
+    can_recovery_left = 0;
+    can_tec = 0;
+    can_rec = 0;
+    can_error_irq_pending = false;
+    can_irq_line_enabled[0] = true;         /* HAL_FDCAN_MspInit() */
+    can_irq_line_enabled[1] = true;
+    memset(can_rx_irq_flags, 0, sizeof(can_rx_irq_flags));
+    can_irq_active = false;
+    can_tx_load_hook = NULL;
+    can_tx_abort_hook = NULL;
+    Mock_CanClearSent();
+    
+    flash_fail_after = -1;
+    FLASH->ECCR = 0;
+}
+
+/**
+ * @brief Advance simulated time
+ */
+void Mock_Tick(uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++) {
+        Plant_Step();
+        Adc_Step();
+    
+        mock_tick++;
+        DWT->CYCCNT += SystemCoreClock / 1000u;
+        can_bit_time += MOCK_CAN_BITS_PER_MS;
+    
+        /* Bus-off recovery sequence of a restarted core */
+        if (can_started && can_recovery_left > 0u && --can_recovery_left == 0u) {
+            can_bus_off = false;
+            can_tec = 0;
+            can_rec = 0;
+        }
+    
+        Tim1_Update();
+    
+        if (can_auto_complete && Can_OnBus()) {
+            (void)Mock_CanCompleteTx(MOCK_CAN_FRAMES_PER_MS);
+        }
+    }
+}
+
+uint32_t Mock_GetErrorCount(void)
+{
+    return mock_error_count;
+}
+
+void Mock_AdcSet(uint8_t rank, uint16_t position)
+{
+    if (rank >= MOCK_ADC_RANKS) {
+        return;
+    }
+    
+    adc_input[rank] = position & 0x0FFFu;
+    for (uint32_t i = 0; i < BRAKE_COUNT; i++) {
+        if (plants[i].adc_rank == rank) {
+            plant_position[i] = (int32_t)adc_input[rank] << 8;
+        }
+    }
+}
+
+uint16_t Mock_AdcGet(uint8_t rank)
+{
+    return (rank < MOCK_ADC_RANKS) ? adc_input[rank] : 0u;
+}
+
+void Mock_PlantEnable(bool enable)
+{
+    plant_enabled = enable;
+}
+
+GPIO_PinState Mock_GpioRead(const GPIO_TypeDef *port, uint16_t pin)
+{
+    return ((port->ODR & pin) != 0u) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+bool Mock_CanReceive(uint32_t id, bool is_extended, const uint8_t *data, uint8_t len)
+{
+    Mock_CanFrame_t frame;
+    uint32_t filter_index;
+    int32_t fifo;
+    uint32_t its;
+    
+    if (!Can_OnBus()) {
+        return false;
+    }
+    
+    fifo = Can_Match(id, is_extended, &filter_index);
+    if (fifo < 0) {
+        return false;
+    }
+    
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.is_extended = is_extended;
+    frame.is_fd = (len > 8u);
+    frame.len = len;
+    memcpy(frame.data, data, len);
+    frame.filter_index = (uint8_t)filter_index;
+    
+    if (can_rx_fifo[fifo].count >= MOCK_CAN_HW_FIFO_SIZE) {
+        its = (fifo == 0) ? FDCAN_IT_RX_FIFO0_MESSAGE_LOST : FDCAN_IT_RX_FIFO1_MESSAGE_LOST;
+    } else {
+        Fifo_Push(&can_rx_fifo[fifo], &frame);
+        its = (fifo == 0) ? FDCAN_IT_RX_FIFO0_NEW_MESSAGE : FDCAN_IT_RX_FIFO1_NEW_MESSAGE;
+        if (can_rx_fifo[fifo].count == MOCK_CAN_HW_FIFO_SIZE) {
+            its |= (fifo == 0) ? FDCAN_IT_RX_FIFO0_FULL : FDCAN_IT_RX_FIFO1_FULL;
+        }
+    }
+    
+    can_rx_irq_flags[fifo] |= its;
+    Can_ServiceIrq();
+    
+    return true;
+}
+
+uint32_t Mock_CanCompleteTx(uint32_t max)
+{
+    uint32_t sent = 0;
+    
+    while (Can_OnBus() && sent < max && can_tx_fifo.count > 0u) {
+        Mock_CanFrame_t *slot = &can_sent[(can_sent_head + can_sent_count) % MOCK_CAN_SENT_LOG_SIZE];
+    
+        if (can_sent_count == MOCK_CAN_SENT_LOG_SIZE) {
+            can_sent_head = (can_sent_head + 1u) % MOCK_CAN_SENT_LOG_SIZE;
+            can_sent_count--;
+        }
+        Fifo_Pop(&can_tx_fifo, slot);
+        slot->tick = mock_tick;
+        can_sent_count++;
+        sent++;
+    }
+    
+    if (sent > 0u) {
+        can_tx_irq_pending = true;
+        Can_ServiceIrq();
+    }
+    
+    return sent;
+}
+
+void Mock_CanBusOff(void)
+{
+    if (!Can_OnBus()) {
+        return;
+    }
+    
+    can_bus_off = true;
+    can_recovery_left = 0;
+    can_tec = 255;
+    
+    can_error_irq_pending = true;
+    if (mock_primask == 0u) {
+        can_error_irq_pending = false;
+        HAL_FDCAN_ErrorStatusCallback(&hfdcan1, FDCAN_IT_BUS_OFF);
+    }
+}
+
+void Mock_CanSetErrorCounters(uint8_t tec, uint8_t rec)
+{
+    can_tec = tec;
+    can_rec = rec;
+}
+
+void Mock_CanOnTxLoad(void (*hook)(void))
+{
+    can_tx_load_hook = hook;
+}
+
+void Mock_CanOnTxAbort(void (*hook)(void))
+{
+    can_tx_abort_hook = hook;
+}
+
+void Mock_CanRaiseIrq(uint32_t rx_its, bool tx_complete)
+{
+    can_rx_irq_flags[0] |= rx_its;
+    can_tx_irq_pending = can_tx_irq_pending || tx_complete;
+    Can_ServiceIrq();
+}
+
+void Mock_CanSetAutoComplete(bool enable)
+{
+    can_auto_complete = enable;
+}
+
+uint32_t Mock_CanGetPendingTx(void)
+{
+    return can_tx_fifo.count;
+}
+
+bool Mock_CanPopSent(Mock_CanFrame_t *frame)
+{
+    if (can_sent_count == 0u) {
+        return false;
+    }
+    
+    *frame = can_sent[can_sent_head];
+    can_sent_head = (can_sent_head + 1u) % MOCK_CAN_SENT_LOG_SIZE;
+    can_sent_count--;
+    return true;
+}
+
+bool Mock_CanFindSent(uint32_t id, Mock_CanFrame_t *frame)
+{
+    for (uint32_t i = 0; i < can_sent_count; i++) {
+        uint32_t index = (can_sent_head + i) % MOCK_CAN_SENT_LOG_SIZE;
+    
+        if (can_sent[index].id != id) {
+            continue;
+        }
+    
+        *frame = can_sent[index];
+        for (; i + 1u < can_sent_count; i++) {
+            can_sent[(can_sent_head + i) % MOCK_CAN_SENT_LOG_SIZE] =
+                can_sent[(can_sent_head + i + 1u) % MOCK_CAN_SENT_LOG_SIZE];
+        }
+        can_sent_count--;
+        return true;
+    }
+    
+    return false;
+}
+
+void Mock_CanClearSent(void)
+{
+    can_sent_head = 0;
+    can_sent_count = 0;
+}
+
+void Mock_FlashErase(void)
+{
+    memset(_storage_start, 0xFF, sizeof(_storage_start));
+    flash_erase_count = 0;
+    flash_ecc_offset = MOCK_STORAGE_SIZE;
+}
+
+void Mock_FlashEccError(uint32_t offset)
+{
+    flash_ecc_offset = offset & ~(uint32_t)(sizeof(uint64_t) - 1u);
+}
+
+void Mock_FlashFailAfter(int32_t dwords)
+{
+    flash_fail_after = dwords;
+}
+
+uint32_t Mock_FlashGetEraseCount(void)
+{
+    return flash_erase_count;
+}
+
+/* ============================================================================
+ * Core, System and GPIO
+ * ============================================================================ */
+
+void Error_Handler(void)
+{
+    mock_error_count++;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return mock_tick;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    /* Same minimum wait as the HAL: one extra tick */
+    Mock_Tick(Delay + 1u);
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return SystemCoreClock;
+}
+
+void __disable_irq(void)
+{
+    mock_primask = 1;
+}
+
+void __enable_irq(void)
+{
+    mock_primask = 0;
+    if (tim1_irq_pending) {
+        Tim1_Update();
+    }
+    Can_ServiceIrq();
+    if (can_error_irq_pending) {
+        can_error_irq_pending = false;
+        HAL_FDCAN_ErrorStatusCallback(&hfdcan1, FDCAN_IT_BUS_OFF);
+    }
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return mock_primask;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+    if (primask == 0u) {
+        __enable_irq();
+    } else {
+        __disable_irq();
+    }
+}
+
+void __DMB(void) {}
+void __DSB(void)
+{
+    /* Reads are not trapped; a torn double word faults at every barrier instead */
+    if (flash_ecc_offset < MOCK_STORAGE_SIZE) {
+        FLASH->ECCR = FLASH_ECCR_ECCD |
+                      (((uint32_t)(uintptr_t)_storage_start - FLASH_BASE + flash_ecc_offset) & FLASH_ECCR_ADDR_ECC);
+        NMI_Handler();
+    }
+}
+void __ISB(void) {}
+void __NOP(void) {}
+
+void __WFI(void)
+{
+    /* The 1 kHz tick is always the next interrupt */
+    Mock_Tick(1);
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    if (IRQn == TIM1_UP_TIM16_IRQn) {
+        tim1_irq_enabled = true;
+        if (tim1_irq_pending) {
+            Tim1_Update();
+        }
+    } else if (IRQn == FDCAN1_IT0_IRQn || IRQn == FDCAN1_IT1_IRQn) {
+        can_irq_line_enabled[IRQn - FDCAN1_IT0_IRQn] = true;
+        Can_ServiceIrq();
+    }
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    if (IRQn == TIM1_UP_TIM16_IRQn) {
+        tim1_irq_enabled = false;
+    } else if (IRQn == FDCAN1_IT0_IRQn || IRQn == FDCAN1_IT1_IRQn) {
+        can_irq_line_enabled[IRQn - FDCAN1_IT0_IRQn] = false;
+    }
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (PinState == GPIO_PIN_SET) {
+        GPIOx->ODR |= GPIO_Pin;
+    } else {
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    }
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    GPIOx->ODR ^= GPIO_Pin;
+}
+
+/* ============================================================================
+ * TIM
+ * ============================================================================ */
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim)
+{
+    if (htim->Instance == TIM1) {
+        tim1_running = true;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    return (Channel <= TIM_CHANNEL_4) ? HAL_OK : HAL_ERROR;
+}
+
+/* ============================================================================
+ * ADC and DMA
+ * ============================================================================ */
+
+HAL_StatusTypeDef ADC_Enable(ADC_HandleTypeDef *hadc)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc, uint32_t SingleDiff)
+{
+    adc_calfact = MOCK_ADC_CALFACT;
+    return HAL_OK;
+}
+
+uint32_t HAL_ADCEx_Calibration_GetValue(ADC_HandleTypeDef *hadc, uint32_t SingleDiff)
+{
+    return adc_calfact;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_Calibration_SetValue(ADC_HandleTypeDef *hadc, uint32_t SingleDiff,
+                                                 uint32_t CalibrationFactor)
+{
+    adc_calfact = CalibrationFactor;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length)
+{
+    if (pData == NULL || Length == 0u) {
+        return HAL_ERROR;
+    }
+    
+    /* Half-word transfers (DMA_MDATAALIGN_HALFWORD) */
+    adc_dma_buffer = (uint16_t *)pData;
+    adc_dma_length = Length;
+    adc_dma_index = 0;
+    adc_rank = 0;
+    adc_pwm_cycles = 0;
+    hadc->DMA_Handle->Instance->CNDTR = Length;
+    
+    return HAL_OK;
+}
+
+/* ============================================================================
+ * FDCAN
+ * ============================================================================ */
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigFilter(FDCAN_HandleTypeDef *hfdcan, const FDCAN_FilterTypeDef *sFilterConfig)
+{
+    Mock_CanFilter_t *filters;
+    uint32_t count;
+    
+    /* Filters are configured in READY state only */
+    if (can_started) {
+        return HAL_ERROR;
+    }
+    
+    if (sFilterConfig->IdType == FDCAN_EXTENDED_ID) {
+        filters = can_ext_filters;
+        count = MOCK_CAN_EXT_FILTERS;
+    } else {
+        filters = can_std_filters;
+        count = MOCK_CAN_STD_FILTERS;
+    }
+    if (sFilterConfig->FilterIndex >= count) {
+        return HAL_ERROR;
+    }
+    
+    filters[sFilterConfig->FilterIndex].used = true;
+    filters[sFilterConfig->FilterIndex].config = *sFilterConfig;
+    
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigGlobalFilter(FDCAN_HandleTypeDef *hfdcan, uint32_t NonMatchingStd,
+                                               uint32_t NonMatchingExt, uint32_t RejectRemoteStd,
+                                               uint32_t RejectRemoteExt)
+{
+    if (can_started) {
+        return HAL_ERROR;
+    }
+    
+    can_non_matching_std = NonMatchingStd;
+    can_non_matching_ext = NonMatchingExt;
+    
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigInterruptLines(FDCAN_HandleTypeDef *hfdcan, uint32_t ITList,
+                                                 uint32_t InterruptLine)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ActivateNotification(FDCAN_HandleTypeDef *hfdcan, uint32_t ActiveITs,
+                                                 uint32_t BufferIndexes)
+{
+    hfdcan->Instance->IE |= ActiveITs;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigTimestampCounter(FDCAN_HandleTypeDef *hfdcan, uint32_t TimestampPrescaler)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_EnableTimestampCounter(FDCAN_HandleTypeDef *hfdcan, uint32_t TimestampOperation)
+{
+    return HAL_OK;
+}
+
+uint16_t HAL_FDCAN_GetTimestampCounter(const FDCAN_HandleTypeDef *hfdcan)
+{
+    return (uint16_t)can_bit_time;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigTxDelayCompensation(FDCAN_HandleTypeDef *hfdcan, uint32_t TdcOffset,
+                                                      uint32_t TdcFilter)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_EnableTxDelayCompensation(FDCAN_HandleTypeDef *hfdcan)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_Start(FDCAN_HandleTypeDef *hfdcan)
+{
+    if (can_started) {
+        return HAL_ERROR;
+    }
+    
+    /* Clearing INIT after bus-off starts the recovery sequence */
+    if (can_bus_off) {
+        can_recovery_left = MOCK_CAN_RECOVERY_MS;
+    }
+    
+    can_started = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_Stop(FDCAN_HandleTypeDef *hfdcan)
+{
+    if (!can_started) {
+        return HAL_ERROR;
+    }
+    
+    can_started = false;
+    can_recovery_left = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_AbortTxRequest(FDCAN_HandleTypeDef *hfdcan, uint32_t BufferIndex)
+{
+    if (!can_started) {
+        return HAL_ERROR;
+    }
+    
+    /* FIFO elements are only ever aborted all together by the driver */
+    can_tx_fifo.count = 0;
+    
+    if (can_tx_abort_hook != NULL) {
+        void (*hook)(void) = can_tx_abort_hook;
+    
+        can_tx_abort_hook = NULL;
+        hook();
+    }
+    
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_AddMessageToTxFifoQ(FDCAN_HandleTypeDef *hfdcan, const FDCAN_TxHeaderTypeDef *pTxHeader,
+                                                const uint8_t *pTxData)
+{
+    Mock_CanFrame_t frame;
+    
+    if (!can_started || can_tx_fifo.count >= MOCK_CAN_HW_FIFO_SIZE) {
+        return HAL_ERROR;
+    }
+    
+    memset(&frame, 0, sizeof(frame));
+    frame.id = pTxHeader->Identifier;
+    frame.is_extended = (pTxHeader->IdType == FDCAN_EXTENDED_ID);
+    frame.is_fd = (pTxHeader->FDFormat == FDCAN_FD_CAN);
+    frame.len = DlcToLen(pTxHeader->DataLength >> 16);
+    memcpy(frame.data, pTxData, frame.len);
+    Fifo_Push(&can_tx_fifo, &frame);
+    
+    /* Interrupts arriving while the driver loads the TX FIFO */
+    if (can_tx_load_hook != NULL) {
+        void (*hook)(void) = can_tx_load_hook;
+    
+        can_tx_load_hook = NULL;
+        hook();
+    }
+    
+    return HAL_OK;
+}
+
+uint32_t HAL_FDCAN_GetRxFifoFillLevel(const FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo)
+{
+    return can_rx_fifo[(RxFifo == FDCAN_RX_FIFO1) ? 1 : 0].count;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_GetRxMessage(FDCAN_HandleTypeDef *hfdcan, uint32_t RxLocation,
+                                         FDCAN_RxHeaderTypeDef *pRxHeader, uint8_t *pRxData)
+{
+    Mock_CanFifo_t *fifo = &can_rx_fifo[(RxLocation == FDCAN_RX_FIFO1) ? 1 : 0];
+    Mock_CanFrame_t frame;
+    
+    if (fifo->count == 0u) {
+        return HAL_ERROR;
+    }
+    Fifo_Pop(fifo, &frame);
+    
+    memset(pRxHeader, 0, sizeof(*pRxHeader));
+    pRxHeader->Identifier = frame.id;
+    pRxHeader->IdType = frame.is_extended ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID;
+    pRxHeader->RxFrameType = FDCAN_DATA_FRAME;
+    pRxHeader->DataLength = LenToDlc(frame.len) << 16;
+    pRxHeader->FDFormat = frame.is_fd ? FDCAN_FD_CAN : FDCAN_CLASSIC_CAN;
+    pRxHeader->BitRateSwitch = frame.is_fd ? FDCAN_BRS_ON : FDCAN_BRS_OFF;
+    pRxHeader->RxTimestamp = (uint16_t)can_bit_time;
+    pRxHeader->FilterIndex = (frame.filter_index == 0xFFu) ? 0u : frame.filter_index;
+    pRxHeader->IsFilterMatchingFrame = (frame.filter_index == 0xFFu) ? 1u : 0u;
+    memcpy(pRxData, frame.data, DlcToLen(LenToDlc(frame.len)));
+    
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_GetErrorCounters(const FDCAN_HandleTypeDef *hfdcan,
+                                             FDCAN_ErrorCountersTypeDef *ErrorCounters)
+{
+    memset(ErrorCounters, 0, sizeof(*ErrorCounters));
+    ErrorCounters->TxErrorCnt = can_tec;
+    ErrorCounters->RxErrorCnt = can_rec & 0x7Fu;     /* ECR.REC is 7 bits, RP flags passive */
+    ErrorCounters->RxErrorPassive = (can_rec > 127u) ? 1u : 0u;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_GetProtocolStatus(const FDCAN_HandleTypeDef *hfdcan,
+                                              FDCAN_ProtocolStatusTypeDef *ProtocolStatus)
+{
+    memset(ProtocolStatus, 0, sizeof(*ProtocolStatus));
+    ProtocolStatus->BusOff = can_bus_off ? 1u : 0u;
+    ProtocolStatus->ErrorPassive = (!can_bus_off && (can_tec > 127u || can_rec > 127u)) ? 1u : 0u;
+    ProtocolStatus->Warning = (can_tec >= 96u || can_rec >= 96u) ? 1u : 0u;
+    return HAL_OK;
+}
+
+/* ============================================================================
+ * FLASH
+ * ============================================================================ */
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    uint32_t offset = Flash_Offset(Address);
+    uint64_t current;
+    
+    if (TypeProgram != FLASH_TYPEPROGRAM_DOUBLEWORD || (offset % sizeof(uint64_t)) != 0u ||
+        offset >= MOCK_STORAGE_SIZE) {
+        return HAL_ERROR;
+    }
+    
+    if (flash_fail_after == 0) {
+        return HAL_ERROR;
+    }
+    if (flash_fail_after > 0) {
+        flash_fail_after--;
+    }
+    
+    /* Only erased double words can be programmed (PROGERR otherwise) */
+    memcpy(&current, &_storage_start[offset], sizeof(current));
+    if (current != UINT64_MAX) {
+        return HAL_ERROR;
+    }
+    
+    memcpy(&_storage_start[offset], &Data, sizeof(Data));
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError)
+{
+    uint32_t first = ((uint32_t)(uintptr_t)_storage_start - FLASH_BASE) / FLASH_PAGE_SIZE;
+    
+    for (uint32_t page = pEraseInit->Page; page < pEraseInit->Page + pEraseInit->NbPages; page++) {
+        uint32_t relative = page - first;
+    
+        if (relative >= MOCK_STORAGE_SIZE / FLASH_PAGE_SIZE) {
+            *PageError = page;
+            return HAL_ERROR;
+        }
+        memset(&_storage_start[relative * FLASH_PAGE_SIZE], 0xFF, FLASH_PAGE_SIZE);
+        flash_erase_count++;
+        if ((flash_ecc_offset / FLASH_PAGE_SIZE) == relative) {
+            flash_ecc_offset = MOCK_STORAGE_SIZE;
+        }
+    }
+    
+    *PageError = 0xFFFFFFFFu;
+    return HAL_OK;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file mock_hal.h
+ * @brief Simulated STM32G431 peripherals behind the host HAL replacement
+ * 
+ * Time only moves when a test asks for it: Mock_Tick() advances SysTick,
+ * the DWT cycle counter, the TIM1 update interrupt, the ADC DMA scan and
+ * the CAN bus by whole milliseconds. HAL_Delay() and __WFI() tick too, so
+ * Brake_Init() and Scheduler_Idle() behave as on the target.
+ * 
+ * Interrupts are delivered synchronously from Mock_Tick() and the Mock_Can*
+ * injectors, never asynchronously, so every run is deterministic. A masked
+ * TIM1 update or FDCAN interrupt stays pending and runs when it is
+ * unmasked. FDCAN RX raises line 0 and TX complete line 1, but as with
+ * HAL_FDCAN_IRQHandler() either line services every pending flag.
+ */
+
+#ifndef MOCK_HAL_H
+#define MOCK_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32g4xx_hal.h"
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+/** Frames kept in the sent-frame log, oldest are overwritten */
+#define MOCK_CAN_SENT_LOG_SIZE      256u
+
+/** Frames the simulated bus transmits per millisecond (8-byte extended frames at 500 kbit/s) */
+#define MOCK_CAN_FRAMES_PER_MS      3u
+
+/** Bus-off recovery of a restarted FDCAN, ms (128 x 11 recessive bits at 500 kbit/s, rounded up) */
+#define MOCK_CAN_RECOVERY_MS        3u
+
+/** Plant speed at 100% duty, ADC counts per millisecond */
+#define MOCK_PLANT_COUNTS_PER_MS    20u
+
+/* ============================================================================
+ * Type Definitions
+ * ============================================================================ */
+
+/**
+ * @brief Frame as seen on the simulated bus
+ */
+typedef struct {
+    uint32_t id;
+    bool is_extended;
+    bool is_fd;
+    uint8_t len;
+    uint8_t data[64];
+    uint8_t filter_index;   /**< RX only: matching filter element, 0xFF for the global filter */
+    uint32_t tick;          /**< TX only: HAL_GetTick() when the frame left the TX FIFO */
+} Mock_CanFrame_t;
+
+/* ============================================================================
+ * Public Function Prototypes
+ * ============================================================================ */
+
+/**
+ * @brief Put every peripheral and handle into its state after MX_*_Init()
+ * 
+ * Handles get the Init values of main.c, time restarts at 0 and the TIM1
+ * update interrupt is masked until ControlLoop_Start(). Flash content,
+ * ADC inputs and the plant survive, as across a target reset.
+ */
+void Mock_Reset(void);
+
+/**
+ * @brief Advance simulated time
+ * 
+ * Each millisecond: plant step, ADC scans into the DMA buffer, SysTick,
+ * TIM1 update interrupt, then up to MOCK_CAN_FRAMES_PER_MS frames leave
+ * the TX FIFO (if auto-complete is on).
+ * 
+ * @param ms Milliseconds
+ */
+void Mock_Tick(uint32_t ms);
+
+/**
+ * @brief Count of Error_Handler() calls since Mock_Reset()
+ */
+uint32_t Mock_GetErrorCount(void);
+
+/**
+ * @brief Set the 12-bit position seen by one ADC regular rank
+ * 
+ * @param rank Regular rank (Brake_Config_t.adc_rank)
+ * @param position ADC counts (0-4095)
+ */
+void Mock_AdcSet(uint8_t rank, uint16_t position);
+
+/**
+ * @brief Get the 12-bit position currently seen by one ADC rank
+ */
+uint16_t Mock_AdcGet(uint8_t rank);
+
+/**
+ * @brief Let the actuators move the ADC input
+ * 
+ * Each brake moves its rank by duty * MOCK_PLANT_COUNTS_PER_MS per
+ * millisecond, up with INH set and down with INH clear.
+ * 
+ * @param enable true to simulate the actuators, false to hold the inputs
+ */
+void Mock_PlantEnable(bool enable);
+
+/**
+ * @brief Read an output pin as last written through HAL_GPIO_WritePin()
+ */
+GPIO_PinState Mock_GpioRead(const GPIO_TypeDef *port, uint16_t pin);
+
+/**
+ * @brief Offer a frame to the FDCAN acceptance filters
+ * 
+ * Runs the RX FIFO callback of the FIFO the frame lands in.
+ * 
+ * @return true if a filter or the global filter accepted the frame
+ */
+bool Mock_CanReceive(uint32_t id, bool is_extended, const uint8_t *data, uint8_t len);
+
+/**
+ * @brief Run a function once, from within the next HAL_FDCAN_AddMessageToTxFifoQ()
+ * 
+ * Stands in for interrupts that arrive while the driver loads the
+ * hardware TX FIFO, after the frame is accepted. Cleared by Mock_Reset().
+ * 
+ * @param hook Function to run, NULL to disarm
+ */
+void Mock_CanOnTxLoad(void (*hook)(void));
+
+/**
+ * @brief Run a function once, from within the next HAL_FDCAN_AbortTxRequest()
+ * 
+ * Runs after the hardware TX FIFO is emptied. Cleared by Mock_Reset().
+ * 
+ * @param hook Function to run, NULL to disarm
+ */
+void Mock_CanOnTxAbort(void (*hook)(void));
+
+/**
+ * @brief Raise FDCAN interrupt flags without bus traffic
+ * 
+ * For flags left pending across a bus-off, when no frame can be received
+ * or completed. The handler runs at once unless its line is masked.
+ * 
+ * @param rx_its RX FIFO 0 flags (FDCAN_IT_RX_FIFO0_*), raised on line 0
+ * @param tx_complete Raise TX complete, on line 1
+ */
+void Mock_CanRaiseIrq(uint32_t rx_its, bool tx_complete);
+
+/**
+ * @brief Transmit frames waiting in the hardware TX FIFO
+ * 
+ * Runs the TX complete callback once if any frame left.
+ * 
+ * @param max Frames to transmit at most
+ * @return Frames transmitted
+ */
+uint32_t Mock_CanCompleteTx(uint32_t max);
+
+/**
+ * @brief Drive the FDCAN into bus-off
+ * 
+ * TEC goes to 255, the core leaves the bus (no TX, no RX) and the error
+ * status callback runs. A following HAL_FDCAN_Stop()/HAL_FDCAN_Start()
+ * rejoins after MOCK_CAN_RECOVERY_MS.
+ */
+void Mock_CanBusOff(void);
+
+/**
+ * @brief Set the FDCAN error counters (warning at 96, error passive above 127)
+ */
+void Mock_CanSetErrorCounters(uint8_t tec, uint8_t rec);
+
+/**
+ * @brief Let Mock_Tick() transmit frames (on by default)
+ */
+void Mock_CanSetAutoComplete(bool enable);
+
+/**
+ * @brief Frames waiting in the hardware TX FIFO
+ */
+uint32_t Mock_CanGetPendingTx(void);
+
+/**
+ * @brief Take the oldest frame from the sent-frame log
+ * 
+ * @return false if the log is empty
+ */
+bool Mock_CanPopSent(Mock_CanFrame_t *frame);
+
+/**
+ * @brief Find and take the oldest logged frame with an identifier
+ * 
+ * Frames before it stay in the log.
+ * 
+ * @return false if no such frame was sent
+ */
+bool Mock_CanFindSent(uint32_t id, Mock_CanFrame_t *frame);
+
+/**
+ * @brief Drop every logged frame
+ */
+void Mock_CanClearSent(void);
+
+/**
+ * @brief Fill the STORAGE region with erased bytes (0xFF)
+ */
+void Mock_FlashErase(void);
+
+/**
+ * @brief Fail flash programming after a number of double words
+ * 
+ * @param dwords Double words that still program, -1 for no failure
+ */
+void Mock_FlashFailAfter(int32_t dwords);
+
+/**
+ * @brief Leave a double word of the STORAGE region with a bad ECC code
+ * 
+ * As a reset during programming does. Until its page is erased, every
+ * __DSB() raises the ECC double error NMI for it, standing in for a read.
+ * 
+ * @param offset Byte offset into the region
+ */
+void Mock_FlashEccError(uint32_t offset);
+
+/**
+ * @brief Page erases since Mock_FlashErase()
+ */
+uint32_t Mock_FlashGetEraseCount(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MOCK_HAL_H */
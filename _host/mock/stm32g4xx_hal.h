@@ -0,0 +1,438 @@
+/**
+ * @file stm32g4xx_hal.h
+ * @brief Host replacement of the STM32G4 HAL interface used by Core/
+ * 
+ * Found ahead of the real HAL on the host include path, so Core/ sources
+ * compile unchanged. Declares only the types, constants and functions the
+ * driver uses; peripheral instances point at plain structs in mock_hal.c
+ * and the functions are implemented there. Register layouts are reduced
+ * to the fields Core/ touches.
+ */
+
+#ifndef STM32G4XX_HAL_MOCK_H
+#define STM32G4XX_HAL_MOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#define __IO volatile
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+typedef enum { RESET = 0, SET = 1 } FlagStatus, ITStatus;
+typedef enum { DISABLE = 0, ENABLE = 1 } FunctionalState;
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+typedef struct { volatile uint32_t MODER, ODR, BSRR; } GPIO_TypeDef;
+typedef struct { uint32_t Pin, Mode, Pull, Speed, Alternate; } GPIO_InitTypeDef;
+extern GPIO_TypeDef mock_gpioa, mock_gpiob, mock_gpiof;
+#define GPIOA (&mock_gpioa)
+#define GPIOB (&mock_gpiob)
+#define GPIOF (&mock_gpiof)
+#define GPIO_PIN_1 0x2u
+#define GPIO_PIN_0 0x1u
+#define GPIO_PIN_3 0x8u
+#define GPIO_PIN_8 0x100u
+#define GPIO_PIN_9 0x200u
+#define GPIO_PIN_4 0x10u
+#define GPIO_PIN_10 0x400u
+#define GPIO_PIN_11 0x800u
+#define GPIO_PIN_12 0x1000u
+#define GPIO_MODE_OUTPUT_PP 1u
+#define GPIO_MODE_ANALOG 3u
+#define GPIO_MODE_AF_PP 2u
+#define GPIO_NOPULL 0u
+#define GPIO_SPEED_FREQ_LOW 0u
+#define GPIO_SPEED_FREQ_HIGH 2u
+#define GPIO_AF9_FDCAN1 9u
+#define GPIO_AF6_TIM1 6u
+void HAL_GPIO_WritePin(GPIO_TypeDef*, uint16_t, GPIO_PinState);
+void HAL_GPIO_TogglePin(GPIO_TypeDef*, uint16_t);
+void HAL_GPIO_Init(GPIO_TypeDef*, GPIO_InitTypeDef*);
+void HAL_GPIO_DeInit(GPIO_TypeDef*, uint32_t);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t);
+HAL_StatusTypeDef HAL_Init(void);
+void HAL_IncTick(void);
+void __disable_irq(void);
+void __enable_irq(void);
+void __DMB(void); void __DSB(void); void __ISB(void); void __WFI(void); void __NOP(void);
+uint32_t __get_PRIMASK(void); void __set_PRIMASK(uint32_t);
+typedef int IRQn_Type;
+#define FDCAN1_IT0_IRQn 21
+#define FDCAN1_IT1_IRQn 22
+void HAL_NVIC_SetPriority(IRQn_Type, uint32_t, uint32_t);
+void HAL_NVIC_EnableIRQ(IRQn_Type);
+void HAL_NVIC_DisableIRQ(IRQn_Type);
+/* FDCAN */
+typedef struct { volatile uint32_t CCCR, ECR, PSR, IR, IE, ILS, ILE, RXF0S, RXF1S, TXFQS, TXBRP, TXBAR, TXBC, TSCV, TSCC; } FDCAN_GlobalTypeDef;
+extern FDCAN_GlobalTypeDef *FDCAN1;
+typedef struct { uint32_t ClockDivider, FrameFormat, Mode; FunctionalState AutoRetransmission, TransmitPause, ProtocolException;
+  uint32_t NominalPrescaler, NominalSyncJumpWidth, NominalTimeSeg1, NominalTimeSeg2, DataPrescaler, DataSyncJumpWidth, DataTimeSeg1, DataTimeSeg2, StdFiltersNbr, ExtFiltersNbr, TxFifoQueueMode; } FDCAN_InitTypeDef;
+typedef struct { FDCAN_GlobalTypeDef *Instance; FDCAN_InitTypeDef Init; uint32_t ErrorCode; } FDCAN_HandleTypeDef;
+typedef struct { uint32_t Identifier, IdType, TxFrameType, DataLength, ErrorStateIndicator, BitRateSwitch, FDFormat, TxEventFifoControl, MessageMarker; } FDCAN_TxHeaderTypeDef;
+typedef struct { uint32_t Identifier, IdType, RxFrameType, DataLength, ErrorStateIndicator, BitRateSwitch, FDFormat, RxTimestamp, FilterIndex, IsFilterMatchingFrame; } FDCAN_RxHeaderTypeDef;
+typedef struct { uint32_t IdType, FilterIndex, FilterType, FilterConfig, FilterID1, FilterID2, RxBufferIndex, IsCalibrationMsg; } FDCAN_FilterTypeDef;
+typedef struct { uint32_t LastErrorCode, DataLastErrorCode, Activity, ErrorPassive, Warning, BusOff, RxESIflag, RxBRSflag, RxFDFflag, ProtocolException, TDCvalue; } FDCAN_ProtocolStatusTypeDef;
+typedef struct { uint32_t TxErrorCnt, RxErrorCnt, RxErrorPassive, ErrorLogging; } FDCAN_ErrorCountersTypeDef;
+#define FDCAN_CLOCK_DIV1 0u
+#define FDCAN_FRAME_CLASSIC 0u
+#define FDCAN_FRAME_FD_NO_BRS 0x100u
+#define FDCAN_FRAME_FD_BRS 0x300u
+#define FDCAN_MODE_NORMAL 0u
+#define FDCAN_TX_FIFO_OPERATION 0u
+#define FDCAN_TX_QUEUE_OPERATION 0x01000000u
+#define FDCAN_STANDARD_ID 0u
+#define FDCAN_EXTENDED_ID 0x40000000u
+#define FDCAN_DATA_FRAME 0u
+#define FDCAN_REMOTE_FRAME 0x20000000u
+#define FDCAN_DLC_BYTES_0 0x0u
+#define FDCAN_DLC_BYTES_8 0x8u
+#define FDCAN_DLC_BYTES_12 0x9u
+#define FDCAN_DLC_BYTES_16 0xAu
+#define FDCAN_DLC_BYTES_20 0xBu
+#define FDCAN_DLC_BYTES_24 0xCu
+#define FDCAN_DLC_BYTES_32 0xDu
+#define FDCAN_DLC_BYTES_48 0xEu
+#define FDCAN_DLC_BYTES_64 0xFu
+#define FDCAN_ESI_ACTIVE 0u
+#define FDCAN_BRS_OFF 0u
+#define FDCAN_BRS_ON 0x00100000u
+#define FDCAN_CLASSIC_CAN 0u
+#define FDCAN_FD_CAN 0x00200000u
+#define FDCAN_NO_TX_EVENTS 0u
+#define FDCAN_RX_FIFO0 0x10u
+#define FDCAN_RX_FIFO1 0x20u
+#define FDCAN_IT_RX_FIFO0_NEW_MESSAGE 0x1u
+#define FDCAN_IT_RX_FIFO0_FULL 0x2u
+#define FDCAN_IT_RX_FIFO0_MESSAGE_LOST 0x4u
+#define FDCAN_IT_RX_FIFO1_NEW_MESSAGE 0x8u
+#define FDCAN_IT_RX_FIFO1_FULL 0x10u
+#define FDCAN_IT_RX_FIFO1_MESSAGE_LOST 0x20u
+#define FDCAN_IT_TX_COMPLETE 0x80u
+#define FDCAN_IT_TX_FIFO_EMPTY 0x200u
+#define FDCAN_IT_BUS_OFF 0x1000000u
+#define FDCAN_IT_ERROR_WARNING 0x400000u
+#define FDCAN_IT_ERROR_PASSIVE 0x800000u
+#define FDCAN_IT_ARB_PROTOCOL_ERROR 0x2000000u
+#define FDCAN_IT_DATA_PROTOCOL_ERROR 0x4000000u
+#define FDCAN_IT_LIST_RX_FIFO0 (FDCAN_IT_RX_FIFO0_NEW_MESSAGE|FDCAN_IT_RX_FIFO0_FULL|FDCAN_IT_RX_FIFO0_MESSAGE_LOST)
+#define FDCAN_IT_LIST_RX_FIFO1 (FDCAN_IT_RX_FIFO1_NEW_MESSAGE|FDCAN_IT_RX_FIFO1_FULL|FDCAN_IT_RX_FIFO1_MESSAGE_LOST)
+#define FDCAN_IT_LIST_SMSG 0x380u
+#define FDCAN_IT_LIST_BIT_LINE_ERROR 0x3000000u
+#define FDCAN_IT_LIST_PROTOCOL_ERROR 0x7C00000u
+#define FDCAN_INTERRUPT_LINE0 0x1u
+#define FDCAN_INTERRUPT_LINE1 0x2u
+#define FDCAN_IT_GROUP_RX_FIFO0 0x1u
+#define FDCAN_IT_GROUP_RX_FIFO1 0x2u
+#define FDCAN_IT_GROUP_SMSG 0x4u
+#define FDCAN_IT_GROUP_TX_FIFO_ERROR 0x8u
+#define FDCAN_IT_GROUP_MISC 0x10u
+#define FDCAN_IT_GROUP_BIT_LINE_ERROR 0x20u
+#define FDCAN_IT_GROUP_PROTOCOL_ERROR 0x40u
+#define FDCAN_TX_BUFFER0 0x1u
+#define FDCAN_TX_BUFFER1 0x2u
+#define FDCAN_TX_BUFFER2 0x4u
+#define FDCAN_FILTER_MASK 0x2u
+#define FDCAN_FILTER_DUAL 0x1u
+#define FDCAN_FILTER_RANGE 0x0u
+#define FDCAN_FILTER_TO_RXFIFO0 0x1u
+#define FDCAN_FILTER_TO_RXFIFO1 0x2u
+#define FDCAN_FILTER_TO_RXFIFO0_HP 0x5u
+#define FDCAN_FILTER_TO_RXFIFO1_HP 0x6u
+#define FDCAN_FILTER_REJECT 0x3u
+#define FDCAN_ACCEPT_IN_RX_FIFO0 0x0u
+#define FDCAN_ACCEPT_IN_RX_FIFO1 0x1u
+#define FDCAN_REJECT 0x2u
+#define FDCAN_FILTER_REMOTE 0x0u
+#define FDCAN_REJECT_REMOTE 0x1u
+#define FDCAN_TIMESTAMP_PRESC_1 0u
+#define FDCAN_TIMESTAMP_PRESC_16 0xF0000u
+#define FDCAN_TIMESTAMP_INTERNAL 0x1u
+#define FDCAN_TIMESTAMP_EXTERNAL 0x2u
+#define FDCAN_FLAG_BUS_OFF 0x1000000u
+#define FDCAN_RX_FIFO_BLOCKING 0u
+#define FDCAN_RX_FIFO_OVERWRITE 1u
+#define FDCAN_PSR_BO 0x80u
+#define FDCAN_PSR_EP 0x20u
+#define FDCAN_PSR_EW 0x40u
+#define FDCAN_CCCR_INIT 0x1u
+#define FDCAN_ECR_TEC 0xFFu
+#define FDCAN_ECR_REC 0x7F00u
+#define FDCAN_ECR_REC_Pos 8u
+#define HAL_FDCAN_ERROR_PROTOCOL_ARBT 0x40u
+HAL_StatusTypeDef HAL_FDCAN_Init(FDCAN_HandleTypeDef*);
+HAL_StatusTypeDef HAL_FDCAN_DeInit(FDCAN_HandleTypeDef*);
+HAL_StatusTypeDef HAL_FDCAN_Start(FDCAN_HandleTypeDef*);
+HAL_StatusTypeDef HAL_FDCAN_Stop(FDCAN_HandleTypeDef*);
+HAL_StatusTypeDef HAL_FDCAN_AddMessageToTxFifoQ(FDCAN_HandleTypeDef*, const FDCAN_TxHeaderTypeDef*, const uint8_t*);
+HAL_StatusTypeDef HAL_FDCAN_GetRxMessage(FDCAN_HandleTypeDef*, uint32_t, FDCAN_RxHeaderTypeDef*, uint8_t*);
+uint32_t HAL_FDCAN_GetRxFifoFillLevel(const FDCAN_HandleTypeDef*, uint32_t);
+uint32_t HAL_FDCAN_GetTxFifoFreeLevel(const FDCAN_HandleTypeDef*);
+uint32_t HAL_FDCAN_IsTxBufferMessagePending(const FDCAN_HandleTypeDef*, uint32_t);
+HAL_StatusTypeDef HAL_FDCAN_AbortTxRequest(FDCAN_HandleTypeDef*, uint32_t);
+HAL_StatusTypeDef HAL_FDCAN_ConfigFilter(FDCAN_HandleTypeDef*, const FDCAN_FilterTypeDef*);
+HAL_StatusTypeDef HAL_FDCAN_ConfigGlobalFilter(FDCAN_HandleTypeDef*, uint32_t, uint32_t, uint32_t, uint32_t);
+HAL_StatusTypeDef HAL_FDCAN_ConfigRxFifoOverwrite(FDCAN_HandleTypeDef*, uint32_t, uint32_t);
+HAL_StatusTypeDef HAL_FDCAN_ActivateNotification(FDCAN_HandleTypeDef*, uint32_t, uint32_t);
+HAL_StatusTypeDef HAL_FDCAN_DeactivateNotification(FDCAN_HandleTypeDef*, uint32_t);
+HAL_StatusTypeDef HAL_FDCAN_ConfigInterruptLines(FDCAN_HandleTypeDef*, uint32_t, uint32_t);
+HAL_StatusTypeDef HAL_FDCAN_ConfigTimestampCounter(FDCAN_HandleTypeDef*, uint32_t);
+HAL_StatusTypeDef HAL_FDCAN_EnableTimestampCounter(FDCAN_HandleTypeDef*, uint32_t);
+uint16_t HAL_FDCAN_GetTimestampCounter(const FDCAN_HandleTypeDef*);
+HAL_StatusTypeDef HAL_FDCAN_GetProtocolStatus(const FDCAN_HandleTypeDef*, FDCAN_ProtocolStatusTypeDef*);
+HAL_StatusTypeDef HAL_FDCAN_GetErrorCounters(const FDCAN_HandleTypeDef*, FDCAN_ErrorCountersTypeDef*);
+HAL_StatusTypeDef HAL_FDCAN_EnableTxDelayCompensation(FDCAN_HandleTypeDef*);
+HAL_StatusTypeDef HAL_FDCAN_ConfigTxDelayCompensation(FDCAN_HandleTypeDef*, uint32_t, uint32_t);
+void HAL_FDCAN_IRQHandler(FDCAN_HandleTypeDef*);
+void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef*, uint32_t);
+void HAL_FDCAN_RxFifo1Callback(FDCAN_HandleTypeDef*, uint32_t);
+void HAL_FDCAN_TxBufferCompleteCallback(FDCAN_HandleTypeDef*, uint32_t);
+void HAL_FDCAN_ErrorStatusCallback(FDCAN_HandleTypeDef*, uint32_t);
+/* ADC */
+typedef struct { volatile uint32_t ISR, CR, DR; } ADC_TypeDef;
+extern ADC_TypeDef *ADC1;
+typedef struct { uint32_t Ratio, RightBitShift, TriggeredMode, OversamplingStopReset; } ADC_OversamplingTypeDef;
+typedef struct { uint32_t ClockPrescaler, Resolution, DataAlign, GainCompensation, ScanConvMode, EOCSelection; FunctionalState LowPowerAutoWait, ContinuousConvMode; uint32_t NbrOfConversion; FunctionalState DiscontinuousConvMode; uint32_t NbrOfDiscConversion, ExternalTrigConv, ExternalTrigConvEdge, SamplingMode; FunctionalState DMAContinuousRequests; uint32_t Overrun; FunctionalState OversamplingMode; ADC_OversamplingTypeDef Oversampling; } ADC_InitTypeDef;
+typedef struct DMA_HandleTypeDef DMA_HandleTypeDef;
+typedef struct { ADC_TypeDef *Instance; ADC_InitTypeDef Init; DMA_HandleTypeDef *DMA_Handle; } ADC_HandleTypeDef;
+typedef struct { uint32_t Mode, DMAAccessMode, TwoSamplingDelay; } ADC_MultiModeTypeDef;
+typedef struct { uint32_t Channel, Rank, SamplingTime, SingleDiff, OffsetNumber, Offset, OffsetSign; FunctionalState OffsetSaturation; } ADC_ChannelConfTypeDef;
+#define ADC_CLOCK_ASYNC_DIV4 2u
+#define ADC_CLOCK_ASYNC_DIV16 7u
+#define ADC_CLOCK_ASYNC_DIV64 9u
+#define ADC_CLOCK_ASYNC_DIV256 11u
+#define ADC_RESOLUTION_12B 0u
+#define ADC_DATAALIGN_RIGHT 0u
+#define ADC_SCAN_DISABLE 0u
+#define ADC_SCAN_ENABLE 1u
+#define ADC_EOC_SINGLE_CONV 4u
+#define ADC_EOC_SEQ_CONV 8u
+#define ADC_SOFTWARE_START 0x1000u
+#define ADC_EXTERNALTRIG_T1_TRGO 0x24u
+#define ADC_EXTERNALTRIG_T1_TRGO2 0x28u
+#define ADC_EXTERNALTRIG_T1_CC1 0x0u
+#define ADC_EXTERNALTRIG_T6_TRGO 0x34u
+#define ADC_EXTERNALTRIGCONVEDGE_NONE 0u
+#define ADC_EXTERNALTRIGCONVEDGE_RISING 0x400u
+#define ADC_OVR_DATA_PRESERVED 0u
+#define ADC_OVR_DATA_OVERWRITTEN 1u
+#define ADC_MODE_INDEPENDENT 0u
+#define ADC_CHANNEL_1 1u
+#define ADC_CHANNEL_2 2u
+#define ADC_CHANNEL_3 3u
+#define ADC_CHANNEL_4 4u
+#define ADC_REGULAR_RANK_1 1u
+#define ADC_REGULAR_RANK_2 2u
+#define ADC_REGULAR_RANK_3 3u
+#define ADC_REGULAR_RANK_4 4u
+#define ADC_SAMPLETIME_247CYCLES_5 6u
+#define ADC_SAMPLETIME_47CYCLES_5 4u
+#define ADC_SAMPLETIME_92CYCLES_5 5u
+#define ADC_SINGLE_ENDED 0u
+#define ADC_OFFSET_NONE 0u
+#define ADC_OVERSAMPLING_RATIO_8 0x8u
+#define ADC_OVERSAMPLING_RATIO_16 0xCu
+#define ADC_OVERSAMPLING_RATIO_64 0x14u
+#define ADC_RIGHTBITSHIFT_1 0x20u
+#define ADC_RIGHTBITSHIFT_2 0x40u
+#define ADC_RIGHTBITSHIFT_4 0x80u
+#define ADC_RIGHTBITSHIFT_6 0xC0u
+#define ADC_TRIGGEREDMODE_SINGLE_TRIGGER 0u
+#define ADC_REGOVERSAMPLING_CONTINUED_MODE 0u
+#define ADC_SAMPLING_MODE_NORMAL 0u
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef*);
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef*);
+HAL_StatusTypeDef HAL_ADC_Stop(ADC_HandleTypeDef*);
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef*, uint32_t*, uint32_t);
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef*);
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef*, uint32_t);
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef*);
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef*, ADC_ChannelConfTypeDef*);
+HAL_StatusTypeDef HAL_ADCEx_MultiModeConfigChannel(ADC_HandleTypeDef*, ADC_MultiModeTypeDef*);
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef*, uint32_t);
+uint32_t HAL_ADCEx_Calibration_GetValue(ADC_HandleTypeDef*, uint32_t);
+HAL_StatusTypeDef HAL_ADCEx_Calibration_SetValue(ADC_HandleTypeDef*, uint32_t, uint32_t);
+HAL_StatusTypeDef ADC_Enable(ADC_HandleTypeDef*);
+void HAL_ADC_IRQHandler(ADC_HandleTypeDef*);
+#define HAL_ADC_STATE_READY 1u
+/* DMA */
+typedef struct { volatile uint32_t CCR, CNDTR; } DMA_Channel_TypeDef;
+extern DMA_Channel_TypeDef *DMA1_Channel1;
+typedef struct { uint32_t Request, Direction, PeriphInc, MemInc, PeriphDataAlignment, MemDataAlignment, Mode, Priority; } DMA_InitTypeDef;
+struct DMA_HandleTypeDef { DMA_Channel_TypeDef *Instance; DMA_InitTypeDef Init; void *Parent; };
+#define DMA_REQUEST_ADC1 5u
+#define DMA_PERIPH_TO_MEMORY 0u
+#define DMA_PINC_DISABLE 0u
+#define DMA_MINC_ENABLE 0x80u
+#define DMA_PDATAALIGN_HALFWORD 0x100u
+#define DMA_MDATAALIGN_HALFWORD 0x400u
+#define DMA_CIRCULAR 0x20u
+#define DMA_PRIORITY_HIGH 0x2000u
+#define DMA_PRIORITY_LOW 0u
+#define DMA1_Channel1_IRQn 11
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef*);
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef*);
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef*);
+#define __HAL_RCC_DMAMUX1_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_DMA1_CLK_ENABLE() ((void)0)
+#define __HAL_LINKDMA(h, f, d) do { (h)->f = &(d); (d).Parent = (h); } while (0)
+#define __HAL_DMA_GET_COUNTER(h) ((h)->Instance->CNDTR)
+#define DMA_IT_TC 2u
+#define DMA_IT_HT 4u
+#define DMA_IT_TE 8u
+#define __HAL_DMA_DISABLE_IT(h, i) ((h)->Instance->CCR &= ~(i))
+#define __HAL_DMA_ENABLE_IT(h, i) ((h)->Instance->CCR |= (i))
+/* TIM */
+typedef struct { volatile uint32_t CR1, CNT, ARR, CCR1, CCR2, CCR3, CCR4, RCR, DIER, SR; } TIM_TypeDef;
+extern TIM_TypeDef *TIM1, *TIM6;
+typedef struct { uint32_t Prescaler, CounterMode, Period, ClockDivision, RepetitionCounter, AutoReloadPreload; } TIM_Base_InitTypeDef;
+typedef struct { TIM_TypeDef *Instance; TIM_Base_InitTypeDef Init; uint32_t Channel; } TIM_HandleTypeDef;
+typedef struct { uint32_t ClockSource, ClockPolarity, ClockPrescaler, ClockFilter; } TIM_ClockConfigTypeDef;
+typedef struct { uint32_t MasterOutputTrigger, MasterOutputTrigger2, MasterSlaveMode; } TIM_MasterConfigTypeDef;
+typedef struct { uint32_t OCMode, Pulse, OCPolarity, OCNPolarity, OCFastMode, OCIdleState, OCNIdleState; } TIM_OC_InitTypeDef;
+typedef struct { uint32_t OffStateRunMode, OffStateIDLEMode, LockLevel, DeadTime, BreakState, BreakPolarity, BreakFilter, BreakAFMode, Break2State, Break2Polarity, Break2Filter, Break2AFMode, AutomaticOutput; } TIM_BreakDeadTimeConfigTypeDef;
+#define TIM_COUNTERMODE_UP 0u
+#define TIM_COUNTERMODE_CENTERALIGNED1 0x20u
+#define TIM_CLOCKDIVISION_DIV1 0u
+#define TIM_AUTORELOAD_PRELOAD_DISABLE 0u
+#define TIM_AUTORELOAD_PRELOAD_ENABLE 0x80u
+#define TIM_CLOCKSOURCE_INTERNAL 0x1000u
+#define TIM_TRGO_RESET 0u
+#define TIM_TRGO_UPDATE 0x20u
+#define TIM_TRGO_OC4REF 0x70u
+#define TIM_TRGO2_RESET 0u
+#define TIM_TRGO2_UPDATE 0x00200000u
+#define TIM_TRGO2_OC4REF 0x00700000u
+#define TIM_MASTERSLAVEMODE_DISABLE 0u
+#define TIM_OCMODE_PWM1 0x60u
+#define TIM_OCMODE_TIMING 0u
+#define TIM_OCPOLARITY_HIGH 0u
+#define TIM_OCNPOLARITY_HIGH 0u
+#define TIM_OCFAST_DISABLE 0u
+#define TIM_OCIDLESTATE_RESET 0u
+#define TIM_OCNIDLESTATE_RESET 0u
+#define TIM_OSSR_DISABLE 0u
+#define TIM_OSSI_DISABLE 0u
+#define TIM_LOCKLEVEL_OFF 0u
+#define TIM_BREAK_DISABLE 0u
+#define TIM_BREAKPOLARITY_HIGH 0u
+#define TIM_BREAK_AFMODE_INPUT 0u
+#define TIM_BREAK2_DISABLE 0u
+#define TIM_BREAK2POLARITY_HIGH 0u
+#define TIM_AUTOMATICOUTPUT_DISABLE 0u
+#define TIM_CHANNEL_1 0x0u
+#define TIM_CHANNEL_2 0x4u
+#define TIM_CHANNEL_3 0x8u
+#define TIM_CHANNEL_4 0xCu
+#define TIM_IT_UPDATE 0x1u
+#define TIM1_UP_TIM16_IRQn 25
+#define TIM6_DAC_IRQn 54
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef*);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef*);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef*);
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef*, TIM_ClockConfigTypeDef*);
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef*);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef*, uint32_t);
+HAL_StatusTypeDef HAL_TIM_OC_Start(TIM_HandleTypeDef*, uint32_t);
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef*, TIM_MasterConfigTypeDef*);
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef*, TIM_OC_InitTypeDef*, uint32_t);
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef*, TIM_OC_InitTypeDef*, uint32_t);
+HAL_StatusTypeDef HAL_TIMEx_ConfigBreakDeadTime(TIM_HandleTypeDef*, TIM_BreakDeadTimeConfigTypeDef*);
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef*);
+#define __HAL_TIM_GET_AUTORELOAD(h) ((h)->Instance->ARR)
+#define __HAL_TIM_SET_COMPARE(h, c, v) ((&(h)->Instance->CCR1)[(c) >> 2] = (v))
+#define __HAL_TIM_GET_COMPARE(h, c) ((&(h)->Instance->CCR1)[(c) >> 2])
+#define __HAL_TIM_GET_COUNTER(h) ((h)->Instance->CNT)
+#define __HAL_TIM_ENABLE_IT(h, i) ((h)->Instance->DIER |= (i))
+/* RCC / PWR / FLASH / misc */
+typedef struct { uint32_t PLLState, PLLSource, PLLM, PLLN, PLLP, PLLQ, PLLR; } RCC_PLLInitTypeDef;
+typedef struct { uint32_t OscillatorType, HSEState; RCC_PLLInitTypeDef PLL; } RCC_OscInitTypeDef;
+typedef struct { uint32_t ClockType, SYSCLKSource, AHBCLKDivider, APB1CLKDivider, APB2CLKDivider; } RCC_ClkInitTypeDef;
+typedef struct { uint32_t PeriphClockSelection, Adc12ClockSelection, FdcanClockSelection; } RCC_PeriphCLKInitTypeDef;
+#define PWR_REGULATOR_VOLTAGE_SCALE1_BOOST 0u
+#define RCC_OSCILLATORTYPE_HSE 1u
+#define RCC_HSE_ON 1u
+#define RCC_PLL_ON 2u
+#define RCC_PLLSOURCE_HSE 3u
+#define RCC_PLLM_DIV2 1u
+#define RCC_PLLP_DIV2 2u
+#define RCC_PLLQ_DIV2 0u
+#define RCC_PLLR_DIV2 0u
+#define RCC_CLOCKTYPE_HCLK 2u
+#define RCC_CLOCKTYPE_SYSCLK 1u
+#define RCC_CLOCKTYPE_PCLK1 4u
+#define RCC_CLOCKTYPE_PCLK2 8u
+#define RCC_SYSCLKSOURCE_PLLCLK 3u
+#define RCC_SYSCLK_DIV1 0u
+#define RCC_SYSCLK_DIV2 0x80u
+#define RCC_SYSCLK_DIV4 0x90u
+#define RCC_SYSCLK_DIV8 0xA0u
+#define RCC_HCLK_DIV1 0u
+#define FLASH_LATENCY_4 4u
+#define RCC_PERIPHCLK_ADC12 1u
+#define RCC_PERIPHCLK_FDCAN 2u
+#define RCC_ADC12CLKSOURCE_SYSCLK 2u
+#define RCC_FDCANCLKSOURCE_PCLK1 1u
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef*);
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef*, uint32_t);
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef*);
+uint32_t HAL_RCC_GetHCLKFreq(void);
+uint32_t HAL_RCC_GetSysClockFreq(void);
+HAL_StatusTypeDef HAL_PWREx_ControlVoltageScaling(uint32_t);
+void HAL_PWREx_DisableUCPDDeadBattery(void);
+void HAL_PWR_EnterSLEEPMode(uint32_t, uint8_t);
+void HAL_SuspendTick(void); void HAL_ResumeTick(void);
+#define PWR_MAINREGULATOR_ON 0u
+#define PWR_LOWPOWERREGULATOR_ON 1u
+#define PWR_SLEEPENTRY_WFI 1u
+#define __HAL_RCC_SYSCFG_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_PWR_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_ADC12_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_ADC12_CLK_DISABLE() ((void)0)
+#define __HAL_RCC_GPIOA_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_GPIOF_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_FDCAN_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_FDCAN_CLK_DISABLE() ((void)0)
+#define __HAL_RCC_TIM1_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_TIM1_CLK_DISABLE() ((void)0)
+#define __HAL_RCC_TIM6_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_TIM6_CLK_DISABLE() ((void)0)
+#define FLASH_PAGE_SIZE 0x800u
+#define FLASH_TYPEERASE_PAGES 0u
+#define FLASH_TYPEPROGRAM_DOUBLEWORD 0u
+#define FLASH_BANK_1 1u
+#define FLASH_BASE 0x08000000u
+typedef struct { uint32_t TypeErase, Banks, Page, NbPages; } FLASH_EraseInitTypeDef;
+typedef struct { volatile uint32_t ECCR; } FLASH_TypeDef;
+extern FLASH_TypeDef *FLASH;
+#define FLASH_ECCR_ADDR_ECC 0x0007FFFFu
+#define FLASH_ECCR_SYSF_ECC (1u << 22)
+#define FLASH_ECCR_ECCC (1u << 30)
+#define FLASH_ECCR_ECCD (1u << 31)
+#define FLASH_FLAG_ECCD FLASH_ECCR_ECCD
+#define __HAL_FLASH_GET_FLAG(f) ((FLASH->ECCR & (f)) == (f))
+#define __HAL_FLASH_CLEAR_FLAG(f) (FLASH->ECCR &= ~(f))   /* Write 1 to clear on the target */
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t, uint32_t, uint64_t);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef*, uint32_t*);
+extern bool mock_flash_sleep_pd;
+#define __HAL_FLASH_SLEEP_POWERDOWN_ENABLE() (mock_flash_sleep_pd = true)
+#define __HAL_FLASH_SLEEP_POWERDOWN_DISABLE() (mock_flash_sleep_pd = false)
+typedef struct { volatile uint32_t DEMCR; } CoreDebug_Type;
+extern CoreDebug_Type *CoreDebug;
+#define CoreDebug_DEMCR_TRCENA_Msk (1u << 24)
+typedef struct { volatile uint32_t CTRL, CYCCNT; } DWT_Type;
+extern DWT_Type *DWT;
+#define DWT_CTRL_CYCCNTENA_Msk 1u
+typedef struct { volatile uint32_t SCR; } SCB_Type;
+extern SCB_Type *SCB;
+#define SCB_SCR_SLEEPONEXIT_Msk 2u
+#define SCB_SCR_SLEEPDEEP_Msk 4u
+extern uint32_t SystemCoreClock;
+void SystemCoreClockUpdate(void);
+#define ADC_TRIGGEREDMODE_MULTI_TRIGGER 0x200u
+#define TIM_OCMODE_PWM2 0x70u
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef*);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+
+#endif /* STM32G4XX_HAL_MOCK_H */
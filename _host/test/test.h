@@ -0,0 +1,57 @@
+/**
+ * @file test.h
+ * @brief Minimal test runner for the host build
+ * 
+ * A failed assertion ends the current test case; the runner counts
+ * failures and returns non-zero for ctest.
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef void (*Test_Fn_t)(void);
+
+typedef struct {
+    const char *name;
+    Test_Fn_t fn;
+} Test_Case_t;
+
+typedef struct {
+    const char *name;
+    const Test_Case_t *cases;
+    uint32_t count;
+} Test_Suite_t;
+
+#define TEST_CASE(fn)               { #fn, fn }
+#define TEST_SUITE(name, cases)     { name, cases, sizeof(cases) / sizeof(cases[0]) }
+
+/** Record a failure of the running test case */
+void Test_Fail(const char *file, int line, const char *expr, long long a, long long b);
+
+#define TEST_ASSERT(cond) do {                                  \
+        if (!(cond)) {                                          \
+            Test_Fail(__FILE__, __LINE__, #cond, 0, 0);         \
+            return;                                             \
+        }                                                       \
+    } while (0)
+
+#define TEST_ASSERT_EQ(a, b) do {                               \
+        long long test_a_ = (long long)(a);                     \
+        long long test_b_ = (long long)(b);                     \
+        if (test_a_ != test_b_) {                               \
+            Test_Fail(__FILE__, __LINE__, #a " == " #b, test_a_, test_b_); \
+            return;                                             \
+        }                                                       \
+    } while (0)
+
+/* Suites, one per test_*.c */
+extern const Test_Suite_t test_suite_can;
+extern const Test_Suite_t test_suite_codec;
+extern const Test_Suite_t test_suite_brake;
+extern const Test_Suite_t test_suite_storage;
+extern const Test_Suite_t test_suite_controller;
+
+#endif /* TEST_H */
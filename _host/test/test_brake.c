@@ -0,0 +1,137 @@
+/**
+ * @file test_brake.c
+ * @brief Brake state machine on the simulated actuator
+ */
+
+#include "test.h"
+#include "mock_hal.h"
+#include "mock_board.h"
+#include "main.h"
+#include "left_break.h"
+#include "automate.h"
+
+#define PUSH                        AUTOMATE_LEFT_BRAKE_CMD_BRAKE_STATE_PUSH_CHOICE
+#define RELEASE                     AUTOMATE_LEFT_BRAKE_CMD_BRAKE_STATE_RELEASE_CHOICE
+
+static void Setup(uint16_t position, bool plant)
+{
+    Mock_PlantEnable(plant);
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        /* Before Brake_Init() - rank i samples brake i (brake_configs[]) */
+        Mock_AdcSet(i, position);
+    }
+    Mock_FlashErase();
+    Mock_Boot();
+}
+
+/**
+ * @brief Run the control loop until a brake reaches a state
+ * 
+ * @return Milliseconds taken, or UINT32_MAX on timeout
+ */
+static uint32_t WaitForState(const Brake_t *brake, BrakeState_t state, uint32_t timeout_ms)
+{
+    for (uint32_t ms = 0; ms < timeout_ms; ms++) {
+        if (Brake_GetState(brake) == state) {
+            return ms;
+        }
+        Mock_Tick(1);
+    }
+    return UINT32_MAX;
+}
+
+static void test_init_released(void)
+{
+    Setup(200, false);
+    
+    TEST_ASSERT_EQ(Mock_GetErrorCount(), 0);
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        const Brake_t *brake = Brake_Get(i);
+    
+        TEST_ASSERT_EQ(Brake_GetState(brake), BRAKE_STATE_RELEASED);
+        TEST_ASSERT_EQ(Brake_GetPosition(brake), 200);
+        TEST_ASSERT(!Brake_HasError(brake));
+    }
+    TEST_ASSERT(!Brake_IsCalibrationRestored());
+}
+
+static void test_init_pushed(void)
+{
+    Setup(3800, false);
+    
+    TEST_ASSERT_EQ(Brake_GetState(Brake_Get(BRAKE_LEFT)), BRAKE_STATE_PUSHED);
+    TEST_ASSERT_EQ(Brake_GetPosition(Brake_Get(BRAKE_LEFT)), 3800);
+}
+
+static void test_push_and_release(void)
+{
+    Brake_t *brake;
+    
+    Setup(200, true);
+    brake = Brake_Get(BRAKE_LEFT);
+    
+    Brake_ProcessCommand(brake, PUSH);
+    Mock_Tick(2);
+    TEST_ASSERT_EQ(Brake_GetState(brake), BRAKE_STATE_PUSHING);
+    TEST_ASSERT_EQ(Mock_GpioRead(MOTOR_INH_GPIO_Port, MOTOR_INH_Pin), GPIO_PIN_SET);
+    TEST_ASSERT(TIM1->CCR1 > 0u);
+    
+    TEST_ASSERT(WaitForState(brake, BRAKE_STATE_PUSHED, 2000) != UINT32_MAX);
+    TEST_ASSERT_EQ(TIM1->CCR1, 0);
+    TEST_ASSERT(Brake_GetPosition(brake) >= 3700u);
+    
+    /* Other instance did not move */
+#if BRAKE_COUNT > 1
+    TEST_ASSERT_EQ(Brake_GetState(Brake_Get(BRAKE_RIGHT)), BRAKE_STATE_RELEASED);
+    TEST_ASSERT_EQ(TIM1->CCR3, 0);
+#endif
+    
+    Brake_ProcessCommand(brake, RELEASE);
+    TEST_ASSERT(WaitForState(brake, BRAKE_STATE_RELEASED, 2000) != UINT32_MAX);
+    TEST_ASSERT_EQ(TIM1->CCR1, 0);
+    TEST_ASSERT(Brake_GetPosition(brake) <= 300u);
+    TEST_ASSERT(!Brake_HasError(brake));
+}
+
+static void test_push_timeout_stops(void)
+{
+    Brake_t *brake;
+    
+    /* Actuator does not move: operation must give up */
+    Setup(200, false);
+    brake = Brake_Get(BRAKE_LEFT);
+    
+    Brake_ProcessCommand(brake, PUSH);
+    Mock_Tick(10);
+    TEST_ASSERT_EQ(Brake_GetState(brake), BRAKE_STATE_PUSHING);
+    
+    TEST_ASSERT(WaitForState(brake, BRAKE_STATE_STOPPED, 6000) != UINT32_MAX);
+    TEST_ASSERT_EQ(TIM1->CCR1, 0);
+    TEST_ASSERT_EQ(Mock_GpioRead(MOTOR_INH_GPIO_Port, MOTOR_INH_Pin), GPIO_PIN_RESET);
+}
+
+static void test_emergency_stop(void)
+{
+    Brake_t *brake;
+    
+    Setup(200, true);
+    brake = Brake_Get(BRAKE_LEFT);
+    
+    Brake_ProcessCommand(brake, PUSH);
+    Mock_Tick(20);
+    Brake_EmergencyStop(brake);
+    Mock_Tick(1);
+    
+    TEST_ASSERT_EQ(TIM1->CCR1, 0);
+    TEST_ASSERT(Brake_GetState(brake) != BRAKE_STATE_PUSHING);
+}
+
+static const Test_Case_t cases[] = {
+    TEST_CASE(test_init_released),
+    TEST_CASE(test_init_pushed),
+    TEST_CASE(test_push_and_release),
+    TEST_CASE(test_push_timeout_stops),
+    TEST_CASE(test_emergency_stop),
+};
+
+const Test_Suite_t test_suite_brake = TEST_SUITE("brake", cases);
@@ -0,0 +1,406 @@
+/**
+ * @file test_can.c
+ * @brief CAN driver: DLC mapping, TX priority and order, RX filters and queue,
+ *        bus-off supervision and rejoin
+ */
+
+#include <string.h>
+#include "test.h"
+#include "mock_hal.h"
+#include "mock_board.h"
+#include "can.h"
+#include "automate.h"
+#include "automate_codec.h"
+
+/* Defaults of can.c */
+#define HOLDOFF_MIN_MS      10u
+#define STABLE_MS           1000u
+
+static void Setup(void)
+{
+    Mock_FlashErase();
+    Mock_Boot();
+    Mock_CanSetAutoComplete(false);
+    Mock_CanClearSent();
+}
+
+static void test_dlc_round_trip(void)
+{
+    for (uint8_t len = 0; len <= 64u; len++) {
+        uint8_t dlc = CAN_Driver_LenToDlc(len);
+    
+        TEST_ASSERT(CAN_Driver_DlcToLen(dlc) >= len);
+        if (dlc > 0u) {
+            TEST_ASSERT(CAN_Driver_DlcToLen(dlc - 1u) < len);
+        }
+    }
+}
+
+static void test_tx_fifo_order(void)
+{
+    /* Hardware FIFO takes 3, the ring the rest */
+    const uint32_t count = CAN_TX_BUFFER_SIZE + 3u;
+    uint8_t data[8] = { 0 };
+    Mock_CanFrame_t frame;
+    
+    Setup();
+    for (uint32_t i = 0; i < count; i++) {
+        data[0] = (uint8_t)i;
+        TEST_ASSERT(CAN_Driver_Send(0x100u + i, data, sizeof(data)));
+    }
+    TEST_ASSERT_EQ(Mock_CanGetPendingTx(), 3);
+    
+    while (Mock_CanCompleteTx(1) > 0u) {
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        TEST_ASSERT(Mock_CanPopSent(&frame));
+        TEST_ASSERT_EQ(frame.id, 0x100u + i);
+        TEST_ASSERT_EQ(frame.data[0], (uint8_t)i);
+        TEST_ASSERT_EQ(frame.len, 8);
+        TEST_ASSERT(frame.is_extended);
+    }
+    TEST_ASSERT(!Mock_CanPopSent(&frame));
+    TEST_ASSERT_EQ(Mock_GetErrorCount(), 0);
+}
+
+/* TX complete flag raised, then an RX frame on the other line */
+static void CompleteAndReceive(void)
+{
+    uint8_t data[8] = { 0 };
+    
+    (void)Mock_CanCompleteTx(1);
+    (void)Mock_CanReceive(AUTOMATE_HEART_BEAT_MSG_FRAME_ID, true, data, sizeof(data));
+}
+
+static void test_tx_refill_preempted_by_rx(void)
+{
+    uint8_t data[8] = { 0 };
+    Mock_CanFrame_t frame;
+    
+    Setup();
+    
+    /* The RX interrupt also services TX complete; the main-loop refill must keep it out */
+    Mock_CanOnTxLoad(CompleteAndReceive);
+    for (uint32_t i = 0; i < 3u; i++) {
+        TEST_ASSERT(CAN_Driver_Send(0x100u + i, data, sizeof(data)));
+    }
+    TEST_ASSERT_EQ(CAN_Driver_GetRxCount(), 1);
+    
+    while (Mock_CanCompleteTx(1) > 0u) {
+    }
+    for (uint32_t i = 0; i < 3u; i++) {
+        TEST_ASSERT(Mock_CanPopSent(&frame));
+        TEST_ASSERT_EQ(frame.id, 0x100u + i);
+    }
+    TEST_ASSERT(!Mock_CanPopSent(&frame));
+    TEST_ASSERT_EQ(CAN_Driver_GetTxCount(), 0);
+}
+
+static void test_tx_high_priority_first(void)
+{
+    static const uint32_t expected[] = { 0x200, 0x201, 0x202, 0x300, 0x203 };
+    uint8_t data[2] = { 0xAA, 0x55 };
+    Mock_CanFrame_t frame;
+    
+    Setup();
+    /* Fill the hardware FIFO and queue one more, the smallest ring holds it */
+    for (uint32_t i = 0; i < 4u; i++) {
+        TEST_ASSERT(CAN_Driver_Send(0x200u + i, data, sizeof(data)));
+    }
+    TEST_ASSERT(CAN_Driver_SendPriority(0x300u, data, sizeof(data), CAN_TX_PRIORITY_HIGH));
+    
+    while (Mock_CanCompleteTx(1) > 0u) {
+    }
+    
+    for (uint32_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        TEST_ASSERT(Mock_CanPopSent(&frame));
+        TEST_ASSERT_EQ(frame.id, expected[i]);
+        TEST_ASSERT_EQ(frame.len, 2);
+    }
+}
+
+static void test_tx_queue_full(void)
+{
+    uint8_t data[8] = { 0 };
+    CAN_Driver_Stats_t stats;
+    
+    Setup();
+    
+    /* Hardware FIFO takes 3, the ring the rest */
+    for (uint32_t i = 0; i < CAN_TX_BUFFER_SIZE + 3u; i++) {
+        TEST_ASSERT(CAN_Driver_Send(0x400u, data, sizeof(data)));
+    }
+    TEST_ASSERT(!CAN_Driver_Send(0x400u, data, sizeof(data)));
+    
+    /* A commit without a reservation must not publish the oldest frame again */
+    TEST_ASSERT(CAN_Driver_TxReserve(CAN_TX_PRIORITY_NORMAL) == NULL);
+    TEST_ASSERT(!CAN_Driver_TxCommit(CAN_TX_PRIORITY_NORMAL));
+    
+    CAN_Driver_GetStats(&stats);
+    TEST_ASSERT_EQ(stats.tx_dropped, 2);
+    TEST_ASSERT_EQ(stats.tx_frames, 3);
+    TEST_ASSERT_EQ(CAN_Driver_GetTxCount(), CAN_TX_BUFFER_SIZE);
+}
+
+static void test_rx_filter_index(void)
+{
+    uint8_t data[8] = { 0 };
+    const CAN_Message_t *msg;
+    
+    Setup();
+    
+    /* Controller_Init() programmed one element per handler and rejects the rest */
+    TEST_ASSERT(!Mock_CanReceive(0x1800ad55u, true, data, sizeof(data)));
+    TEST_ASSERT(!Mock_CanReceive(AUTOMATE_HEART_BEAT_MSG_FRAME_ID & 0x7FFu, false, data, sizeof(data)));
+    TEST_ASSERT_EQ(CAN_Driver_GetRxCount(), 0);
+    
+    TEST_ASSERT(Mock_CanReceive(AUTOMATE_HEART_BEAT_MSG_FRAME_ID, true, data, sizeof(data)));
+    TEST_ASSERT(Mock_CanReceive(AUTOMATE_LEFT_BRAKE_CMD_FRAME_ID, true, data, sizeof(data)));
+    
+    msg = CAN_Driver_RxPeek();
+    TEST_ASSERT(msg != NULL);
+    TEST_ASSERT_EQ(msg->id, AUTOMATE_HEART_BEAT_MSG_FRAME_ID);
+    TEST_ASSERT_EQ(msg->filter_index, 0);
+    TEST_ASSERT(msg->is_extended);
+    TEST_ASSERT_EQ(msg->len, 8);
+    CAN_Driver_RxRelease();
+    
+    msg = CAN_Driver_RxPeek();
+    TEST_ASSERT(msg != NULL);
+    TEST_ASSERT_EQ(msg->id, AUTOMATE_LEFT_BRAKE_CMD_FRAME_ID);
+    TEST_ASSERT_EQ(msg->filter_index, 1);
+    CAN_Driver_RxRelease();
+    
+    TEST_ASSERT(CAN_Driver_RxPeek() == NULL);
+}
+
+static void test_rx_queue_overflow(void)
+{
+    uint8_t data[8] = { 0 };
+    CAN_Driver_Stats_t stats;
+    CAN_Message_t msg;
+    
+    Setup();
+    for (uint32_t i = 0; i < CAN_RX_BUFFER_SIZE + 2u; i++) {
+        data[0] = (uint8_t)i;
+        TEST_ASSERT(Mock_CanReceive(AUTOMATE_HEART_BEAT_MSG_FRAME_ID, true, data, sizeof(data)));
+    }
+    
+    CAN_Driver_GetStats(&stats);
+    TEST_ASSERT_EQ(stats.rx_frames, CAN_RX_BUFFER_SIZE);
+    TEST_ASSERT_EQ(stats.rx_dropped, 2);
+    TEST_ASSERT_EQ(stats.rx_high_watermark, CAN_RX_BUFFER_SIZE);
+    
+    /* Oldest frames are kept */
+    for (uint32_t i = 0; i < CAN_RX_BUFFER_SIZE; i++) {
+        TEST_ASSERT(CAN_Driver_Get(&msg));
+        TEST_ASSERT_EQ(msg.data[0], i);
+    }
+    TEST_ASSERT(!CAN_Driver_HasMessage());
+}
+
+/**
+ * @brief Tick and supervise like the scheduler until the bus reaches a state
+ * 
+ * @return Milliseconds it took, limit + 1 if it never did
+ */
+static uint32_t SuperviseUntil(CAN_BusState_t state, uint32_t limit)
+{
+    for (uint32_t ms = 0; ms <= limit; ms++) {
+        CAN_Driver_Supervise();
+        if (CAN_Driver_GetBusState() == state) {
+            return ms;
+        }
+        Mock_Tick(1);
+    }
+    
+    return limit + 1u;
+}
+
+static void test_bus_off_rejoin(void)
+{
+    uint8_t data[8] = { 0 };
+    CAN_Driver_BusStatus_t status;
+    Mock_CanFrame_t frame;
+    
+    Setup();
+    CAN_Driver_Supervise();
+    TEST_ASSERT_EQ(CAN_Driver_GetBusState(), CAN_BUS_STATE_ACTIVE);
+    
+    Mock_CanBusOff();
+    CAN_Driver_GetBusStatus(&status);
+    TEST_ASSERT(status.bus_off);
+    TEST_ASSERT_EQ(status.bus_off_events, 1);
+    
+    /* First bus-off restarts at once, the hardware needs the recovery sequence */
+    CAN_Driver_Supervise();
+    TEST_ASSERT_EQ(CAN_Driver_GetBusState(), CAN_BUS_STATE_RECOVERING);
+    TEST_ASSERT(CAN_Driver_Send(0x500u, data, sizeof(data)));
+    TEST_ASSERT_EQ(Mock_CanCompleteTx(1), 0);
+    
+    TEST_ASSERT(SuperviseUntil(CAN_BUS_STATE_ACTIVE, 10u) <= MOCK_CAN_RECOVERY_MS);
+    
+    CAN_Driver_GetBusStatus(&status);
+    TEST_ASSERT(!status.bus_off);
+    TEST_ASSERT_EQ(status.tx_error_count, 0);
+    TEST_ASSERT_EQ(status.recoveries, 1);
+    TEST_ASSERT(status.last_recovery_ms >= MOCK_CAN_RECOVERY_MS);
+    TEST_ASSERT(status.last_recovery_ms <= MOCK_CAN_RECOVERY_MS + 1u);
+    
+    /* Frame queued during bus-off goes out after rejoin */
+    TEST_ASSERT_EQ(Mock_CanCompleteTx(1), 1);
+    TEST_ASSERT(Mock_CanFindSent(0x500u, &frame));
+    TEST_ASSERT_EQ(Mock_GetErrorCount(), 0);
+}
+
+static void test_bus_off_holdoff(void)
+{
+    uint32_t holdoff = HOLDOFF_MIN_MS;
+    
+    Setup();
+    Mock_CanBusOff();
+    TEST_ASSERT(SuperviseUntil(CAN_BUS_STATE_ACTIVE, 10u) <= MOCK_CAN_RECOVERY_MS);
+    
+    /* Repeated bus-off right after rejoin backs off, doubling each time */
+    for (uint32_t i = 0; i < 3u; i++) {
+        uint32_t waited;
+    
+        Mock_CanBusOff();
+        CAN_Driver_Supervise();
+        TEST_ASSERT_EQ(CAN_Driver_GetBusState(), CAN_BUS_STATE_BUS_OFF);
+    
+        waited = SuperviseUntil(CAN_BUS_STATE_RECOVERING, 2u * holdoff);
+        TEST_ASSERT_EQ(waited, holdoff);
+        TEST_ASSERT(SuperviseUntil(CAN_BUS_STATE_ACTIVE, 10u) <= MOCK_CAN_RECOVERY_MS);
+        holdoff *= 2u;
+    }
+    
+    /* Stable long enough - next bus-off restarts at once again */
+    TEST_ASSERT(SuperviseUntil(CAN_BUS_STATE_BUS_OFF, STABLE_MS + 10u) > STABLE_MS + 10u);
+    Mock_CanBusOff();
+    CAN_Driver_Supervise();
+    TEST_ASSERT_EQ(CAN_Driver_GetBusState(), CAN_BUS_STATE_RECOVERING);
+}
+
+static void test_bus_error_states(void)
+{
+    CAN_Driver_BusStatus_t status;
+    
+    Setup();
+    
+    Mock_CanSetErrorCounters(96, 0);
+    CAN_Driver_Supervise();
+    TEST_ASSERT_EQ(CAN_Driver_GetBusState(), CAN_BUS_STATE_WARNING);
+    
+    Mock_CanSetErrorCounters(0, 128);
+    CAN_Driver_Supervise();
+    TEST_ASSERT_EQ(CAN_Driver_GetBusState(), CAN_BUS_STATE_PASSIVE);
+    CAN_Driver_GetBusStatus(&status);
+    TEST_ASSERT(status.error_passive);
+    TEST_ASSERT(!status.bus_off);
+    
+    Mock_CanSetErrorCounters(10, 5);
+    CAN_Driver_Supervise();
+    TEST_ASSERT_EQ(CAN_Driver_GetBusState(), CAN_BUS_STATE_ACTIVE);
+    CAN_Driver_GetBusStatus(&status);
+    TEST_ASSERT_EQ(status.tx_error_count, 10);
+    TEST_ASSERT_EQ(status.rx_error_count, 5);
+    TEST_ASSERT_EQ(status.bus_off_events, 0);
+}
+
+/**
+ * @brief Go bus-off with the hardware FIFO full (0x100-0x102), queue a
+ *        normal (0x300) and a high-priority (0x200) frame while off the
+ *        bus, rejoin and transmit everything left
+ */
+static void BusOffWithQueuedFrames(CAN_RecoveryPolicy_t policy)
+{
+    uint8_t data[8] = { 0 };
+    
+    Setup();
+    CAN_Driver_SetRecoveryPolicy(policy);
+    for (uint32_t i = 0; i < 3u; i++) {
+        TEST_ASSERT(CAN_Driver_Send(0x100u + i, data, sizeof(data)));
+    }
+    
+    Mock_CanBusOff();
+    TEST_ASSERT(CAN_Driver_Send(0x300u, data, sizeof(data)));
+    TEST_ASSERT(CAN_Driver_SendPriority(0x200u, data, sizeof(data), CAN_TX_PRIORITY_HIGH));
+    
+    TEST_ASSERT(SuperviseUntil(CAN_BUS_STATE_ACTIVE, 10u) <= MOCK_CAN_RECOVERY_MS);
+    while (Mock_CanCompleteTx(1) > 0u) {
+    }
+}
+
+static void test_recovery_policy(void)
+{
+    Mock_CanFrame_t frame;
+    
+    BusOffWithQueuedFrames(CAN_RECOVERY_KEEP_QUEUED);
+    TEST_ASSERT(Mock_CanFindSent(0x100u, &frame));
+    TEST_ASSERT(Mock_CanFindSent(0x102u, &frame));
+    TEST_ASSERT(Mock_CanFindSent(0x200u, &frame));
+    TEST_ASSERT(Mock_CanFindSent(0x300u, &frame));
+    
+    /* Default: stale normal frames go, heartbeat/fault frames stay */
+    BusOffWithQueuedFrames(CAN_RECOVERY_FLUSH_NORMAL);
+    TEST_ASSERT(Mock_CanFindSent(0x100u, &frame));
+    TEST_ASSERT(Mock_CanFindSent(0x200u, &frame));
+    TEST_ASSERT(!Mock_CanFindSent(0x300u, &frame));
+    TEST_ASSERT_EQ(CAN_Driver_GetTxCount(), 0);
+    
+    BusOffWithQueuedFrames(CAN_RECOVERY_FLUSH_ALL);
+    TEST_ASSERT(!Mock_CanFindSent(0x100u, &frame));
+    TEST_ASSERT(!Mock_CanFindSent(0x200u, &frame));
+    TEST_ASSERT(!Mock_CanFindSent(0x300u, &frame));
+    TEST_ASSERT_EQ(Mock_CanGetPendingTx(), 0);
+}
+
+/* TX complete still pending, serviced by an RX interrupt on the other line */
+static void RaiseTxCompleteOnRxLine(void)
+{
+    Mock_CanRaiseIrq(FDCAN_IT_RX_FIFO0_NEW_MESSAGE, true);
+}
+
+static void test_recovery_flush_preempted_by_rx(void)
+{
+    uint8_t data[8] = { 0 };
+    Mock_CanFrame_t frame;
+    
+    Setup();
+    CAN_Driver_SetRecoveryPolicy(CAN_RECOVERY_FLUSH_ALL);
+    for (uint32_t i = 0; i < 3u; i++) {
+        TEST_ASSERT(CAN_Driver_Send(0x100u + i, data, sizeof(data)));
+    }
+    Mock_CanBusOff();
+    TEST_ASSERT(CAN_Driver_Send(0x300u, data, sizeof(data)));
+    TEST_ASSERT(CAN_Driver_SendPriority(0x200u, data, sizeof(data), CAN_TX_PRIORITY_HIGH));
+    
+    /* A refill between abort and flush would reload the stale frames */
+    Mock_CanOnTxAbort(RaiseTxCompleteOnRxLine);
+    TEST_ASSERT(SuperviseUntil(CAN_BUS_STATE_ACTIVE, 10u) <= MOCK_CAN_RECOVERY_MS);
+    while (Mock_CanCompleteTx(1) > 0u) {
+    }
+    
+    TEST_ASSERT(!Mock_CanFindSent(0x200u, &frame));
+    TEST_ASSERT(!Mock_CanFindSent(0x300u, &frame));
+    TEST_ASSERT_EQ(CAN_Driver_GetTxCount(), 0);
+}
+
+static const Test_Case_t cases[] = {
+    TEST_CASE(test_dlc_round_trip),
+    TEST_CASE(test_tx_fifo_order),
+    TEST_CASE(test_tx_refill_preempted_by_rx),
+    TEST_CASE(test_tx_high_priority_first),
+    TEST_CASE(test_tx_queue_full),
+    TEST_CASE(test_rx_filter_index),
+    TEST_CASE(test_rx_queue_overflow),
+    TEST_CASE(test_bus_off_rejoin),
+    TEST_CASE(test_bus_off_holdoff),
+    TEST_CASE(test_bus_error_states),
+    TEST_CASE(test_recovery_policy),
+    TEST_CASE(test_recovery_flush_preempted_by_rx),
+};
+
+const Test_Suite_t test_suite_can = TEST_SUITE("can", cases);
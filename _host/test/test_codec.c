@@ -0,0 +1,175 @@
+/**
+ * @file test_codec.c
+ * @brief Table-driven codec (automate_codec.h) against the generated automate.c
+ * 
+ * Both must produce the same bytes and the same structs for every frame,
+ * checked over pseudo-random in-range signal values.
+ */
+
+#include <string.h>
+#include "test.h"
+#include "automate.h"
+#include "automate_codec.h"
+
+#define CODEC_ROUNDS                1000u
+
+static uint32_t rng_state = 1u;
+
+static uint32_t Random(uint32_t bits)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (bits >= 32u) ? rng_state : (rng_state >> 8) & ((1u << bits) - 1u);
+}
+
+static void test_heart_beat_msg(void)
+{
+    for (uint32_t i = 0; i < CODEC_ROUNDS; i++) {
+        struct automate_heart_beat_msg_t msg = {
+            .node_id = (uint8_t)Random(8), .msg_count = Random(32),
+            .health = (uint8_t)(Random(8) % 6u), .stamp = (uint16_t)Random(16),
+        };
+        struct automate_heart_beat_msg_t a;
+        struct automate_heart_beat_msg_t b;
+        uint8_t generated[AUTOMATE_HEART_BEAT_MSG_LENGTH];
+        uint8_t table[AUTOMATE_HEART_BEAT_MSG_LENGTH];
+    
+        TEST_ASSERT_EQ(automate_heart_beat_msg_pack(generated, &msg, sizeof(generated)), sizeof(generated));
+        TEST_ASSERT_EQ(automate_codec_heart_beat_msg_pack(table, &msg, sizeof(table)), sizeof(table));
+        TEST_ASSERT(memcmp(generated, table, sizeof(table)) == 0);
+    
+        TEST_ASSERT_EQ(automate_heart_beat_msg_unpack(&a, table, sizeof(table)), 0);
+        TEST_ASSERT_EQ(automate_codec_heart_beat_msg_unpack(&b, table, sizeof(table)), 0);
+        TEST_ASSERT(a.node_id == msg.node_id && b.node_id == msg.node_id);
+        TEST_ASSERT(a.msg_count == msg.msg_count && b.msg_count == msg.msg_count);
+        TEST_ASSERT(a.health == msg.health && b.health == msg.health);
+        TEST_ASSERT(a.stamp == msg.stamp && b.stamp == msg.stamp);
+    }
+}
+
+static void test_left_brake_cmd(void)
+{
+    for (uint32_t i = 0; i < CODEC_ROUNDS; i++) {
+        struct automate_left_brake_cmd_t msg = {
+            .msg_id = (uint8_t)Random(8), .stamp = (uint16_t)Random(16),
+            .brake_state = (uint8_t)Random(1),
+        };
+        struct automate_left_brake_cmd_t a;
+        struct automate_left_brake_cmd_t b;
+        uint8_t generated[AUTOMATE_LEFT_BRAKE_CMD_LENGTH];
+        uint8_t table[AUTOMATE_LEFT_BRAKE_CMD_LENGTH];
+    
+        TEST_ASSERT_EQ(automate_left_brake_cmd_pack(generated, &msg, sizeof(generated)), sizeof(generated));
+        TEST_ASSERT_EQ(automate_codec_left_brake_cmd_pack(table, &msg, sizeof(table)), sizeof(table));
+        TEST_ASSERT(memcmp(generated, table, sizeof(table)) == 0);
+    
+        TEST_ASSERT_EQ(automate_left_brake_cmd_unpack(&a, table, sizeof(table)), 0);
+        TEST_ASSERT_EQ(automate_codec_left_brake_cmd_unpack(&b, table, sizeof(table)), 0);
+        TEST_ASSERT(a.msg_id == msg.msg_id && b.msg_id == msg.msg_id);
+        TEST_ASSERT(a.stamp == msg.stamp && b.stamp == msg.stamp);
+        TEST_ASSERT(a.brake_state == msg.brake_state && b.brake_state == msg.brake_state);
+    }
+}
+
+static void test_left_brake_msg(void)
+{
+    for (uint32_t i = 0; i < CODEC_ROUNDS; i++) {
+        struct automate_left_brake_msg_t msg;
+        struct automate_left_brake_msg_t b;
+        uint8_t generated[AUTOMATE_LEFT_BRAKE_MSG_LENGTH];
+        uint8_t table[AUTOMATE_LEFT_BRAKE_MSG_LENGTH];
+    
+        /* Cleared padding, structs are compared whole */
+        memset(&msg, 0, sizeof(msg));
+        memset(&b, 0, sizeof(b));
+        msg.msg_id = (uint8_t)Random(8);
+        msg.stamp = (uint16_t)Random(16);
+        msg.brake_releasing = (uint8_t)Random(1);
+        msg.brake_released = (uint8_t)Random(1);
+        msg.brake_pushing = (uint8_t)Random(1);
+        msg.brake_pushed = (uint8_t)Random(1);
+        msg.time_to_end_operation = (uint16_t)Random(16);
+        msg.cmd_msg_id = (uint8_t)Random(8);
+        msg.cmd_latency = (uint8_t)Random(8);
+    
+        TEST_ASSERT_EQ(automate_left_brake_msg_pack(generated, &msg, sizeof(generated)), sizeof(generated));
+        TEST_ASSERT_EQ(automate_codec_left_brake_msg_pack(table, &msg, sizeof(table)), sizeof(table));
+        TEST_ASSERT(memcmp(generated, table, sizeof(table)) == 0);
+    
+        TEST_ASSERT_EQ(automate_codec_left_brake_msg_unpack(&b, generated, sizeof(generated)), 0);
+        TEST_ASSERT(memcmp(&b, &msg, sizeof(msg)) == 0);
+    }
+}
+
+static void test_mcu_diag_msg(void)
+{
+    for (uint32_t i = 0; i < CODEC_ROUNDS; i++) {
+        struct automate_mcu_diag_msg_t msg;
+        struct automate_mcu_diag_msg_t b;
+        uint8_t generated[AUTOMATE_MCU_DIAG_MSG_LENGTH];
+        uint8_t table[AUTOMATE_MCU_DIAG_MSG_LENGTH];
+    
+        memset(&msg, 0, sizeof(msg));
+        memset(&b, 0, sizeof(b));
+        msg.rx_frames = (uint16_t)Random(12);
+        msg.tx_frames = (uint16_t)Random(12);
+        msg.ring_drops = (uint8_t)Random(8);
+        msg.tec = (uint8_t)Random(8);
+        msg.rec = (uint8_t)Random(7);
+        msg.bus_off = (uint8_t)Random(1);
+        msg.bus_off_count = (uint8_t)Random(4);
+        msg.loop_overruns = (uint8_t)Random(4);
+        msg.cpu_load = (uint8_t)(Random(8) % 101u);
+    
+        TEST_ASSERT_EQ(automate_mcu_diag_msg_pack(generated, &msg, sizeof(generated)), sizeof(generated));
+        TEST_ASSERT_EQ(automate_codec_mcu_diag_msg_pack(table, &msg, sizeof(table)), sizeof(table));
+        TEST_ASSERT(memcmp(generated, table, sizeof(table)) == 0);
+    
+        TEST_ASSERT_EQ(automate_codec_mcu_diag_msg_unpack(&b, generated, sizeof(generated)), 0);
+        TEST_ASSERT(memcmp(&b, &msg, sizeof(msg)) == 0);
+    }
+}
+
+static void test_mcu_config_cmd(void)
+{
+    for (uint32_t i = 0; i < CODEC_ROUNDS; i++) {
+        struct automate_mcu_config_cmd_t msg;
+        struct automate_mcu_config_cmd_t b;
+        uint8_t generated[AUTOMATE_MCU_CONFIG_CMD_LENGTH];
+        uint8_t table[AUTOMATE_MCU_CONFIG_CMD_LENGTH];
+    
+        memset(&msg, 0, sizeof(msg));
+        memset(&b, 0, sizeof(b));
+        msg.target_node_id = (uint8_t)Random(8);
+        msg.node_id = (uint8_t)Random(8);
+        msg.heartbeat_cycle = (uint16_t)Random(16);
+        msg.telemetry_cycle = (uint16_t)Random(16);
+        msg.watchdog_timeout = (uint16_t)Random(16);
+    
+        TEST_ASSERT_EQ(automate_mcu_config_cmd_pack(generated, &msg, sizeof(generated)), sizeof(generated));
+        TEST_ASSERT_EQ(automate_codec_mcu_config_cmd_pack(table, &msg, sizeof(table)), sizeof(table));
+        TEST_ASSERT(memcmp(generated, table, sizeof(table)) == 0);
+    
+        TEST_ASSERT_EQ(automate_codec_mcu_config_cmd_unpack(&b, generated, sizeof(generated)), 0);
+        TEST_ASSERT(memcmp(&b, &msg, sizeof(msg)) == 0);
+    }
+}
+
+static void test_short_buffer(void)
+{
+    struct automate_left_brake_cmd_t msg = { 0 };
+    uint8_t data[AUTOMATE_LEFT_BRAKE_CMD_LENGTH] = { 0 };
+    
+    TEST_ASSERT(automate_codec_left_brake_cmd_pack(data, &msg, sizeof(data) - 1u) < 0);
+    TEST_ASSERT(automate_codec_left_brake_cmd_unpack(&msg, data, sizeof(data) - 1u) < 0);
+}
+
+static const Test_Case_t cases[] = {
+    TEST_CASE(test_heart_beat_msg),
+    TEST_CASE(test_left_brake_cmd),
+    TEST_CASE(test_left_brake_msg),
+    TEST_CASE(test_mcu_diag_msg),
+    TEST_CASE(test_mcu_config_cmd),
+    TEST_CASE(test_short_buffer),
+};
+
+const Test_Suite_t test_suite_codec = TEST_SUITE("codec", cases);
@@ -0,0 +1,330 @@
+/**
+ * @file test_controller.c
+ * @brief Scheduler, heartbeat watchdog, CAN health, runtime configuration and
+ *        command dispatch end to end
+ */
+
+#include "test.h"
+#include "mock_hal.h"
+#include "mock_board.h"
+#include "controller.h"
+#include "left_break.h"
+#include "can.h"
+#include "automate.h"
+#include "automate_codec.h"
+
+#define NODE_ID_MCU                 0xF0u
+#define NODE_ID_PC                  0x10u
+
+static void Setup(void)
+{
+    Mock_PlantEnable(true);
+    for (uint8_t i = 0; i < BRAKE_COUNT; i++) {
+        /* Before Brake_Init() - rank i samples brake i (brake_configs[]) */
+        Mock_AdcSet(i, 200);
+    }
+    Mock_FlashErase();
+    Mock_Boot();
+    Mock_CanClearSent();
+}
+
+static void SendPcHeartbeat(uint16_t count)
+{
+    struct automate_heart_beat_msg_t msg;
+    uint8_t data[AUTOMATE_HEART_BEAT_MSG_LENGTH];
+    
+    automate_heart_beat_msg_init(&msg);
+    msg.node_id = NODE_ID_PC;
+    msg.msg_count = count;
+    msg.health = AUTOMATE_HEART_BEAT_MSG_HEALTH_ON_CHOICE;
+    automate_codec_heart_beat_msg_pack(data, &msg, sizeof(data));
+    Mock_CanReceive(AUTOMATE_HEART_BEAT_MSG_FRAME_ID, true, data, sizeof(data));
+}
+
+static void SendConfig(uint8_t target, uint8_t node_id, uint16_t heartbeat_ms,
+                       uint16_t telemetry_ms, uint16_t watchdog_ms)
+{
+    struct automate_mcu_config_cmd_t msg;
+    uint8_t data[AUTOMATE_MCU_CONFIG_CMD_LENGTH];
+    
+    automate_mcu_config_cmd_init(&msg);
+    msg.target_node_id = target;
+    msg.node_id = node_id;
+    msg.heartbeat_cycle = heartbeat_ms;
+    msg.telemetry_cycle = telemetry_ms;
+    msg.watchdog_timeout = watchdog_ms;
+    automate_codec_mcu_config_cmd_pack(data, &msg, sizeof(data));
+    TEST_ASSERT(Mock_CanReceive(AUTOMATE_MCU_CONFIG_CMD_FRAME_ID, true, data, sizeof(data)));
+}
+
+/**
+ * @brief Count sent frames with an identifier and take them from the log
+ */
+static uint32_t CountSent(uint32_t id)
+{
+    Mock_CanFrame_t frame;
+    uint32_t count = 0;
+    
+    while (Mock_CanFindSent(id, &frame)) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Run with the PC sending its heartbeat every 50 ms
+ */
+static void RunWithPc(uint32_t ms, uint16_t *count)
+{
+    for (uint32_t t = 0; t < ms; t += 50u) {
+        SendPcHeartbeat((*count)++);
+        Mock_Run(50);
+    }
+}
+
+/**
+ * @brief Take the newest MCU heartbeat sent so far
+ */
+static bool LastHeartbeat(struct automate_heart_beat_msg_t *msg)
+{
+    Mock_CanFrame_t frame;
+    bool found = false;
+    
+    while (Mock_CanFindSent(AUTOMATE_HEART_BEAT_MSG_FRAME_ID, &frame)) {
+        found = automate_codec_heart_beat_msg_unpack(msg, frame.data, frame.len) == 0;
+    }
+    return found;
+}
+
+static void test_heartbeat_period(void)
+{
+    struct automate_heart_beat_msg_t msg;
+    Mock_CanFrame_t frame;
+    uint32_t count = 0;
+    
+    Setup();
+    Mock_Run(1000);
+    
+    while (Mock_CanFindSent(AUTOMATE_HEART_BEAT_MSG_FRAME_ID, &frame)) {
+        TEST_ASSERT(frame.is_extended);
+        TEST_ASSERT_EQ(automate_codec_heart_beat_msg_unpack(&msg, frame.data, frame.len), 0);
+        TEST_ASSERT_EQ(msg.node_id, NODE_ID_MCU);
+        TEST_ASSERT_EQ(msg.msg_count, count);
+        count++;
+    }
+    TEST_ASSERT(count >= 19u && count <= 20u);
+}
+
+static void test_health_tracks_pc_watchdog(void)
+{
+    struct automate_heart_beat_msg_t msg;
+    uint16_t count = 0;
+    
+    Setup();
+    
+    /* INIT until the ADC calibration period ends */
+    Mock_Run(200);
+    TEST_ASSERT(LastHeartbeat(&msg));
+    TEST_ASSERT_EQ(msg.health, AUTOMATE_HEART_BEAT_MSG_HEALTH_INIT_CHOICE);
+    
+    for (uint32_t ms = 0; ms < 1000u; ms += 50u) {
+        SendPcHeartbeat(count++);
+        Mock_Run(50);
+    }
+    TEST_ASSERT(LastHeartbeat(&msg));
+    TEST_ASSERT_EQ(msg.health, AUTOMATE_HEART_BEAT_MSG_HEALTH_ON_CHOICE);
+    
+    /* PC silent past the watchdog timeout */
+    Mock_Run(400);
+    TEST_ASSERT(LastHeartbeat(&msg));
+    TEST_ASSERT_EQ(msg.health, AUTOMATE_HEART_BEAT_MSG_HEALTH_WARNING_CHOICE);
+    
+    SendPcHeartbeat(count++);
+    Mock_Run(100);
+    TEST_ASSERT(LastHeartbeat(&msg));
+    TEST_ASSERT_EQ(msg.health, AUTOMATE_HEART_BEAT_MSG_HEALTH_ON_CHOICE);
+}
+
+static void test_health_tracks_can_bus_off(void)
+{
+    struct automate_heart_beat_msg_t msg;
+    uint16_t count = 0;
+    
+    Setup();
+    RunWithPc(1200, &count);
+    TEST_ASSERT(LastHeartbeat(&msg));
+    TEST_ASSERT_EQ(msg.health, AUTOMATE_HEART_BEAT_MSG_HEALTH_ON_CHOICE);
+    
+    /* Rejoined within a supervision period - heartbeats resume, flagged WARNING */
+    Mock_CanBusOff();
+    RunWithPc(100, &count);
+    TEST_ASSERT_EQ(CAN_Driver_GetBusState(), CAN_BUS_STATE_ACTIVE);
+    TEST_ASSERT(LastHeartbeat(&msg));
+    TEST_ASSERT_EQ(msg.health, AUTOMATE_HEART_BEAT_MSG_HEALTH_WARNING_CHOICE);
+    
+    /* Back to ON once the link stayed up */
+    RunWithPc(1100, &count);
+    TEST_ASSERT(LastHeartbeat(&msg));
+    TEST_ASSERT_EQ(msg.health, AUTOMATE_HEART_BEAT_MSG_HEALTH_ON_CHOICE);
+    TEST_ASSERT_EQ(Mock_GetErrorCount(), 0);
+}
+
+/**
+ * @brief Take the MCU heartbeats sent so far, count those with a Node_id
+ */
+static uint32_t CountHeartbeats(uint8_t node_id)
+{
+    struct automate_heart_beat_msg_t msg;
+    Mock_CanFrame_t frame;
+    uint32_t count = 0;
+    
+    while (Mock_CanFindSent(AUTOMATE_HEART_BEAT_MSG_FRAME_ID, &frame)) {
+        if (automate_codec_heart_beat_msg_unpack(&msg, frame.data, frame.len) == 0 && msg.node_id == node_id) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void test_config_over_can(void)
+{
+    Controller_Config_t config;
+    uint32_t count;
+    
+    Setup();
+    Mock_Run(100);
+    SendConfig(NODE_ID_MCU, 0x21, 100, 250, 500);
+    Mock_Run(10);
+    Mock_CanClearSent();
+    
+    Mock_Run(1000);
+    count = CountHeartbeats(0x21);
+    TEST_ASSERT(count >= 9u && count <= 10u);
+    count = CountSent(AUTOMATE_LEFT_BRAKE_MSG_FRAME_ID);
+    TEST_ASSERT(count >= 3u && count <= 4u);
+    
+    Controller_GetConfig(&config);
+    TEST_ASSERT_EQ(config.heartbeat_interval_ms, 100);
+    TEST_ASSERT_EQ(config.telemetry_interval_ms, 250);
+    TEST_ASSERT_EQ(config.watchdog_timeout_ms, 500);
+    
+    /* Kept across a reset */
+    Mock_Boot();
+    Mock_CanClearSent();
+    Mock_Run(1000);
+    count = CountHeartbeats(0x21);
+    TEST_ASSERT(count >= 9u && count <= 10u);
+    count = CountSent(AUTOMATE_LEFT_BRAKE_MSG_FRAME_ID);
+    TEST_ASSERT(count >= 3u && count <= 4u);
+    
+    /* Now addressed by its new Node_id */
+    SendConfig(0x21, NODE_ID_MCU, 0, 0, 0);
+    Mock_Run(10);
+    TEST_ASSERT_EQ(Controller_GetNodeID(), NODE_ID_MCU);
+    TEST_ASSERT_EQ(Mock_GetErrorCount(), 0);
+}
+
+static void test_config_rejected(void)
+{
+    Controller_Config_t config;
+    
+    Setup();
+    
+    /* Other node, out-of-range cycle, PC's Node_id */
+    SendConfig(0x22, 0x21, 100, 0, 0);
+    SendConfig(NODE_ID_MCU, 0x21, CONTROLLER_CYCLE_MIN_MS - 1u, 0, 0);
+    SendConfig(NODE_ID_MCU, NODE_ID_PC, 0, 0, 0);
+    Mock_Run(10);
+    
+    Controller_GetConfig(&config);
+    TEST_ASSERT_EQ(config.node_id, NODE_ID_MCU);
+    TEST_ASSERT_EQ(config.heartbeat_interval_ms, 50);
+    TEST_ASSERT_EQ(config.telemetry_interval_ms, 100);
+    TEST_ASSERT_EQ(config.watchdog_timeout_ms, 200);
+    
+    /* Zero fields keep their value */
+    SendConfig(NODE_ID_MCU, 0, 0, 0, 1000);
+    Mock_Run(10);
+    Controller_GetConfig(&config);
+    TEST_ASSERT_EQ(config.node_id, NODE_ID_MCU);
+    TEST_ASSERT_EQ(config.heartbeat_interval_ms, 50);
+    TEST_ASSERT_EQ(config.watchdog_timeout_ms, 1000);
+    
+    /* Local node ID changes take the same checks and are kept */
+    TEST_ASSERT(!Controller_SetNodeID(NODE_ID_PC));
+    TEST_ASSERT_EQ(Controller_GetNodeID(), NODE_ID_MCU);
+    TEST_ASSERT(Controller_SetNodeID(0x22));
+    Mock_Run(1000);
+    Mock_Boot();
+    TEST_ASSERT_EQ(Controller_GetNodeID(), 0x22);
+}
+
+static void test_config_watchdog_timeout(void)
+{
+    struct automate_heart_beat_msg_t msg;
+    uint16_t count = 0;
+    
+    Setup();
+    SendConfig(NODE_ID_MCU, 0, 0, 0, 500);
+    RunWithPc(1200, &count);
+    
+    /* Silent past the default 200 ms, within the configured 500 ms */
+    Mock_Run(400);
+    TEST_ASSERT(LastHeartbeat(&msg));
+    TEST_ASSERT_EQ(msg.health, AUTOMATE_HEART_BEAT_MSG_HEALTH_ON_CHOICE);
+    
+    Mock_Run(200);
+    TEST_ASSERT(LastHeartbeat(&msg));
+    TEST_ASSERT_EQ(msg.health, AUTOMATE_HEART_BEAT_MSG_HEALTH_WARNING_CHOICE);
+}
+
+static void test_command_to_telemetry(void)
+{
+    struct automate_left_brake_cmd_t cmd;
+    struct automate_left_brake_msg_t msg;
+    uint8_t data[AUTOMATE_LEFT_BRAKE_CMD_LENGTH];
+    Mock_CanFrame_t frame;
+    bool pushed = false;
+    
+    Setup();
+    Mock_Run(100);
+    Mock_CanClearSent();
+    
+    automate_left_brake_cmd_init(&cmd);
+    cmd.msg_id = 7;
+    cmd.brake_state = AUTOMATE_LEFT_BRAKE_CMD_BRAKE_STATE_PUSH_CHOICE;
+    automate_codec_left_brake_cmd_pack(data, &cmd, sizeof(data));
+    TEST_ASSERT(Mock_CanReceive(AUTOMATE_LEFT_BRAKE_CMD_FRAME_ID, true, data, sizeof(data)));
+    
+    /* Reported on change within one control tick, then on completion */
+    Mock_Run(5);
+    TEST_ASSERT(Mock_CanFindSent(AUTOMATE_LEFT_BRAKE_MSG_FRAME_ID, &frame));
+    TEST_ASSERT_EQ(automate_codec_left_brake_msg_unpack(&msg, frame.data, frame.len), 0);
+    TEST_ASSERT_EQ(msg.brake_pushing, 1);
+    TEST_ASSERT_EQ(msg.cmd_msg_id, 7);
+    
+    Mock_Run(2000);
+    while (Mock_CanFindSent(AUTOMATE_LEFT_BRAKE_MSG_FRAME_ID, &frame)) {
+        TEST_ASSERT_EQ(automate_codec_left_brake_msg_unpack(&msg, frame.data, frame.len), 0);
+        if (msg.brake_pushed != 0u) {
+            pushed = true;
+            TEST_ASSERT_EQ(msg.cmd_msg_id, 7);
+            TEST_ASSERT(msg.cmd_latency != AUTOMATE_LEFT_BRAKE_MSG_CMD_LATENCY_PENDING_CHOICE);
+        }
+    }
+    TEST_ASSERT(pushed);
+    TEST_ASSERT_EQ(Brake_GetState(Brake_Get(BRAKE_LEFT)), BRAKE_STATE_PUSHED);
+    TEST_ASSERT_EQ(Brake_GetState(Brake_Get(BRAKE_RIGHT)), BRAKE_STATE_RELEASED);
+}
+
+static const Test_Case_t cases[] = {
+    TEST_CASE(test_heartbeat_period),
+    TEST_CASE(test_health_tracks_pc_watchdog),
+    TEST_CASE(test_health_tracks_can_bus_off),
+    TEST_CASE(test_config_over_can),
+    TEST_CASE(test_config_rejected),
+    TEST_CASE(test_config_watchdog_timeout),
+    TEST_CASE(test_command_to_telemetry),
+};
+
+const Test_Suite_t test_suite_controller = TEST_SUITE("controller", cases);
@@ -0,0 +1,69 @@
+/**
+ * @file test_main.c
+ * @brief Runs every suite, or those named on the command line
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "test.h"
+
+static const Test_Suite_t *const suites[] = {
+    &test_suite_can,
+    &test_suite_codec,
+    &test_suite_brake,
+    &test_suite_storage,
+    &test_suite_controller,
+};
+
+static bool case_failed = false;
+
+void Test_Fail(const char *file, int line, const char *expr, long long a, long long b)
+{
+    if (a != b) {
+        printf("    %s:%d: %s (%lld != %lld)\n", file, line, expr, a, b);
+    } else {
+        printf("    %s:%d: %s\n", file, line, expr);
+    }
+    case_failed = true;
+}
+
+static bool IsSelected(const char *name, int argc, char **argv)
+{
+    if (argc < 2) {
+        return true;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t run = 0;
+    uint32_t failed = 0;
+    
+    for (size_t s = 0; s < sizeof(suites) / sizeof(suites[0]); s++) {
+        const Test_Suite_t *suite = suites[s];
+    
+        if (!IsSelected(suite->name, argc, argv)) {
+            continue;
+        }
+    
+        printf("%s\n", suite->name);
+        for (uint32_t i = 0; i < suite->count; i++) {
+            case_failed = false;
+            suite->cases[i].fn();
+            printf("  %-40s %s\n", suite->cases[i].name, case_failed ? "FAIL" : "ok");
+            run++;
+            if (case_failed) {
+                failed++;
+            }
+        }
+    }
+    
+    printf("%u tests, %u failed\n", run, failed);
+    return (failed == 0u) ? 0 : 1;
+}
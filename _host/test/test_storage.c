@@ -0,0 +1,175 @@
+/**
+ * @file test_storage.c
+ * @brief Flash record log: rotation, interrupted writes, restore at boot
+ */
+
+#include <string.h>
+#include "test.h"
+#include "mock_hal.h"
+#include "mock_board.h"
+#include "storage.h"
+#include "left_break.h"
+
+/* STORAGE region of the mock flash */
+extern uint8_t _storage_start[];
+
+static void test_empty_region(void)
+{
+    uint32_t value;
+    
+    Mock_FlashErase();
+    Storage_Init();
+    
+    TEST_ASSERT(!Storage_Read(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+}
+
+static void test_write_read_rotate(void)
+{
+    uint32_t value;
+    
+    Mock_FlashErase();
+    Storage_Init();
+    
+    /* Several page rotations, re-scanning now and then like a reboot */
+    for (uint32_t v = 1; v <= 200u; v++) {
+        TEST_ASSERT(Storage_Write(STORAGE_KEY_CALIBRATION, &v, sizeof(v)));
+        if ((v % 7u) == 0u) {
+            Storage_Init();
+            TEST_ASSERT(Storage_Read(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+            TEST_ASSERT_EQ(value, v);
+        }
+    }
+    
+    Storage_Init();
+    TEST_ASSERT(Storage_Read(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    TEST_ASSERT_EQ(value, 200);
+    TEST_ASSERT(Mock_FlashGetEraseCount() >= 5u);
+    
+    /* Wrong size is not a match */
+    TEST_ASSERT(!Storage_Read(STORAGE_KEY_CALIBRATION, &value, sizeof(uint16_t)));
+}
+
+static void test_unchanged_value_not_written(void)
+{
+    uint32_t value = 42;
+    uint32_t erases;
+    
+    Mock_FlashErase();
+    Storage_Init();
+    TEST_ASSERT(Storage_Write(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    
+    erases = Mock_FlashGetEraseCount();
+    for (uint32_t i = 0; i < 100u; i++) {
+        TEST_ASSERT(Storage_Write(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    }
+    TEST_ASSERT_EQ(Mock_FlashGetEraseCount(), erases);
+}
+
+static void test_torn_write_keeps_previous(void)
+{
+    uint32_t value = 100;
+    
+    Mock_FlashErase();
+    Storage_Init();
+    TEST_ASSERT(Storage_Write(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    
+    /* Reset in the middle of programming a record */
+    value = 999;
+    Mock_FlashFailAfter(3);
+    TEST_ASSERT(!Storage_Write(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    Mock_FlashFailAfter(-1);
+    
+    Storage_Init();
+    TEST_ASSERT(Storage_Read(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    TEST_ASSERT_EQ(value, 100);
+    
+    /* Half-programmed slot is skipped */
+    value = 1000;
+    TEST_ASSERT(Storage_Write(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    Storage_Init();
+    TEST_ASSERT(Storage_Read(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    TEST_ASSERT_EQ(value, 1000);
+}
+
+static void test_torn_ecc_record_skipped(void)
+{
+    uint32_t value = 1;
+    uint32_t errors = Mock_GetErrorCount();
+    
+    Mock_FlashErase();
+    Storage_Init();
+    TEST_ASSERT(Storage_Write(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    value = 2;
+    TEST_ASSERT(Storage_Write(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    
+    /* Reset while the second 64-byte record was programmed, its CRC torn */
+    Mock_FlashEccError((2u * 64u) - sizeof(uint64_t));
+    Storage_Init();
+    TEST_ASSERT_EQ(Mock_GetErrorCount(), errors);
+    TEST_ASSERT(Storage_Read(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    TEST_ASSERT_EQ(value, 1);
+    
+    /* The torn slot is not written over */
+    value = 3;
+    TEST_ASSERT(Storage_Write(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    Storage_Init();
+    TEST_ASSERT_EQ(Mock_GetErrorCount(), errors);
+    TEST_ASSERT(Storage_Read(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    TEST_ASSERT_EQ(value, 3);
+    
+    /* Any other NMI still ends in the error handler */
+    FLASH->ECCR = 0;
+    NMI_Handler();
+    TEST_ASSERT_EQ(Mock_GetErrorCount(), errors + 1u);
+}
+
+static void test_garbage_region(void)
+{
+    uint32_t value = 5;
+    
+    /* Never erased, all bits programmed */
+    memset(_storage_start, 0x00, 2u * FLASH_PAGE_SIZE);
+    Storage_Init();
+    TEST_ASSERT(!Storage_Read(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    
+    value = 5;
+    TEST_ASSERT(Storage_Write(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    Storage_Init();
+    TEST_ASSERT(Storage_Read(STORAGE_KEY_CALIBRATION, &value, sizeof(value)));
+    TEST_ASSERT_EQ(value, 5);
+}
+
+static void test_calibration_restored_after_reboot(void)
+{
+    Brake_EndStops_t end_stops = { 300, 3500 };
+    Brake_EndStops_t restored;
+    
+    Mock_PlantEnable(false);
+    Mock_AdcSet(BRAKE_LEFT, 300);             /* Rank of the left brake */
+    Mock_FlashErase();
+    Mock_Boot();
+    TEST_ASSERT(!Brake_IsCalibrationRestored());
+    
+    TEST_ASSERT(Brake_SetEndStops(Brake_Get(BRAKE_LEFT), &end_stops));
+    TEST_ASSERT(Brake_SaveCalibration());
+    
+    Mock_Boot();
+    TEST_ASSERT_EQ(Mock_GetErrorCount(), 0);
+    TEST_ASSERT(Brake_IsCalibrationRestored());
+    Brake_GetEndStops(Brake_Get(BRAKE_LEFT), &restored);
+    TEST_ASSERT_EQ(restored.released, 300);
+    TEST_ASSERT_EQ(restored.pushed, 3500);
+    TEST_ASSERT_EQ(Brake_GetState(Brake_Get(BRAKE_LEFT)), BRAKE_STATE_RELEASED);
+}
+
+static const Test_Case_t cases[] = {
+    TEST_CASE(test_empty_region),
+    TEST_CASE(test_write_read_rotate),
+    TEST_CASE(test_unchanged_value_not_written),
+    TEST_CASE(test_torn_write_keeps_previous),
+    TEST_CASE(test_torn_ecc_record_skipped),
+    TEST_CASE(test_garbage_region),
+    TEST_CASE(test_calibration_restored_after_reboot),
+};
+
+const Test_Suite_t test_suite_storage = TEST_SUITE("storage", cases);